@@ -0,0 +1,159 @@
+/*  Software License Agreement
+ *  
+ *      Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ *  
+ *      This file is part of the Orange C Compiler package.
+ *  
+ *      The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 3 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      The Orange C Compiler package is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ *  
+ *      contact information:
+ *          email: TouchStone222@runbox.com <David Lindauer>
+ *  
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/* block counts for programs compiled with -fprofile-generate
+ *
+ * the compiler makes a table of counters for each function, and the function hands
+ * the table to __profile_register the first time it runs.  When the program exits
+ * the counts are added to those already in the profile file named in the tables, one
+ * function to a line, in the form -fprofile-use reads.  Lines for functions which
+ * didn't run this time are kept as they were.
+ */
+
+#pragma rundown profile_counts_write 50
+
+typedef struct _profile_counts
+{
+    struct _profile_counts* next;
+    char* name;
+    char* file;
+    unsigned count;
+    unsigned long long counts[];
+} PROFILE_COUNTS;
+
+/* the list ends with a sentinel so that a registered table never has a null link */
+static PROFILE_COUNTS profile_end;
+static PROFILE_COUNTS* profile_list = &profile_end;
+
+void __profile_register(PROFILE_COUNTS* table)
+{
+    if (!table->next)
+    {
+        table->next = profile_list;
+        profile_list = table;
+    }
+}
+static char* profile_read(char* file)
+{
+    FILE* in = fopen(file, "rb");
+    char* rv = NULL;
+    long size;
+    if (!in)
+        return NULL;
+    if (!fseek(in, 0, SEEK_END) && (size = ftell(in)) > 0 && !fseek(in, 0, SEEK_SET) && (rv = malloc(size + 1)))
+    {
+        size = fread(rv, 1, size, in);
+        rv[size] = 0;
+    }
+    fclose(in);
+    return rv;
+}
+/* a line which names a function of this run goes away; if the function still has the
+ * same blocks the counts on the line are added to the counters first.
+ */
+static int profile_merge(char* line, char* file)
+{
+    PROFILE_COUNTS* q;
+    char *name, *p, *end;
+    unsigned i, count;
+    while (isspace((unsigned char)*line))
+        line++;
+    name = line;
+    while (*line && !isspace((unsigned char)*line))
+        line++;
+    if (line == name || *name == '#')
+        return 0;
+    for (q = profile_list; q != &profile_end; q = q->next)
+        if (!strcmp(q->file, file) && strlen(q->name) == line - name && !strncmp(q->name, name, line - name))
+            break;
+    if (q == &profile_end)
+        return 0;
+    count = strtoul(line, &end, 10);
+    if (end == line || count != q->count)
+        return 1;
+    for (i = 0, p = end; i < count; i++, p = end)
+    {
+        strtoull(p, &end, 10);
+        if (end == p)
+            return 1;
+    }
+    for (i = 0, p = line; i <= count; i++, p = end)
+    {
+        unsigned long long n = strtoull(p, &end, 10);
+        if (i)
+            q->counts[i - 1] += n;
+    }
+    return 1;
+}
+static void profile_counts_write(void)
+{
+    PROFILE_COUNTS *p, *q;
+    for (p = profile_list; p != &profile_end; p = p->next)
+    {
+        FILE* out;
+        char *old, *line, *next;
+        for (q = profile_list; q != p; q = q->next)
+            if (!strcmp(q->file, p->file))
+                break;
+        if (q != p)
+            continue;
+        old = profile_read(p->file);
+        out = fopen(p->file, "w");
+        if (!out)
+        {
+            free(old);
+            continue;
+        }
+        for (line = old; line && *line; line = next)
+        {
+            int len;
+            next = strchr(line, '\n');
+            next = next ? next + 1 : line + strlen(line);
+            len = next - line;
+            while (len && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+                len--;
+            line[len] = 0;
+            if (!profile_merge(line, p->file))
+                fprintf(out, "%s\n", line);
+        }
+        free(old);
+        for (q = p; q != &profile_end; q = q->next)
+        {
+            if (!strcmp(q->file, p->file))
+            {
+                unsigned i;
+                fprintf(out, "%s %u", q->name, q->count);
+                for (i = 0; i < q->count; i++)
+                    fprintf(out, " %llu", q->counts[i]);
+                fprintf(out, "\n");
+            }
+        }
+        fclose(out);
+    }
+}
@@ -440,24 +440,14 @@ void AssemblyDef::Load(PELib& lib, PEReader& reader)
                     Class* cls = nullptr;
                     if (!thisNameSpace)
                     {
-                        const DNLTable& table3 = reader.Table(tNestedClass);
-                        for (auto tentry : table3)
+                        int parent = reader.EnclosingClass(i + 1);
+                        if (parent && classes[parent])
                         {
-                            NestedClassTableEntry* entry = static_cast<NestedClassTableEntry*>(tentry);
-                            int child = entry->nestedIndex_.index_;
-                            int parent = entry->enclosingIndex_.index_;
-                            if (child - 1 == i)
+                            DataContainer* dc = classes[parent]->FindContainer((char*)buf);
+                            if (dc && typeid(*dc) == typeid(Class))
                             {
-                                if (classes[parent])
-                                {
-                                    DataContainer* dc = classes[parent]->FindContainer((char*)buf);
-                                    if (dc && typeid(*dc) == typeid(Class))
-                                    {
-                                        cls = static_cast<Class*>(dc);
-                                        classes[i] = cls;
-                                    }
-                                }
-                                break;
+                                cls = static_cast<Class*>(dc);
+                                classes[i] = cls;
                             }
                         }
                     }
@@ -372,16 +372,13 @@ void Class::Load(PELib& lib, AssemblyDef& assembly, PEReader& reader, size_t cls
             SignatureGenerator::TypeFromFieldRef(lib, assembly, reader, field, entry->signatureIndex_.index_);
             if (entry->flags_ & FieldTableEntry::HasDefault)
             {
-                const DNLTable& table = reader.Table(tConstant);
-                for (auto tentry : table)
+                size_t n = reader.FieldConstant(i);
+                if (n)
                 {
-                    ConstantTableEntry* tentry2 = static_cast<ConstantTableEntry*>(tentry);
-                    if (tentry2->parentIndex_.tag_ == Constant::FieldDef && tentry2->parentIndex_.index_ == i)
-                    {
-                        int value = 0;
-                        reader.ReadFromBlob((Byte*)&value, sizeof(value), tentry2->valueIndex_.index_);
-                        field->AddEnumValue(value, (Field::ValueSize)tentry2->type_);
-                    }
+                    ConstantTableEntry* tentry2 = static_cast<ConstantTableEntry*>(reader.Table(tConstant)[n - 1]);
+                    int value = 0;
+                    reader.ReadFromBlob((Byte*)&value, sizeof(value), tentry2->valueIndex_.index_);
+                    field->AddEnumValue(value, (Field::ValueSize)tentry2->type_);
                 }
             }
         }
@@ -435,29 +432,26 @@ void Class::Load(PELib& lib, AssemblyDef& assembly, PEReader& reader, size_t cls
     const DNLTable& table2 = reader.Table(tPropertyMap);
     PropertyMapTableEntry* entry2;
     int end = table2.size();
-    for (int i = 0; i < end; i++)
+    int i2 = reader.PropertyMap(clsIndex);
+    if (i2 >= 0)
     {
-        entry2 = static_cast<PropertyMapTableEntry*>(table2[i]);
+        entry2 = static_cast<PropertyMapTableEntry*>(table2[i2]);
         size_t propIndex = entry2->propertyList_.index_;
-        if (entry2->parent_.index_ == clsIndex)
+        if (i2 < end - 1)
         {
-            if (i < end - 1)
-            {
-                entry2 = static_cast<PropertyMapTableEntry*>(table2[i + 1]);
-                end = entry2->propertyList_.index_;
-            }
-            else
-            {
-                end = reader.Table(tProperty).size() + 1;
-            }
-            for (int j = propIndex; j < end; j++)
-            {
-                Property* prop = lib.AllocateProperty();
-                prop->SetContainer(this, false);
-                properties_.push_back(prop);
-                prop->Load(lib, assembly, reader, j, startMethod, startSemantics, endSemantics, methods);
-            }
-            break;
+            entry2 = static_cast<PropertyMapTableEntry*>(table2[i2 + 1]);
+            end = entry2->propertyList_.index_;
+        }
+        else
+        {
+            end = reader.Table(tProperty).size() + 1;
+        }
+        for (int j = propIndex; j < end; j++)
+        {
+            Property* prop = lib.AllocateProperty();
+            prop->SetContainer(this, false);
+            properties_.push_back(prop);
+            prop->Load(lib, assembly, reader, j, startMethod, startSemantics, endSemantics, methods);
         }
     }
 }
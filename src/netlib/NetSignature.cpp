@@ -190,7 +190,6 @@ std::string SignatureGenerator::LoadClassName(PEReader& reader, size_t index, As
     {
         std::string rv;
         bool done = false;
-        const DNLTable& table = reader.Table(tNestedClass);
         const DNLTable& table1 = reader.Table(tTypeDef);
         while (!done)
         {
@@ -204,15 +203,11 @@ std::string SignatureGenerator::LoadClassName(PEReader& reader, size_t index, As
                 if (rv.size())
                     rv = std::string(".") + rv;
                 rv = std::string((char*)buf) + rv;
-                for (auto tentry : table)
+                size_t enclosing = reader.EnclosingClass(index);
+                if (enclosing)
                 {
-                    NestedClassTableEntry* entry = static_cast<NestedClassTableEntry*>(tentry);
-                    if (entry->nestedIndex_.index_ == index)
-                    {
-                        index = entry->enclosingIndex_.index_;
-                        done = false;
-                        break;
-                    }
+                    index = enclosing;
+                    done = false;
                 }
             }
         }
@@ -249,7 +244,6 @@ std::string SignatureGenerator::LoadNameSpaceName(PEReader& reader, size_t index
     if (isDef)
     {
         bool done = false;
-        const DNLTable& table = reader.Table(tNestedClass);
         int nextindex = index;
         while (!done)
         {
@@ -259,15 +253,11 @@ std::string SignatureGenerator::LoadNameSpaceName(PEReader& reader, size_t index
             if (visibility == TypeDefTableEntry::Public || visibility == TypeDefTableEntry::NestedPublic)
             {
                 index = nextindex;
-                for (auto tentry : table)
+                size_t enclosing = reader.EnclosingClass(index);
+                if (enclosing)
                 {
-                    NestedClassTableEntry* entry = static_cast<NestedClassTableEntry*>(tentry);
-                    if (entry->nestedIndex_.index_ == index)
-                    {
-                        nextindex = entry->enclosingIndex_.index_;
-                        done = false;
-                        break;
-                    }
+                    nextindex = enclosing;
+                    done = false;
                 }
             }
         }
@@ -28,6 +28,9 @@
 #include <set>
 #include "RSAEncoder.h"
 #include "sha1.h"
+
+class MappedFile;
+
 // this is an internal header used to define the various aspects of a PE file
 // and the functions to render the files
 // it won't normally be much use to users of the DotNetPELib Library
@@ -408,9 +411,6 @@ namespace DotNetPELib {
     private:
         std::iostream *outputFile_;
         std::string snkFile_;
-        // a reflection of the String stream so that we can keep from doing duplicates.
-        // right now we don't check duplicates on any of the other streams...
-        std::map<std::string, size_t> stringMap_;
         struct pool
         {
             pool() : size(0), maxSize(200), base(nullptr) { base = (Byte *)calloc(1, maxSize); }
@@ -419,6 +419,13 @@ namespace DotNetPELib {
             size_t maxSize;
             Byte *base;
             void Ensure(size_t newSize);
+            // called after an entry has been put at the end of the pool, if the same bytes are already
+            // in the pool the new copy is dropped again and the offset of the old one is returned.
+            size_t Intern(size_t offset);
+            // a reflection of the entries in the stream so that we can keep from doing duplicates,
+            // it maps the hash of an entry to its offset and length.   Offsets are used rather than
+            // pointers because the pool moves when it grows
+            std::unordered_multimap<size_t, std::pair<size_t, size_t>> entries;
         };
         DNLTable tables_[MaxTables];
         size_t entryPoint_;
@@ -473,7 +480,7 @@ namespace DotNetPELib {
         static const int ERR_INVALID_ASSEMBLY = 3;
         static const int ERR_UNKNOWN_TABLE = 5;
 
-        PEReader() : inputFile_(nullptr), corRVA_(0), num_objects_(0), objects_(0), blobPos_(0), stringPos_(0), GUIDPos_(0), stringData_(nullptr), blobData_(nullptr) { }
+        PEReader() : inputFile_(nullptr), corRVA_(0), num_objects_(0), objects_(0), blobPos_(0), stringPos_(0), GUIDPos_(0), stringData_(nullptr), stringSize_(0) { }
         virtual ~PEReader();
 
         int ManagedLoad(std::string assemblyName, std::string path);
@@ -483,6 +490,12 @@ namespace DotNetPELib {
         int ReadFromGUID(Byte *buf, size_t len, size_t offset);
         size_t RVAToFileLocation(size_t rva);
         const DNLTable &Table(int i) const { return tables_[i]; }
+        // the class a nested typedef lives in, or zero if it isn't nested
+        size_t EnclosingClass(size_t typeDefIndex);
+        // the first constant row belonging to a field, or zero if it has none
+        size_t FieldConstant(size_t fieldIndex);
+        // the property map row for a typedef, or -1 if it has no properties
+        int PropertyMap(size_t typeDefIndex);
         void LibPath(const std::string& libPath) { libPath_ = libPath;  }
 
     protected:
@@ -490,20 +503,24 @@ namespace DotNetPELib {
         std::string FindGACPath(const std::string& path, const std::string& fileName, int major, int minor, int build, int revision);
         std::string SearchForManagedFile(const std::string& assemblyName, int major, int minor, int build, int revision);
         void get(void *buffer, size_t offset, size_t len);
+        const Byte *Mapped(size_t offset, size_t &len);
         size_t PELocation();
         size_t Cor20Location(size_t PEHeader);
         void GetStream(size_t Cor20, const char *streamName, DWord pos[2]);
         int ReadTables(size_t Cor20);
 
     private:
-        std::fstream *inputFile_;
+        MappedFile *inputFile_;
         int num_objects_;
         size_t corRVA_;
         size_t blobPos_;
         size_t stringPos_;
-        Byte *stringData_;
-        Byte *blobData_;
+        const Byte *stringData_;
+        size_t stringSize_;
         size_t GUIDPos_;
+        std::vector<size_t> enclosing_;
+        std::vector<size_t> constants_;
+        std::vector<int> propertyMaps_;
         PEObject *objects_;
         DNLTable tables_[MaxTables];
         size_t sizes_[MaxTables + ExtraIndexes];
@@ -1600,7 +1617,7 @@ namespace DotNetPELib {
         size_t signatureToken_;
         size_t rva_;
         size_t methodDef_;
-        size_t Write(size_t sizes[MaxTables + ExtraIndexes], std::iostream &out) const;
+        size_t Write(size_t sizes[MaxTables + ExtraIndexes], std::vector<Byte> &out) const;
     };
     inline char* StrCpy(char *data, size_t len, const char* source)
     {
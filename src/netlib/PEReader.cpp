@@ -31,6 +31,7 @@
 #include "MZHeader.h"
 #include "PEHeader.h"
 #include "DLLExportReader.h"
+#include "MappedFile.h"
 #include <ctime>
 #include <cstdio>
 namespace DotNetPELib
@@ -117,8 +118,6 @@ PEReader::~PEReader()
 {
     delete inputFile_;
     delete[] objects_;
-    delete[] stringData_;
-    delete[] blobData_;
     for (int i = 0; i < MaxTables; i++)
     {
         for (int j = 0; j < tables_[i].size(); j++)
@@ -236,8 +235,8 @@ std::string PEReader::SearchForManagedFile(const std::string& assemblyName, int
 }
 int PEReader::ManagedLoad(std::string assemblyName, std::string path)
 {
-    inputFile_ = new std::fstream(path.c_str(), std::ios::in | std::ios::binary);
-    if (!inputFile_->fail())
+    inputFile_ = new MappedFile(path);
+    if (inputFile_->IsOpen())
     {
         size_t peLoc = PELocation();
         if (!peLoc)
@@ -267,8 +266,23 @@ int PEReader::ManagedLoad(std::string assemblyName, int major, int minor, int bu
 
 void PEReader::get(void* buffer, size_t offset, size_t len)
 {
-    inputFile_->seekg(offset);
-    inputFile_->read((char*)buffer, len);
+    // the whole file is mapped, anything past the end reads as zeros
+    size_t avail = offset < inputFile_->Size() ? inputFile_->Size() - offset : 0;
+    if (len > avail)
+    {
+        memset((Byte*)buffer + avail, 0, len - avail);
+        len = avail;
+    }
+    if (len)
+        memcpy(buffer, inputFile_->Data() + offset, len);
+}
+const Byte* PEReader::Mapped(size_t offset, size_t& len)
+{
+    if (offset > inputFile_->Size())
+        offset = inputFile_->Size();
+    if (len > inputFile_->Size() - offset)
+        len = inputFile_->Size() - offset;
+    return inputFile_->Data() + offset;
 }
 size_t PEReader::RVAToFileLocation(size_t rva)
 {
@@ -393,14 +407,14 @@ int PEReader::ReadFromString(Byte* buf, size_t len, size_t offset)
         if (!pos[0])
             return 0;
         stringPos_ = RVAToFileLocation(pos[0]);
-        stringData_ = new Byte[pos[1]];
-        get(stringData_, stringPos_, pos[1]);
+        stringSize_ = pos[1];
+        stringData_ = Mapped(stringPos_, stringSize_);
     }
-    int i;
-    for (i = offset; stringData_[i] && i < offset + len - 1; i++)
+    size_t i;
+    for (i = offset; i < stringSize_ && stringData_[i] && i < offset + len - 1; i++)
         buf[i - offset] = stringData_[i];
     buf[i - offset] = 0;
-    return strlen((char*)buf);
+    return i - offset;
 }
 int PEReader::ReadFromBlob(Byte* buf, size_t len, size_t offset)
 {
@@ -411,11 +425,8 @@ int PEReader::ReadFromBlob(Byte* buf, size_t len, size_t offset)
         if (!pos[0])
             return 0;
         blobPos_ = RVAToFileLocation(pos[0]);
-        blobData_ = new Byte[pos[1]];
-        get(blobData_, blobPos_, pos[1]);
     }
     Byte sizearr[4];
-    memcpy(sizearr, blobData_ + offset, 4);
     get(sizearr, blobPos_ + offset, 4);
     int offs, size;
     if (sizearr[0] < 128)
@@ -434,7 +445,7 @@ int PEReader::ReadFromBlob(Byte* buf, size_t len, size_t offset)
         offs = 4;
     }
     if (len >= size)
-        memcpy(buf, blobData_ + offset + offs, size);
+        get(buf, blobPos_ + offset + offs, size);
     return size > len ? len : size;
 }
 int PEReader::ReadFromGUID(Byte* buf, size_t len, size_t offset)
@@ -501,4 +512,51 @@ int PEReader::ReadTables(size_t Cor20)
     delete[] tableMem;
     return 0;
 }
-}  // namespace DotNetPELib
\ No newline at end of file
+size_t PEReader::EnclosingClass(size_t typeDefIndex)
+{
+    if (enclosing_.empty())
+    {
+        enclosing_.resize(tables_[tTypeDef].size() + 1, 0);
+        for (auto tentry : tables_[tNestedClass])
+        {
+            NestedClassTableEntry* entry = static_cast<NestedClassTableEntry*>(tentry);
+            size_t child = entry->nestedIndex_.index_;
+            if (child < enclosing_.size() && !enclosing_[child])
+                enclosing_[child] = entry->enclosingIndex_.index_;
+        }
+    }
+    return typeDefIndex < enclosing_.size() ? enclosing_[typeDefIndex] : 0;
+}
+size_t PEReader::FieldConstant(size_t fieldIndex)
+{
+    if (constants_.empty())
+    {
+        constants_.resize(tables_[tField].size() + 1, 0);
+        const DNLTable& table = tables_[tConstant];
+        for (size_t i = 0; i < table.size(); i++)
+        {
+            ConstantTableEntry* entry = static_cast<ConstantTableEntry*>(table[i]);
+            size_t field = entry->parentIndex_.index_;
+            if (entry->parentIndex_.tag_ == Constant::FieldDef && field < constants_.size() && !constants_[field])
+                constants_[field] = i + 1;
+        }
+    }
+    return fieldIndex < constants_.size() ? constants_[fieldIndex] : 0;
+}
+int PEReader::PropertyMap(size_t typeDefIndex)
+{
+    if (propertyMaps_.empty())
+    {
+        propertyMaps_.resize(tables_[tTypeDef].size() + 1, -1);
+        const DNLTable& table = tables_[tPropertyMap];
+        for (int i = 0; i < table.size(); i++)
+        {
+            PropertyMapTableEntry* entry = static_cast<PropertyMapTableEntry*>(table[i]);
+            size_t parent = entry->parent_.index_;
+            if (parent < propertyMaps_.size() && propertyMaps_[parent] < 0)
+                propertyMaps_[parent] = i;
+        }
+    }
+    return typeDefIndex < propertyMaps_.size() ? propertyMaps_[typeDefIndex] : -1;
+}
+}  // namespace DotNetPELib
@@ -29,6 +29,7 @@
 #include "PEHeader.h"
 #include <ctime>
 #include <cstdio>
+#include <thread>
 namespace DotNetPELib
 {
 
@@ -53,7 +54,11 @@ DotNetMetaHeader* PEWriter::metaHeader_ = &metaHeader1;
 DWord PEWriter::cildata_rva_;
 Byte PEWriter::defaultUS_[8] = {0, 3, 0x20, 0, 0};
 
-size_t PEMethod::Write(size_t sizes[MaxTables + ExtraIndexes], std::iostream& out) const
+static void put(std::vector<Byte>& out, const void* data, size_t size)
+{
+    out.insert(out.end(), (const Byte*)data, (const Byte*)data + size);
+}
+size_t PEMethod::Write(size_t sizes[MaxTables + ExtraIndexes], std::vector<Byte>& out) const
 {
     Byte dest[512];
     int n;
@@ -70,8 +75,8 @@ size_t PEMethod::Write(size_t sizes[MaxTables + ExtraIndexes], std::iostream& ou
         *(DWord*)(dest + 4) = codeSize_;
         *(DWord*)(dest + 8) = signatureToken_;
     }
-    out.write((char*)dest, n);
-    out.write((char*)code_, codeSize_);
+    put(out, dest, n);
+    put(out, code_, codeSize_);
     n += codeSize_;
     if (sehData_.size())
     {
@@ -79,7 +84,7 @@ size_t PEMethod::Write(size_t sizes[MaxTables + ExtraIndexes], std::iostream& ou
         {
             char align[4];
             memset(align, 0, sizeof(align));
-            out.write((char*)align, 4 - n % 4);
+            put(out, align, 4 - n % 4);
             n = n + 3;
             n = n & ~3;
         }
@@ -100,7 +105,7 @@ size_t PEMethod::Write(size_t sizes[MaxTables + ExtraIndexes], std::iostream& ou
             header[1] = sehData_.size() * 12 + 4;
             header[2] = 0;
             header[3] = 0;
-            out.write((char*)header, 4);
+            put(out, header, 4);
             n += 4;
             for (int i = 0; i < sehData_.size(); i++)
             {
@@ -128,7 +133,7 @@ size_t PEMethod::Write(size_t sizes[MaxTables + ExtraIndexes], std::iostream& ou
                     bytes[10] = (data.classToken >> 16) & 0xff;
                     bytes[11] = (data.classToken >> 24) & 0xff;
                 }
-                out.write((char*)bytes, 12);
+                put(out, bytes, 12);
                 n += 12;
             }
         }
@@ -140,7 +145,7 @@ size_t PEMethod::Write(size_t sizes[MaxTables + ExtraIndexes], std::iostream& ou
             header[1] = q & 0xff;
             header[2] = (q >> 8) & 0xff;
             header[3] = (q >> 16) & 0xff;
-            out.write((char*)header, 4);
+            put(out, header, 4);
             n += 4;
             for (int i = 0; i < sehData_.size(); i++)
             {
@@ -180,7 +185,7 @@ size_t PEMethod::Write(size_t sizes[MaxTables + ExtraIndexes], std::iostream& ou
                     bytes[22] = (data.classToken >> 16) & 0xff;
                     bytes[23] = (data.classToken >> 24) & 0xff;
                 }
-                out.write((char*)bytes, 24);
+                put(out, bytes, 24);
                 n += 24;
             }
         }
@@ -199,6 +204,24 @@ void PEWriter::pool::Ensure(size_t newSize)
         base = (Byte*)realloc(base, maxSize);
     }
 }
+size_t PEWriter::pool::Intern(size_t offset)
+{
+    size_t len = size - offset;
+    size_t hash = 14695981039346656037ULL;
+    for (Byte* p = base + offset; p < base + size; p++)
+        hash = (hash ^ *p) * 1099511628211ULL;
+    auto range = entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second.second == len && !memcmp(base + it->second.first, base + offset, len))
+        {
+            size = offset;
+            return it->second.first;
+        }
+    }
+    entries.insert(std::make_pair(hash, std::make_pair(offset, len)));
+    return offset;
+}
 PEWriter::~PEWriter()
 {
     delete peHeader_;
@@ -237,17 +260,13 @@ void PEWriter::AddMethod(PEMethod* method)
 }
 size_t PEWriter::HashString(const std::string& utf8)
 {
-    auto it = stringMap_.find(utf8);
-    if (it != stringMap_.end())
-        return it->second;
     if (strings_.size == 0)
         strings_.size++;
     strings_.Ensure(utf8.size() + 1);
     size_t rv = strings_.size;
     memcpy(strings_.base + strings_.size, utf8.c_str(), utf8.size() + 1);
     strings_.size += utf8.size() + 1;
-    stringMap_[utf8] = rv;
-    return rv;
+    return strings_.Intern(rv);
 }
 size_t PEWriter::HashUS(std::wstring str)
 {
@@ -285,7 +304,7 @@ size_t PEWriter::HashUS(std::wstring str)
         us_.base[us_.size++] = n >> 8;
     }
     us_.base[us_.size++] = flag;
-    return rv;
+    return us_.Intern(rv);
 }
 size_t PEWriter::HashGUID(Byte* Guid)
 {
@@ -321,7 +340,7 @@ size_t PEWriter::HashBlob(Byte* blobData, size_t blobLen)
     }
     memcpy(blob_.base + blob_.size, blobData, blobLen);
     blob_.size += blobLen;
-    return rv;
+    return blob_.Intern(rv);
 }
 size_t PEWriter::RVABytes(Byte* Bytes, size_t dataLen)
 {
@@ -811,16 +830,35 @@ bool PEWriter::WriteMethods(PELib& peLib) const
     {
         counts[i] = tables_[i].size();
     }
-    for (std::list<PEMethod*>::const_iterator it = methods_.begin(); it != methods_.end(); ++it)
+    std::vector<PEMethod*> cil;
+    for (auto method : methods_)
+        if (method->flags_ & PEMethod::CIL)
+            cil.push_back(method);
+    // the method bodies are independent of each other at this point, so they get
+    // encoded in parallel and are then written out in order
+    std::vector<std::vector<Byte>> bodies(cil.size());
+    int threads = std::thread::hardware_concurrency();
+    if (threads < 1)
+        threads = 1;
+    if (threads > cil.size() / 1024 + 1)
+        threads = cil.size() / 1024 + 1;
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; i++)
+        workers.push_back(std::thread([&, i]() {
+            for (size_t j = i; j < cil.size(); j += threads)
+                cil[j]->Write(counts, bodies[j]);
+        }));
+    for (size_t j = 0; j < cil.size(); j += threads)
+        cil[j]->Write(counts, bodies[j]);
+    for (auto&& worker : workers)
+        worker.join();
+    for (size_t j = 0; j < cil.size(); j++)
     {
-        if ((*it)->flags_ & PEMethod::CIL)
+        if ((cil[j]->flags_ & 3) == PEMethod::FatFormat)
         {
-            if (((*it)->flags_ & 3) == PEMethod::FatFormat)
-            {
-                align(4);
-            }
-            (*it)->Write(counts, *outputFile_);
+            align(4);
         }
+        put(bodies[j].data(), bodies[j].size());
     }
     return true;
 }
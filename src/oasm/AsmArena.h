@@ -0,0 +1,123 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ * 
+ */
+
+#ifndef AsmArena_h
+#define AsmArena_h
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+
+// the assembler and the compiler backend create one Instruction (and often a Fixup) for every
+// machine instruction, and keep them all until the object file is written.   Rather than going
+// to the heap for each of these small objects they are carved out of large pages.   The
+// shared_ptr control block lives in the same page as the object, so each instruction costs
+// one bump of a pointer instead of a malloc.
+//
+// each page counts the objects still alive in it and is freed when the last one goes away,
+// so the compiler gets its pages back once a file's sections and labels are released, and
+// static containers may be torn down at exit in any order.
+// the arena is not thread safe; oasm and occ build their sections from a single thread.
+class AsmArena
+{
+  public:
+    static void* Alloc(size_t size)
+    {
+        size = (size + Align - 1) & ~(Align - 1);
+        if (size > PageSize / 4)
+        {
+            // the header of a large block has no page
+            char* rv = new char[size + Align];
+            *(Page**)rv = nullptr;
+            return rv + Align;
+        }
+        if (!current || top + size + Align > PageSize)
+        {
+            Page* old = current;
+            current = (Page*)new char[PageSize];
+            current->live = 0;
+            top = Align;
+            if (old && !old->live)
+                delete[](char*) old;
+        }
+        char* rv = (char*)current + top;
+        *(Page**)rv = current;
+        current->live++;
+        top += size + Align;
+        return rv + Align;
+    }
+    static void Free(void* p)
+    {
+        char* block = (char*)p - Align;
+        Page* page = *(Page**)block;
+        if (!page)
+            delete[] block;
+        else if (!--page->live && page != current)
+            delete[](char*) page;
+    }
+    template <class T, class... Args>
+    static std::shared_ptr<T> Make(Args&&... args)
+    {
+        return std::allocate_shared<T>(Allocator<T>(), std::forward<Args>(args)...);
+    }
+
+    template <class T>
+    class Allocator
+    {
+      public:
+        typedef T value_type;
+        Allocator() {}
+        template <class U>
+        Allocator(const Allocator<U>&)
+        {
+        }
+        T* allocate(size_t n) { return static_cast<T*>(Alloc(n * sizeof(T))); }
+        void deallocate(T* p, size_t) { Free(p); }
+        template <class U>
+        bool operator==(const Allocator<U>&) const
+        {
+            return true;
+        }
+        template <class U>
+        bool operator!=(const Allocator<U>&) const
+        {
+            return false;
+        }
+    };
+
+  private:
+    // every block is preceded by a pointer to its page, padded to keep the block aligned
+    struct Page
+    {
+        size_t live;
+    };
+    static const size_t PageSize = 64 * 1024;
+    static const size_t Align = alignof(std::max_align_t);
+    static Page* current;
+    static size_t top;
+};
+#endif
@@ -190,7 +190,7 @@ void AsmFile::DoLabel(std::string& name, int lineno)
     {
         if (inAbsolute)
         {
-            labels[realName] = std::make_shared<Label>(realName, labels.size(), 0);
+            labels[realName] = AsmArena::Make<Label>(realName, labels.size(), 0);
             label = labels[realName];
             label->SetOffset(absoluteValue);
             auto val = std::make_shared<AsmExprNode>(absoluteValue);
@@ -200,7 +200,7 @@ void AsmFile::DoLabel(std::string& name, int lineno)
         }
         else
         {
-            labels[realName] = std::make_shared<Label>(realName, labels.size(), currentSection->GetSect() - 1);
+            labels[realName] = AsmArena::Make<Label>(realName, labels.size(), currentSection->GetSect() - 1);
             label = labels[realName];
         }
         if (name[0] != '.')
@@ -279,7 +279,7 @@ void AsmFile::DoDB()
         else
         {
             std::shared_ptr<AsmExprNode> num = GetNumber();
-            std::shared_ptr<Fixup> f = std::make_shared<Fixup>(num, byte ? 1 : 2, false, 0);
+            std::shared_ptr<Fixup> f = AsmArena::Make<Fixup>(num, byte ? 1 : 2, false, 0);
             f->SetInsOffs(size);
             f->SetFileName(errFile);
             f->SetErrorLine(errLine);
@@ -289,7 +289,7 @@ void AsmFile::DoDB()
                 buf[size++] = 0;
         }
     } while (GetKeyword() == kw::comma);
-    std::shared_ptr<Instruction> ins = std::make_shared<Instruction>((unsigned char*)buf, size, true);
+    std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>((unsigned char*)buf, size, true);
     if (lineno >= 0)
         listing.Add(ins, lineno, preProcessor.InMacro());
     currentSection->InsertInstruction(ins);
@@ -334,7 +334,7 @@ void AsmFile::DoDD()
         else
         {
             num = GetNumber();
-            std::shared_ptr<Fixup> f = std::make_shared<Fixup>(num, 4, false, 0);
+            std::shared_ptr<Fixup> f = AsmArena::Make<Fixup>(num, 4, false, 0);
             f->SetInsOffs(size);
             f->SetFileName(errFile);
             f->SetErrorLine(errLine);
@@ -343,7 +343,7 @@ void AsmFile::DoDD()
             size += 4;
         }
     } while (GetKeyword() == kw::comma);
-    std::shared_ptr<Instruction> ins = std::make_shared<Instruction>((unsigned char*)buf, size, true);
+    std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>((unsigned char*)buf, size, true);
     if (lineno >= 0)
         listing.Add(ins, lineno, preProcessor.InMacro());
     currentSection->InsertInstruction(ins);
@@ -369,7 +369,7 @@ void AsmFile::DoDQ()
         std::shared_ptr<AsmExprNode> num;
         NextToken();
         num = GetNumber();
-        std::shared_ptr<Fixup> f = std::make_shared<Fixup>(num, 8, false, 0);
+        std::shared_ptr<Fixup> f = AsmArena::Make<Fixup>(num, 8, false, 0);
         f->SetInsOffs(size);
         f->SetFileName(errFile);
         f->SetErrorLine(errLine);
@@ -377,7 +377,7 @@ void AsmFile::DoDQ()
         *((unsigned long long*)(buf + size)) = 0;
         size += 8;
     } while (GetKeyword() == kw::comma);
-    std::shared_ptr<Instruction> ins = std::make_shared<Instruction>((unsigned char*)buf, size, true);
+    std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>((unsigned char*)buf, size, true);
     if (lineno >= 0)
         listing.Add(ins, lineno, preProcessor.InMacro());
     currentSection->InsertInstruction(ins);
@@ -405,14 +405,14 @@ void AsmFile::DoFloat()
         std::shared_ptr<AsmExprNode> num;
         NextToken();
         num = GetNumber();
-        std::shared_ptr<Fixup> f = std::make_shared<Fixup>(num, tbyte ? 10 : 8, false, 0);
+        std::shared_ptr<Fixup> f = AsmArena::Make<Fixup>(num, tbyte ? 10 : 8, false, 0);
         f->SetInsOffs(size);
         f->SetFileName(errFile);
         f->SetErrorLine(errLine);
         fixups.push_back(f);
         size += tbyte ? 10 : 8;
     } while (GetKeyword() == kw::comma);
-    std::shared_ptr<Instruction> ins = std::make_shared<Instruction>((unsigned char*)buf, size, true);
+    std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>((unsigned char*)buf, size, true);
     if (lineno >= 0)
         listing.Add(ins, lineno, preProcessor.InMacro());
     currentSection->InsertInstruction(ins);
@@ -433,7 +433,7 @@ void AsmFile::ReserveDirective(int n)
     int num = GetValue();
     if (num <= 0)
         throw new std::runtime_error("Invalid reserve size");
-    std::shared_ptr<Instruction> ins = std::make_shared<Instruction>(num, n);
+    std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>(num, n);
     bool added = false;
     if (lineno >= 0)
     {
@@ -450,7 +450,7 @@ void AsmFile::ReserveDirective(int n)
         {
             NextToken();
             auto num = GetNumber();
-            std::shared_ptr<Fixup> f = std::make_shared<Fixup>(num, n, false, 0);
+            std::shared_ptr<Fixup> f = AsmArena::Make<Fixup>(num, n, false, 0);
             f->SetFileName(errFile);
             f->SetErrorLine(errLine);
             ins->Add(f);
@@ -689,7 +689,7 @@ void AsmFile::AlignDirective()
         int v = GetValue();
         if ((v & (v - 1)) != 0)
             throw new std::runtime_error("Alignment must be power of two");
-        std::shared_ptr<Instruction> ins = std::make_shared<Instruction>(v);
+        std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>(v);
         currentSection->InsertInstruction(ins);
         int n = currentSection->GetAlign();
         if (v > n)
@@ -718,7 +718,7 @@ void AsmFile::GnuAlignDirective(bool p2)
     {
         NeedSection();
         int v = p2 ? 1 << GetValue() : GetValue();
-        std::shared_ptr<Instruction> ins = std::make_shared<Instruction>(v);
+        std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>(v);
         ins->SetFillWidth(width);
         currentSection->InsertInstruction(ins);
         int n = currentSection->GetAlign();
@@ -841,7 +841,7 @@ void AsmFile::IncbinDirective()
     in.seekg(start, std::ios::beg);
     std::unique_ptr<unsigned char[]> data = std::make_unique<unsigned char[]>(size);
     in.read((char*)data.get(), size);
-    std::shared_ptr<Instruction> ins = std::make_shared<Instruction>(data.get(), size);
+    std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>(data.get(), size);
     currentSection->InsertInstruction(ins);
 }
 void AsmFile::PublicDirective()
@@ -873,7 +873,7 @@ void AsmFile::InsertExtern(const std::string& name1)
     {
         if (labels.find(name) == labels.end())
         {
-            labels[name] = std::make_shared<Label>(name, labels.size(), Section::sections.size() - 1);
+            labels[name] = AsmArena::Make<Label>(name, labels.size(), Section::sections.size() - 1);
         }
         std::shared_ptr<Label> label = labels[name];
         label->SetExtern(true);
@@ -986,7 +986,7 @@ void AsmFile::StringDirective()
             }
         }
     } while (GetKeyword() == kw::comma);
-    std::shared_ptr<Instruction> ins = std::make_shared<Instruction>((unsigned char*)buf, size, true);
+    std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>((unsigned char*)buf, size, true);
     if (lineno >= 0)
         listing.Add(ins, lineno, preProcessor.InMacro());
     currentSection->InsertInstruction(ins);
@@ -1013,14 +1013,14 @@ void AsmFile::SingleDirective()
             num->SetType(AsmExprNode::FVAL);
         }
 
-        std::shared_ptr<Fixup> f = std::make_shared<Fixup>(num, 4, false, 0);
+        std::shared_ptr<Fixup> f = AsmArena::Make<Fixup>(num, 4, false, 0);
         f->SetInsOffs(size);
         f->SetFileName(errFile);
         f->SetErrorLine(errLine);
         fixups.push_back(f);
         size += 4;
     } while (GetKeyword() == kw::comma);
-    std::shared_ptr<Instruction> ins = std::make_shared<Instruction>((unsigned char*)buf, size, true);
+    std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>((unsigned char*)buf, size, true);
     if (lineno >= 0)
         listing.Add(ins, lineno, preProcessor.InMacro());
     currentSection->InsertInstruction(ins);
@@ -1052,14 +1052,14 @@ void AsmFile::DoubleDirective()
             num->fval = num->ival;
             num->SetType(AsmExprNode::FVAL);
         }
-        std::shared_ptr<Fixup> f = std::make_shared<Fixup>(num, 8, false, 0);
+        std::shared_ptr<Fixup> f = AsmArena::Make<Fixup>(num, 8, false, 0);
         f->SetInsOffs(size);
         f->SetFileName(errFile);
         f->SetErrorLine(errLine);
         fixups.push_back(f);
         size += 8;
     } while (GetKeyword() == kw::comma);
-    std::shared_ptr<Instruction> ins = std::make_shared<Instruction>((unsigned char*)buf, size, true);
+    std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>((unsigned char*)buf, size, true);
     if (lineno >= 0)
         listing.Add(ins, lineno, preProcessor.InMacro());
     currentSection->InsertInstruction(ins);
@@ -1185,7 +1185,7 @@ void AsmFile::FillDirective()
         {
             memcpy(buf + i * size, val, size);
         }
-        std::shared_ptr<Instruction> ins = std::make_shared<Instruction>((unsigned char*)buf, repeat * size, true);
+        std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>((unsigned char*)buf, repeat * size, true);
         if (lineno >= 0)
             listing.Add(ins, lineno, preProcessor.InMacro());
         currentSection->InsertInstruction(ins);
@@ -1226,7 +1226,7 @@ void AsmFile::SpaceDirective()
     {
         unsigned char* buf = new unsigned char[repeat];
         memset(buf, value, repeat);
-        std::shared_ptr<Instruction> ins = std::make_shared<Instruction>(buf, repeat, true);
+        std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>(buf, repeat, true);
         if (lineno >= 0)
             listing.Add(ins, lineno, preProcessor.InMacro());
         currentSection->InsertInstruction(ins);
@@ -1253,7 +1253,7 @@ void AsmFile::NopsDirective()
     {
         unsigned char* buf = new unsigned char[repeat];
         memset(buf, value, repeat);
-        std::shared_ptr<Instruction> ins = std::make_shared<Instruction>(buf, repeat, true);
+        std::shared_ptr<Instruction> ins = AsmArena::Make<Instruction>(buf, repeat, true);
         if (lineno >= 0)
             listing.Add(ins, lineno, preProcessor.InMacro());
         currentSection->InsertInstruction(ins);
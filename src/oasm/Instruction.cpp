@@ -30,9 +30,12 @@
 #include <iostream>
 
 bool Instruction::bigEndian;
+AsmArena::Page* AsmArena::current;
+size_t AsmArena::top;
 
 Instruction::Instruction(std::shared_ptr<Label>& lbl) :
-    label(lbl), type(LABEL), altdata(nullptr), pos(0), fpos(0), size(0), offs(0), repeat(1), xrepeat(1), lost(false)
+    label(lbl), type(LABEL), altdata(nullptr), pos(0), fpos(0), size(0), offs(0), repeat(1), xrepeat(1), lost(false),
+    bytes(nullptr)
 {
 }
 Instruction::Instruction(void* dataIn, int Size, bool isData) :
@@ -45,12 +48,14 @@ Instruction::Instruction(void* dataIn, int Size, bool isData) :
     size(Size),
     offs(0),
     lost(false),
-    data(LoadData(!isData, (unsigned char*)dataIn, Size)),
+    bytes(nullptr),
     altdata(nullptr)
 {
+    LoadData(!isData, (unsigned char*)dataIn, Size);
 }
 Instruction::Instruction(int aln) :
-    type(ALIGN), label(nullptr), altdata(nullptr), pos(0), fpos(0), size(aln), offs(0), repeat(1), xrepeat(1), lost(false)
+    type(ALIGN), label(nullptr), altdata(nullptr), pos(0), fpos(0), size(aln), offs(0), repeat(1), xrepeat(1), lost(false),
+    bytes(nullptr)
 {
 }
 Instruction::Instruction(int Repeat, int Size) :
@@ -63,26 +68,34 @@ Instruction::Instruction(int Repeat, int Size) :
     repeat(Repeat),
     xrepeat(Repeat),
     offs(0),
-    data(std::make_unique<unsigned char[]>(Size)),
     lost(false)
 {
-    memset(data.get(), 0, size);
+    bytes = AllocData(Size);
+    memset(bytes, 0, size);
 }
 Instruction::Instruction(void* data) :
-    type(ALT), label(nullptr), altdata(data), pos(0), fpos(0), size(0), offs(0), repeat(1), xrepeat(1), lost(false)
+    type(ALT), label(nullptr), altdata(data), pos(0), fpos(0), size(0), offs(0), repeat(1), xrepeat(1), lost(false),
+    bytes(nullptr)
 {
 }
 
 Instruction::~Instruction() {}
-std::unique_ptr<unsigned char[]> Instruction::LoadData(bool isCode, unsigned char* data, size_t size)
+unsigned char* Instruction::AllocData(size_t size)
+{
+    if (size <= InlineSize)
+        return inlineData;
+    data = std::make_unique<unsigned char[]>(size);
+    return data.get();
+}
+void Instruction::LoadData(bool isCode, unsigned char* data, size_t size)
 {
 #ifdef x64
     bool found = !isCode;
 #else
     bool found = true;
 #endif
-    std::unique_ptr<unsigned char[]> rv = std::make_unique<unsigned char[]>(size);
-    unsigned char* d = rv.get();
+    bytes = AllocData(size);
+    unsigned char* d = bytes;
     for (unsigned char* s = data; size; size--)
     {
         if (found || (*s & 0xf0) != 0x40)  // null REX prefix
@@ -104,7 +117,6 @@ std::unique_ptr<unsigned char[]> Instruction::LoadData(bool isCode, unsigned cha
     }
     if (!found)
         std::cerr << "Diag: missing REX prefix" << std::endl;
-    return rv;
 }
 void Instruction::Add(std::shared_ptr<Fixup> fixup)
 {
@@ -121,7 +133,7 @@ int Instruction::GetNext(Fixup& fixup, unsigned char* buf)
         if (xrepeat == 0)
             return 0;
         int sz = size;
-        memcpy(buf, data.get(), sz);
+        memcpy(buf, bytes, sz);
         pos += sz;
         xrepeat--;
         return sz;
@@ -195,7 +207,7 @@ int Instruction::GetNext(Fixup& fixup, unsigned char* buf)
         int rv = top - pos;
         for (int i = pos; i < top; i++)
         {
-            *buf++ = data.get()[i];
+            *buf++ = bytes[i];
         }
         pos = top;
         return rv;
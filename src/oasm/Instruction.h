@@ -28,6 +28,7 @@
 
 #include "Label.h"
 #include "AsmExpr.h"
+#include "AsmArena.h"
 #include <vector>
 #include <string>
 #include <memory>
@@ -87,10 +88,10 @@ class Instruction
     void Rewind() { pos = fpos = 0; }
     static bool ParseSectionAttrib(AsmFile* file);
     void Add(std::shared_ptr<Fixup> fixup);
-    unsigned char* GetBytes() const { return data.get(); }
+    unsigned char* GetBytes() const { return bytes; }
     FixupContainer* GetFixups();
     static void SetBigEndian(bool be) { bigEndian = be; }
-    std::unique_ptr<unsigned char[]> LoadData(bool isCode, unsigned char* data, size_t size);
+    void LoadData(bool isCode, unsigned char* data, size_t size);
     bool Lost() const { return lost; }
 
   private:
@@ -105,7 +106,12 @@ class Instruction
     bool lost;
 
     FixupContainer fixups;
+    // encodings that fit in a maximum length x86 instruction are kept inline
+    static const int InlineSize = 15;
+    unsigned char* bytes;
+    unsigned char inlineData[InlineSize];
     std::unique_ptr<unsigned char[]> data;
+    unsigned char* AllocData(size_t size);
     static bool bigEndian;
 };
 #endif
\ No newline at end of file
@@ -294,7 +294,7 @@ std::shared_ptr<Instruction> InstructionParser::Parse(const std::string& args, i
         {
             unsigned char buf[64];
             bits.GetBytes(buf, (bits.GetBits() + 7) / 8);
-            return std::make_shared<Instruction>(buf, (bits.GetBits() + 7) / 8);
+            return AsmArena::Make<Instruction>(buf, (bits.GetBits() + 7) / 8);
         }
     }
     else
@@ -325,7 +325,7 @@ std::shared_ptr<Instruction> InstructionParser::Parse(const std::string& args, i
 #endif
                     if (!eol)
                         throw new std::runtime_error("Extra characters at end of line");
-                    s = std::make_shared<Instruction>(buf, (bits.GetBits() + 7) / 8);
+                    s = AsmArena::Make<Instruction>(buf, (bits.GetBits() + 7) / 8);
                     //			std::cout << bits.GetBits() << std::endl;
                     for (auto& operand : operands)
                     {
@@ -340,7 +340,7 @@ std::shared_ptr<Instruction> InstructionParser::Parse(const std::string& args, i
                                 if (n < 0)
                                     n = -n;
                                 auto temp = std::make_shared<AsmExprNode>(*(AsmExprNode*)operand->node);
-                                auto f = std::make_shared<Fixup>(temp, (operand->size + 7) / 8, operand->relOfs != 0, n,
+                                auto f = AsmArena::Make<Fixup>(temp, (operand->size + 7) / 8, operand->relOfs != 0, n,
                                                      operand->relOfs > 0);
                                 f->SetInsOffs((operand->pos + 7) / 8);
                                 f->SetFileName(errName);
@@ -183,9 +183,9 @@ void Section::InsertInstruction(std::shared_ptr<Instruction>& ins)
 std::shared_ptr<Instruction> Section::InsertLabel(std::shared_ptr<Label>& label)
 {
     if (subSection == 0)
-        instructions.push_back(std::make_shared<Instruction>(label));
+        instructions.push_back(AsmArena::Make<Instruction>(label));
     else
-        subSections[subSection]->GetInstructions().push_back(std::make_shared<Instruction>(label));
+        subSections[subSection]->GetInstructions().push_back(AsmArena::Make<Instruction>(label));
     labels[label->GetName()] = pc;
     return subSection == 0 ? instructions.back(): subSections[subSection]->GetInstructions().back();
 }
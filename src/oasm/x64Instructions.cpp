@@ -2,7 +2,7 @@
 
 #include "x64Instructions.h"
 
-const char* const opcodeTable[631] = {
+const char* const opcodeTable[632] = {
     "",           "",           "",           "",          "",           "",           "",          "",          "",
     "",           "",           "",           "",          "",           "",           "",          "",          "",
     "",           "",           "",           "",          "",           "",           "",          "",          "",
@@ -72,8 +72,8 @@ const char* const opcodeTable[631] = {
     "sqrtps",     "sqrtsd",     "sqrtss",     "subpd",     "subps",      "subsd",      "subss",     "ucomisd",   "ucomiss",
     "unpckhpd",   "unpckhps",   "unpcklpd",   "unpcklps",  "xorpd",      "xorps",      "invept",    "invvpid",   "vmcall",
     "vmclear",    "vmlaunch",   "vmptrld",    "vmptrst",   "vmread",     "vmresume",   "vmwrite",   "vmxoff",    "vmxon",
-    "a16",        "a32",        "lock",       "o16",       "o32",        "rep",        "repe",      "repne",     "repnz",
-    "repz",
+    "por",        "a16",        "a32",        "lock",       "o16",       "o32",        "rep",        "repe",      "repne",
+    "repnz",      "repz",
 };
 
 std::unordered_map<enum e_tk, const char*> tokenNames = {
@@ -595,16 +595,17 @@ enum e_opcode
     op_vmwrite = 618,
     op_vmxoff = 619,
     op_vmxon = 620,
-    op_a16 = 621,
-    op_a32 = 622,
-    op_lock = 623,
-    op_o16 = 624,
-    op_o32 = 625,
-    op_rep = 626,
-    op_repe = 627,
-    op_repne = 628,
-    op_repnz = 629,
-    op_repz = 630,
+    op_por = 621,
+    op_a16 = 622,
+    op_a32 = 623,
+    op_lock = 624,
+    op_o16 = 625,
+    op_o32 = 626,
+    op_rep = 627,
+    op_repe = 628,
+    op_repne = 629,
+    op_repnz = 630,
+    op_repz = 631,
 };
 
 enum e_tk
@@ -756,7 +757,7 @@ enum e_tk
     tk_tr7 = 1130,
 };
 
-extern const char* const opcodeTable[631];
+extern const char* const opcodeTable[632];
 
 extern std::unordered_map<enum e_tk, const char*> tokenNames;
 
@@ -1323,6 +1323,7 @@ void x64Parser::Init()
 	opcodeTable["vmwrite"] = 618;
 	opcodeTable["vmxoff"] = 619;
 	opcodeTable["vmxon"] = 620;
+	opcodeTable["por"] = 621;
 	prefixTable["a16"] = 0;
 	prefixTable["a32"] = 1;
 	prefixTable["lock"] = 2;
@@ -46204,7 +46205,21 @@ asmError x64Parser::Opcode620(x64Operand &operand)
 	asmError rv = AERR_NONE;
 	return rv;
 }
-x64Parser::DispatchType x64Parser::DispatchTable[621] = {
+Coding x64Parser::OpcodeCodings621_19[] = {
+	{ CODING_NAME("por")  (Coding::Type)(Coding::bitSpecified | Coding::valSpecified), 15, 8, 0, 0, 0 }, 
+	{ CODING_NAME("por")  (Coding::Type)(Coding::bitSpecified | Coding::valSpecified), 235, 8, 0, 0, 0 }, 
+	{ CODING_NAME("eot") Coding::eot },
+};
+asmError x64Parser::Opcode621(x64Operand &operand)
+{
+	operand.values[19] = OpcodeCodings621_19;
+	asmError rv;
+	{
+		rv = Opcode27(operand);
+	}
+	return rv;
+}
+x64Parser::DispatchType x64Parser::DispatchTable[622] = {
 	NULL,
 	NULL,
 	NULL,
@@ -46826,6 +46841,7 @@ x64Parser::DispatchType x64Parser::DispatchTable[621] = {
 	&x64Parser::Opcode618,
 	&x64Parser::Opcode619,
 	&x64Parser::Opcode620,
+	&x64Parser::Opcode621,
 };
 
 x64Token *x64Parser::addressTable[] = {
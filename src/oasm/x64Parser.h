@@ -7547,6 +7547,8 @@ class x64Parser : public InstructionParser
     asmError Opcode618(x64Operand& operand);
     asmError Opcode619(x64Operand& operand);
     asmError Opcode620(x64Operand& operand);
+    static Coding OpcodeCodings621_19[];
+    asmError Opcode621(x64Operand& operand);
 
     static Coding Coding1[];
     static Coding Coding2[];
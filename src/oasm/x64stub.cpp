@@ -748,7 +748,7 @@ void Instruction::RepRemoveCancellations(std::shared_ptr<AsmExprNode> exp, bool
 
 void Instruction::Optimize(Section* sect, int pc, bool last)
 {
-    unsigned char* pdata = data.get();
+    unsigned char* pdata = bytes;
     if (!pdata)
         return;
     if (pdata && size >= 3 && pdata[0] == 0x0f && pdata[1] == 0x0f && (pdata[2] == 0x9a || pdata[2] == 0xea))
@@ -785,7 +785,7 @@ void Instruction::Optimize(Section* sect, int pc, bool last)
                 size -= 2;
                 f->SetInsOffs(f->GetInsOffs() - 2);
                 std::shared_ptr<AsmExprNode> n = std::make_shared<AsmExprNode>(AsmExprNode::DIV, f->GetExpr(), std::make_shared<AsmExprNode>(16));
-                fixups.push_back(std::make_shared       <Fixup>(n, 2, false));
+                fixups.push_back(AsmArena::Make<Fixup>(n, 2, false));
                 f = fixups.back();
                 f->SetInsOffs(size - 2);
             }
@@ -44,6 +44,7 @@ class ObjSourceFile;
 class ObjFunction;
 class ObjDebugTag;
 class ObjBrowseInfo;
+class MappedFile;
 
 void DebugThrowHook();
 
@@ -76,6 +77,9 @@ class ObjIeeeBinary : public ObjIOBase
         cs(0),
         currentDataSection(nullptr),
         ioBufferPos(0),
+        mapped(nullptr),
+        mappedPos(0),
+        mappedSize(0),
         lineno(0), 
         first(true)
     {
@@ -93,8 +97,12 @@ class ObjIeeeBinary : public ObjIOBase
         sfile = fil;
         factory = Factory;
         file = nullptr;
+        mapped = nullptr;
         return HandleRead(ParseType);
     }
+    // reads the module at Offset in a file which is already mapped, so the members
+    // of a library can all be parsed from one mapping
+    ObjFile* Read(const MappedFile& Map, size_t Offset, eParseType ParseType, ObjFactory* Factory);
     virtual bool BinaryWrite(FILE* fil, ObjFile* File, ObjFactory* Factory)
     {
         sfile = fil;
@@ -248,7 +256,7 @@ class ObjIeeeBinary : public ObjIOBase
         ioBufferLen = 0;
         fflush(sfile);
     }
-    void getline(ObjByte* buf, size_t size);
+    const ObjByte* getline(ObjByte* buf, size_t size);
     void WriteHeader();
     void WriteFiles();
     void WriteSectionHeaders();
@@ -322,6 +330,10 @@ class ObjIeeeBinary : public ObjIOBase
     std::unique_ptr<char[]> ioBuffer;
     size_t ioBufferLen;
     size_t ioBufferPos;
+    // the file being read when it is mapped, records are parsed in place
+    const ObjByte* mapped;
+    size_t mappedPos;
+    size_t mappedSize;
     int lineno;
     bool first;
 };
@@ -25,6 +25,7 @@
 
 #include "ObjFactory.h"
 #include "ObjIeee.h"
+#include "MappedFile.h"
 #include <cstdio>
 #include <stack>
 #include <cctype>
@@ -35,11 +36,12 @@ ObjString ObjIeeeBinary::ParseString(const ObjByte* buffer, int* pos)
 {
     int len = buffer[(*pos)++] << 8;
     len += buffer[(*pos)++];
-    char name[4096];
-    memcpy(name, buffer + *pos, len);
-    name[len] = '\0';
+    const char* name = (const char*)buffer + *pos;
     *pos += len;
-    return name;
+    const char* end = (const char*)memchr(name, 0, len);
+    if (end)
+        len = end - name;
+    return ObjString(name, len);
 }
 void ObjIeeeBinary::ParseTime(const ObjByte* buffer, std::tm& tms, int* pos)
 {
@@ -251,18 +253,45 @@ bool ObjIeeeBinary::Parse(const ObjByte* buffer, eParseType ParseType)
             ThrowSyntax(buffer, eAll);
     }
 }
-void ObjIeeeBinary::getline(ObjByte* buf, size_t size)
+const ObjByte* ObjIeeeBinary::getline(ObjByte* buf, size_t size)
 {
+    if (mapped)
+    {
+        if (mappedSize - mappedPos < 3)
+        {
+            memset(buf, 0, 3);
+            return buf;
+        }
+        const ObjByte* rv = mapped + mappedPos;
+        int len = (rv[1] << 8) + rv[2];
+        if (len < 3 || len > mappedSize - mappedPos)
+            ThrowSyntax(rv, eAll);
+        mappedPos += len;
+        return rv;
+    }
     if (!fread(buf, 1, 3, sfile))
     {
         memset(buf, 0, 3);
-        return;
+        return buf;
     }
     int len = (buf[1] << 8) + buf[2];
-    if (len > BUFFERSIZE)
+    if (len > size)
         ThrowSyntax(buf, eAll);
     if (fread(buf + 3, 1, len - 3, sfile) != len - 3)
         ThrowSyntax(buf, eAll);
+    return buf;
+}
+ObjFile* ObjIeeeBinary::Read(const MappedFile& Map, size_t Offset, eParseType ParseType, ObjFactory* Factory)
+{
+    if (!Map.IsOpen() || Offset > Map.Size())
+        return nullptr;
+    sfile = nullptr;
+    factory = Factory;
+    file = nullptr;
+    mapped = Map.Data();
+    mappedPos = Offset;
+    mappedSize = Map.Size();
+    return HandleRead(ParseType);
 }
 ObjFile* ObjIeeeBinary::HandleRead(eParseType ParseType)
 {
@@ -282,27 +311,53 @@ ObjFile* ObjIeeeBinary::HandleRead(eParseType ParseType)
     sections.clear();
     files.clear();
     currentDataSection = nullptr;
+    // parse the records straight out of the file when it can be mapped, the stream
+    // is left positioned after the module either way.  Library members come in with
+    // the library already mapped and no stream
+    std::unique_ptr<MappedFile> map;
+    if (!mapped)
+    {
+        map = std::make_unique<MappedFile>(sfile);
+        long start = ftell(sfile);
+        if (map->IsOpen() && start >= 0 && start <= map->Size())
+        {
+            mapped = map->Data();
+            mappedPos = start;
+            mappedSize = map->Size();
+        }
+    }
     while (!done)
     {
-        ObjByte inBuf[10000];
-        getline(inBuf, sizeof(inBuf));
-        GatherCS(inBuf);
+        ObjByte inBuf[BUFFERSIZE];
+        const ObjByte* record = getline(inBuf, sizeof(inBuf));
+        GatherCS(record);
         try
         {
-            done = Parse(inBuf, ParseType);
+            done = Parse(record, ParseType);
             first = false;
         }
         catch (BadCS& e)
         {
-            ioBuffer = nullptr;
-            return nullptr;
+            done = true;
+            file = nullptr;
         }
         catch (SyntaxError& e)
         {
-            ioBuffer = nullptr;
-            return nullptr;
+            done = true;
+            file = nullptr;
         }
     }
+    if (mapped)
+    {
+        if (sfile)
+            fseek(sfile, mappedPos, SEEK_SET);
+        mapped = nullptr;
+    }
+    if (!file)
+    {
+        ioBuffer = nullptr;
+        return nullptr;
+    }
     for (int i = 0; i < publics.size(); i++)
         if (publics[i])
             file->Add(publics[i]);
@@ -869,11 +924,12 @@ bool ObjIeeeBinary::Comment(const ObjByte* buffer, eParseType ParseType)
             ObjBrowseInfo::eQual qual;
             type = (ObjBrowseInfo::eType)GetIndex(buffer, &pos);
             qual = (ObjBrowseInfo::eQual)GetDWord(buffer, &pos);
-            int filenum = GetDWord(buffer, &pos);
+            // RenderBrowseInfo writes the file as an index
+            int filenum = GetIndex(buffer, &pos);
             int lineno = GetDWord(buffer, &pos);
             int charpos = GetWord(buffer, &pos);
             ObjString extra = ParseString(buffer, &pos);
-            ObjSourceFile* sf = files[filenum];
+            ObjSourceFile* sf = GetFile(filenum);
             if (!sf)
                 ThrowSyntax(buffer, ParseType);
             ObjLineNo* line = factory->MakeLineNo(sf, lineno);
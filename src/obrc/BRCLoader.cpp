@@ -258,12 +258,20 @@ void BRCLoader::LoadSourceFiles(ObjFile& fil)
         indexMap[(*it)->GetIndex()] = index;
     }
 }
-bool BRCLoader::load()
+std::vector<std::string> BRCLoader::GetBrowseFiles()
 {
-    bool rv = true;
+    std::vector<std::string> rv;
     for (int i = 2; i < files.size(); ++i)
+        rv.push_back(files[i]);
+    return rv;
+}
+bool BRCLoader::load(const std::set<std::string>* only)
+{
+    bool rv = true;
+    for (auto&& name : GetBrowseFiles())
     {
-        std::string name = files[i];
+        if (only && only->find(name) == only->end())
+            continue;
         ObjIeeeIndexManager im1;
         ObjFactory fact1(&im1);
         FILE* b = fopen(name.c_str(), "rb");
@@ -277,6 +285,9 @@ bool BRCLoader::load()
             if (fil)
             {
                 LoadSourceFiles(*fil);
+                std::set<int>& sources = browseSources[name];
+                for (auto&& index : indexMap)
+                    sources.insert(index.second);
                 ParseData(*fil);
             }
             else
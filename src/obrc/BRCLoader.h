@@ -33,6 +33,7 @@
 #include <deque>
 #include <set>
 #include <memory>
+#include <vector>
 
 class ObjFile;
 class ObjBrowseInfo;
@@ -92,10 +93,13 @@ class BRCLoader
   public:
     BRCLoader(CmdFiles& Files) : files(Files), currentFile(0), blockHead(0) {}
     ~BRCLoader();
-    bool load();
+    bool load(const std::set<std::string>* only = nullptr);
 
+    std::vector<std::string> GetBrowseFiles();
     Symbols& GetSymbols() { return syms; }
     std::map<std::string, int>& GetFileNames() { return nameMap; }
+    // source file indexes referenced by each browse file that was loaded
+    std::map<std::string, std::set<int>>& GetBrowseSources() { return browseSources; }
 
   protected:
     void InsertSymData(std::string s, BrowseData* data, bool func = false);
@@ -116,6 +120,7 @@ class BRCLoader
     CmdFiles& files;
     std::map<std::string, int> nameMap;
     std::map<int, int> indexMap;
+    std::map<std::string, std::set<int>> browseSources;
     Symbols syms;
     std::vector<BlockData*> blocks;
     int blockHead;
@@ -50,9 +50,11 @@ int main(int argc, char** argv)
 }
 
 CmdSwitchParser BRCMain::SwitchParser;
+CmdSwitchBool BRCMain::Incremental(SwitchParser, 'u', false, {"update"});
 const char* BRCMain::helpText =
     "[options] outputfile filelist \n"
     "\n"
+    "/u, --update   Update an existing database with changed files only\n"
     "/V, --version  Show version and date\n"
     "/!, --nologo   No logo\n"
     "/?, --help     This text\n"
@@ -71,11 +73,13 @@ int BRCMain::Run(int argc, char** argv)
     ObjString outputFile = Utils::QualifiedFile(argv[1], ".obr");
 
     BRCLoader loader(files);
-    bool ok = loader.load();
+    BRCWriter writer(outputFile, loader);
+    std::set<std::string> changed;
+    bool incremental = Incremental.GetValue() && writer.Compare(changed);
+    bool ok = loader.load(incremental ? &changed : nullptr);
     if (ok)
     {
-        BRCWriter writer(outputFile, loader);
-        ok = writer.write();
+        ok = incremental ? writer.update() : writer.write();
     }
     return !ok;
 }
@@ -39,6 +39,7 @@ class BRCMain
   private:
     static CmdSwitchParser SwitchParser;
     static CmdSwitchFile File;
+    static CmdSwitchBool Incremental;
 
     static const char* usageText;
     static const char* helpText;
@@ -27,6 +27,7 @@
 #include "BRCWriter.h"
 #include "ObjBrowseInfo.h"
 #include "Utils.h"
+#include "sqlvt.h"
 #include <cstdio>
 #include <algorithm>
 #include <cstring>
@@ -37,7 +38,7 @@
 #    include <io.h>
 #endif
 
-#define STRINGVERSION "120"
+#define STRINGVERSION "121"
 
 #define DBVersion std::atoi(STRINGVERSION)
 
@@ -103,6 +104,17 @@ const char* BRCWriter::tables = {
     "  simpleId INTEGER"
     " ,complexId INTEGER"
     " );"
+    "CREATE TABLE BrowseFiles ("
+    " id INTEGER PRIMARY KEY AUTOINCREMENT"
+    " ,name VARCHAR(260)"
+    " ,hash INTEGER"
+    " );"
+    "CREATE TABLE BrowseSources ("
+    " browseId INTEGER"
+    " ,fileId INTEGER"
+    " ,FOREIGN KEY (browseId) REFERENCES BrowseFiles(id)"
+    " ,FOREIGN KEY (fileId) REFERENCES FileNames(id)"
+    " );"
     "INSERT INTO brPropertyBag (property, value)"
     " VALUES (\"brVersion\", " STRINGVERSION
     ");"
@@ -115,11 +127,26 @@ const char* BRCWriter::deletion = {
     "DELETE FROM Usages;"
     "DELETE FROM JumpTable;"
     "DELETE FROM CPPNameMapping;"
+    "DELETE FROM BrowseFiles;"
+    "DELETE FROM BrowseSources;"
     "COMMIT;"};
-BRCWriter::~BRCWriter() {}
+// names and mappings left behind by rows an update removed
+const char* BRCWriter::prune = {
+    "DELETE FROM CPPNameMapping WHERE complexId NOT IN"
+    " (SELECT symbolId FROM LineNumbers UNION SELECT symbolId FROM Usages);"
+    "DELETE FROM Names WHERE id NOT IN"
+    " (SELECT symbolId FROM LineNumbers UNION SELECT symbolId FROM Usages UNION SELECT simpleId FROM CPPNameMapping);"};
+BRCWriter::~BRCWriter()
+{
+    if (dbPointer)
+        sqlite3_close(dbPointer);
+}
 bool BRCWriter::Begin(void)
 {
     bool rv = true;
+    // an incremental update runs in a single transaction
+    if (incremental)
+        return rv;
     if (!SQLiteExec("BEGIN"))
     {
         rv = false;
@@ -129,6 +156,8 @@ bool BRCWriter::Begin(void)
 bool BRCWriter::End(void)
 {
     bool rv = true;
+    if (incremental)
+        return rv;
     if (!SQLiteExec("COMMIT"))
     {
         rv = false;
@@ -228,40 +257,6 @@ int BRCWriter::DBOpen(char* name)
         sqlite3_busy_timeout(dbPointer, 800);
     return rv;
 }
-bool BRCWriter::Insert(sqlite3_int64 simpleId, sqlite3_int64 complexId)
-{
-    static const char* query = "INSERT INTO CPPNameMapping (simpleId, complexId) VALUES (?, ?)";
-    int rc = SQLITE_OK;
-    static sqlite3_stmt* handle;
-    if (!handle)
-    {
-        rc = sqlite3_prepare_v2(dbPointer, query, strlen(query) + 1, &handle, nullptr);
-    }
-    if (rc == SQLITE_OK)
-    {
-        int done = false;
-        sqlite3_reset(handle);
-        sqlite3_bind_int(handle, 1, simpleId);
-        sqlite3_bind_int(handle, 2, complexId);
-        while (!done)
-        {
-            switch (rc = sqlite3_step(handle))
-            {
-                case SQLITE_BUSY:
-                    done = true;
-                    break;
-                case SQLITE_DONE:
-                    rc = SQLITE_OK;
-                    done = true;
-                    break;
-                default:
-                    done = true;
-                    break;
-            }
-        }
-    }
-    return rc == SQLITE_OK;
-}
 bool BRCWriter::Insert(std::string fileName, int index)
 {
     static const char* query = "INSERT INTO FileNames (name) VALUES (?)";
@@ -337,11 +332,9 @@ bool BRCWriter::Insert(std::string symName, int type, sqlite3_int64* id)
     }
     return rc == SQLITE_OK;
 }
-bool BRCWriter::Insert(sqlite3_int64 fileId, int start, int end, sqlite3_int64 nameIndex)
+bool BRCWriter::InsertBrowseFile(std::string browseName, sqlite3_int64 hash, sqlite3_int64* id)
 {
-    static const char* query =
-        "INSERT INTO JumpTable (symbolId, fileId, startLine, endLine)"
-        " VALUES (?,?,?,?)";
+    static const char* query = "INSERT INTO BrowseFiles (name, hash) VALUES (?,?)";
     int rc = SQLITE_OK;
     static sqlite3_stmt* handle;
     if (!handle)
@@ -352,10 +345,8 @@ bool BRCWriter::Insert(sqlite3_int64 fileId, int start, int end, sqlite3_int64 n
     {
         int done = false;
         sqlite3_reset(handle);
-        sqlite3_bind_int64(handle, 1, nameIndex);
-        sqlite3_bind_int64(handle, 2, fileId);
-        sqlite3_bind_int(handle, 3, start);
-        sqlite3_bind_int(handle, 4, end);
+        sqlite3_bind_text(handle, 1, browseName.c_str(), browseName.size(), SQLITE_STATIC);
+        sqlite3_bind_int64(handle, 2, hash);
         while (!done)
         {
             switch (rc = sqlite3_step(handle))
@@ -373,53 +364,69 @@ bool BRCWriter::Insert(sqlite3_int64 fileId, int start, int end, sqlite3_int64 n
             }
         }
     }
+    if (rc == SQLITE_OK)
+    {
+        *id = sqlite3_last_insert_rowid(dbPointer);
+    }
     return rc == SQLITE_OK;
 }
-bool BRCWriter::Insert(sqlite3_int64 symIndex, BrowseData* b, bool usages)
+bool BRCWriter::BulkExec(const char* query, std::vector<sqlite3_int64>& data, int columns)
 {
-    static const char* query =
-        "INSERT INTO LineNumbers (type, qual, symbolId, fileId, startLine, charPos, hint)"
-        " VALUES (?,?,?,?,?,?,?)";
-    static const char* query1 =
-        "INSERT INTO Usages (type, qual, symbolId, fileId, startLine, charPos, hint)"
-        " VALUES (?,?,?,?,?,?,?)";
-    int rc = SQLITE_OK;
-    static sqlite3_stmt *handle, *handle1;
-    if (!handle)
+    if (data.empty())
+        return true;
+    IntegerColumnsVirtualTable table(data, columns);
+    bool rv = table.Start(dbPointer) == SQLITE_OK;
+    if (rv)
     {
-        rc = sqlite3_prepare_v2(dbPointer, query1, strlen(query1) + 1, &handle1, nullptr);
-        rc = sqlite3_prepare_v2(dbPointer, query, strlen(query) + 1, &handle, nullptr);
+        // the query may name the virtual table twice
+        char* zSql = sqlite3_mprintf(query, table.GetName(), table.GetName());
+        rv = SQLiteExec(zSql);
+        sqlite3_free(zSql);
     }
-    if (rc == SQLITE_OK)
+    table.Stop();
+    return rv;
+}
+bool BRCWriter::Select(const char* query, std::vector<sqlite3_int64>& data, std::vector<std::string>* names)
+{
+    sqlite3_stmt* handle;
+    int rc = sqlite3_prepare_v2(dbPointer, query, strlen(query) + 1, &handle, nullptr);
+    if (rc != SQLITE_OK)
+        return false;
+    while ((rc = sqlite3_step(handle)) == SQLITE_ROW)
     {
-        int done = false;
-        sqlite3_stmt* iHandle = usages ? handle1 : handle;
-        sqlite3_reset(iHandle);
-        sqlite3_bind_int(iHandle, 1, b->type | (b->blockLevel == 0 ? 0x4000 : 0));
-        sqlite3_bind_int(iHandle, 2, b->qual);
-        sqlite3_bind_int64(iHandle, 3, symIndex);
-        sqlite3_bind_int64(iHandle, 4, fileMap[b->fileIndex]);
-        sqlite3_bind_int(iHandle, 5, b->startLine);
-        sqlite3_bind_int(iHandle, 6, b->charPos);
-        sqlite3_bind_text(iHandle, 7, b->hint.c_str(), b->hint.size(), SQLITE_STATIC);
-        while (!done)
+        int n = sqlite3_column_count(handle);
+        for (int i = 0; i < n; i++)
         {
-            switch (rc = sqlite3_step(iHandle))
-            {
-                case SQLITE_BUSY:
-                    done = true;
-                    break;
-                case SQLITE_DONE:
-                    rc = SQLITE_OK;
-                    done = true;
-                    break;
-                default:
-                    done = true;
-                    break;
-            }
+            if (names && sqlite3_column_type(handle, i) == SQLITE_TEXT)
+                names->push_back((const char*)sqlite3_column_text(handle, i));
+            else
+                data.push_back(sqlite3_column_int64(handle, i));
         }
     }
-    return rc == SQLITE_OK;
+    sqlite3_finalize(handle);
+    return rc == SQLITE_DONE;
+}
+sqlite3_int64 BRCWriter::HashFile(const std::string& name)
+{
+    // FNV-1a over the file contents
+    sqlite3_uint64 hash = UINT64_C(14695981039346656037);
+    FILE* fil = fopen(name.c_str(), "rb");
+    if (fil)
+    {
+        unsigned char buf[16384];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), fil)) != 0)
+            for (size_t i = 0; i < n; i++)
+                hash = (hash ^ buf[i]) * UINT64_C(1099511628211);
+        fclose(fil);
+    }
+    return (sqlite3_int64)hash;
+}
+void BRCWriter::HashBrowseFiles()
+{
+    if (browseHashes.empty())
+        for (auto&& name : loader.GetBrowseFiles())
+            browseHashes[name] = HashFile(name);
 }
 char easytolower(char in)
 {
@@ -427,6 +434,76 @@ char easytolower(char in)
         return in - ('Z' - 'z');
     return in;
 }
+bool BRCWriter::LoadFileList()
+{
+    std::vector<sqlite3_int64> data;
+    std::vector<std::string> names;
+    if (!Select("SELECT id, name FROM FileNames", data, &names) || data.size() != names.size())
+        return false;
+    for (int i = 0; i < names.size(); i++)
+        fileIds[names[i]] = data[i];
+    return true;
+}
+bool BRCWriter::UpdateFileList(std::set<sqlite3_int64>& affected)
+{
+    if (!LoadFileList())
+        return false;
+    // every source file seen in a reloaded browse file gets its rows replaced
+    std::map<std::string, int>& unsorted = loader.GetFileNames();
+    for (auto item : unsorted)
+    {
+        std::string myString = item.first;
+        std::transform(myString.begin(), myString.end(), myString.begin(), easytolower);
+        auto it = fileIds.find(myString);
+        if (it == fileIds.end())
+        {
+            if (!Insert(myString, item.second))
+                return false;
+            fileIds[myString] = fileMap[item.second];
+        }
+        else
+        {
+            fileMap[item.second] = it->second;
+        }
+        affected.insert(fileMap[item.second]);
+    }
+    // browse files which changed or were removed from the command line are stale.
+    // their source files go too, unless an unchanged browse file still references them
+    std::vector<sqlite3_int64> stale;
+    for (auto&& file : browseFiles)
+    {
+        auto it = browseHashes.find(file.first);
+        if (it == browseHashes.end() || it->second != file.second.second)
+            stale.push_back(file.second.first);
+    }
+    std::set<sqlite3_int64> staleSet(stale.begin(), stale.end());
+    std::vector<sqlite3_int64> data;
+    if (!Select("SELECT browseId, fileId FROM BrowseSources", data))
+        return false;
+    std::set<sqlite3_int64> kept, orphans;
+    for (int i = 0; i + 1 < data.size(); i += 2)
+    {
+        if (staleSet.find(data[i]) != staleSet.end())
+            orphans.insert(data[i + 1]);
+        else
+            kept.insert(data[i + 1]);
+    }
+    for (auto id : orphans)
+        if (kept.find(id) == kept.end())
+            affected.insert(id);
+    std::vector<sqlite3_int64> ids(affected.begin(), affected.end());
+    if (!BulkExec("DELETE FROM LineNumbers WHERE fileId IN (SELECT v0 FROM TEMP.%Q)", ids, 1) ||
+        !BulkExec("DELETE FROM Usages WHERE fileId IN (SELECT v0 FROM TEMP.%Q)", ids, 1) ||
+        !BulkExec("DELETE FROM JumpTable WHERE fileId IN (SELECT v0 FROM TEMP.%Q)", ids, 1) ||
+        !BulkExec("DELETE FROM BrowseSources WHERE browseId IN (SELECT v0 FROM TEMP.%Q)", stale, 1) ||
+        !BulkExec("DELETE FROM BrowseFiles WHERE id IN (SELECT v0 FROM TEMP.%Q)", stale, 1))
+        return false;
+    data.clear();
+    if (!Select("SELECT symbolId FROM JumpTable", data))
+        return false;
+    jumpSymbols.insert(data.begin(), data.end());
+    return true;
+}
 bool BRCWriter::WriteFileList()
 {
     Begin();
@@ -517,6 +594,17 @@ bool BRCWriter::WriteDictionary(Symbols& syms)
         syms[sym.first] = std::move(sym.second);
     }
     newSyms.clear();
+    std::unordered_map<std::string, std::pair<sqlite3_int64, int>> names;
+    std::vector<sqlite3_int64> updates;
+    if (incremental)
+    {
+        std::vector<sqlite3_int64> data;
+        std::vector<std::string> nameList;
+        if (!Select("SELECT id, type, name FROM Names", data, &nameList) || data.size() != nameList.size() * 2)
+            return false;
+        for (int i = 0; i < nameList.size(); i++)
+            names[nameList[i]] = std::make_pair(data[i * 2], (int)data[i * 2 + 1]);
+    }
     Begin();
     for (auto& sym1 : syms)
     {
@@ -554,59 +642,106 @@ bool BRCWriter::WriteDictionary(Symbols& syms)
                     break;
             }
         }
+        if (incremental)
+        {
+            auto it = names.find(sym1.first);
+            if (it != names.end())
+            {
+                sym->index = it->second.first;
+                if ((it->second.second | type) != it->second.second)
+                {
+                    updates.push_back(sym->index);
+                    updates.push_back(it->second.second | type);
+                }
+                continue;
+            }
+        }
         if (!Insert(sym1.first, type, &sym->index))
             return false;
     }
+    if (!BulkExec("UPDATE Names SET type = (SELECT v1 FROM TEMP.%Q WHERE v0 = Names.id)"
+                  " WHERE id IN (SELECT v0 FROM TEMP.%Q)",
+                  updates, 2))
+        return false;
     End();
     return true;
 }
 bool BRCWriter::WriteMapping(Symbols& syms)
 {
-    Begin();
+    std::set<std::pair<sqlite3_int64, sqlite3_int64>> existing;
+    if (incremental)
+    {
+        std::vector<sqlite3_int64> data;
+        if (!Select("SELECT simpleId, complexId FROM CPPNameMapping", data))
+            return false;
+        for (int i = 0; i + 1 < data.size(); i += 2)
+            existing.insert(std::make_pair(data[i], data[i + 1]));
+    }
+    std::vector<sqlite3_int64> data;
     for (auto& sym : syms)
     {
         SymData* s = sym.second.get();
         for (auto map : s->mapping)
-            Insert(s->index, map->index);
+        {
+            if (existing.find(std::make_pair((sqlite3_int64)s->index, (sqlite3_int64)map->index)) == existing.end())
+            {
+                data.push_back(s->index);
+                data.push_back(map->index);
+            }
+        }
     }
+    Begin();
+    bool rv = BulkExec("INSERT INTO CPPNameMapping (simpleId, complexId) SELECT v0, v1 FROM TEMP.%Q", data, 2);
     End();
-    return true;
+    return rv;
+}
+void BRCWriter::PushLineData(sqlite3_int64 symIndex, BrowseData* b, std::vector<sqlite3_int64>& data)
+{
+    data.push_back(b->type | (b->blockLevel == 0 ? 0x4000 : 0));
+    data.push_back(b->qual);
+    data.push_back(symIndex);
+    data.push_back(fileMap[b->fileIndex]);
+    data.push_back(b->startLine);
+    data.push_back(b->charPos);
 }
 bool BRCWriter::WriteLineData(Symbols& syms)
 {
-    Begin();
+    std::vector<sqlite3_int64> data;
     for (auto& sym : syms)
     {
         SymData* s = sym.second.get();
         for (auto& bd : s->data)
-        {
-            if (bd->qual != ObjBrowseInfo::eExternal || !s->globalCount)
-                if (!Insert(s->index, bd.get()))
-                    return false;
-        }
+            PushLineData(s->index, bd.get(), data);
     }
+    // the loader never fills in a hint
+    Begin();
+    bool rv = BulkExec(
+        "INSERT INTO LineNumbers (type, qual, symbolId, fileId, startLine, charPos, hint)"
+        " SELECT v0, v1, v2, v3, v4, v5, '' FROM TEMP.%Q",
+        data, 6);
     End();
-    return true;
+    return rv;
 }
 bool BRCWriter::WriteUsageData(Symbols& syms)
 {
-    Begin();
+    std::vector<sqlite3_int64> data;
     for (auto& sym : syms)
     {
         SymData* s = sym.second.get();
         for (auto& bd : s->usages)
-        {
-            if (bd->qual != ObjBrowseInfo::eExternal || !s->globalCount)
-                if (!Insert(s->index, bd.get(), true))
-                    return false;
-        }
+            PushLineData(s->index, bd.get(), data);
     }
+    Begin();
+    bool rv = BulkExec(
+        "INSERT INTO Usages (type, qual, symbolId, fileId, startLine, charPos, hint)"
+        " SELECT v0, v1, v2, v3, v4, v5, '' FROM TEMP.%Q",
+        data, 6);
     End();
-    return true;
+    return rv;
 }
 bool BRCWriter::WriteJumpTable(Symbols& syms)
 {
-    Begin();
+    std::vector<sqlite3_int64> data, replaced;
     for (auto& sym : syms)
     {
         SymData* s = sym.second.get();
@@ -627,24 +762,104 @@ bool BRCWriter::WriteJumpTable(Symbols& syms)
                     }
                 }
             }
-            if (!gl)
+            // when updating, a definition kept from an unchanged file wins over a declaration
+            if (!gl && (!incremental || jumpSymbols.find(s->index) == jumpSymbols.end()))
                 gl = ex;
             if (gl)
             {
-                int st = gl->startLine;
-                int end = gl->funcEndLine;
-                if (!Insert(fileMap[gl->fileIndex], st, end, s->index))
-                    return false;
+                if (incremental && jumpSymbols.find(s->index) != jumpSymbols.end())
+                    replaced.push_back(s->index);
+                data.push_back(s->index);
+                data.push_back(fileMap[gl->fileIndex]);
+                data.push_back(gl->startLine);
+                data.push_back(gl->funcEndLine);
             }
         }
     }
+    Begin();
+    // a symbol has one row, so a row kept from an unchanged file gives way to the new one
+    bool rv = BulkExec("DELETE FROM JumpTable WHERE symbolId IN (SELECT v0 FROM TEMP.%Q)", replaced, 1) &&
+              BulkExec("INSERT INTO JumpTable (symbolId, fileId, startLine, endLine) SELECT v0, v1, v2, v3 FROM TEMP.%Q", data, 4);
     End();
-    return true;
+    return rv;
+}
+bool BRCWriter::WriteBrowseFiles()
+{
+    std::vector<sqlite3_int64> data;
+    Begin();
+    for (auto&& browse : loader.GetBrowseSources())
+    {
+        sqlite3_int64 id;
+        if (!InsertBrowseFile(browse.first, browseHashes[browse.first], &id))
+            return false;
+        for (auto index : browse.second)
+        {
+            data.push_back(id);
+            data.push_back(fileMap[index]);
+        }
+    }
+    bool rv = BulkExec("INSERT INTO BrowseSources (browseId, fileId) SELECT v0, v1 FROM TEMP.%Q", data, 2);
+    End();
+    return rv;
+}
+bool BRCWriter::Compare(std::set<std::string>& changed)
+{
+    HashBrowseFiles();
+    if (sqlite3_open_v2(outputFile.c_str(), &dbPointer, SQLITE_OPEN_READWRITE, nullptr) == SQLITE_OK)
+    {
+        std::vector<sqlite3_int64> data;
+        std::vector<std::string> names;
+        if (CheckDb() && Select("SELECT id, hash, name FROM BrowseFiles", data, &names) && data.size() == names.size() * 2)
+        {
+            for (int i = 0; i < names.size(); i++)
+                browseFiles[names[i]] = std::make_pair(data[i * 2], data[i * 2 + 1]);
+            for (auto&& hash : browseHashes)
+            {
+                auto it = browseFiles.find(hash.first);
+                if (it == browseFiles.end() || it->second.second != hash.second)
+                    changed.insert(hash.first);
+            }
+            incremental = true;
+        }
+    }
+    if (!incremental && dbPointer)
+    {
+        sqlite3_close(dbPointer);
+        dbPointer = nullptr;
+    }
+    return incremental;
+}
+bool BRCWriter::update()
+{
+    Symbols& syms = loader.GetSymbols();
+    std::set<sqlite3_int64> affected;
+
+    sqlite3_busy_timeout(dbPointer, 800);
+    bool ok = SQLiteExec("PRAGMA journal_mode=MEMORY; PRAGMA temp_store = MEMORY; BEGIN");
+    if (ok)
+    {
+        ok = false;
+        if (UpdateFileList(affected))
+            if (WriteDictionary(syms))
+                if (WriteMapping(syms))
+                    if (WriteLineData(syms))
+                        if (WriteUsageData(syms))
+                            if (WriteJumpTable(syms))
+                                if (WriteBrowseFiles())
+                                    if (SQLiteExec(prune))
+                                        ok = SQLiteExec("COMMIT");
+        if (!ok)
+            SQLiteExec("ROLLBACK");
+    }
+    sqlite3_close(dbPointer);
+    dbPointer = nullptr;
+    return ok;
 }
 bool BRCWriter::write()
 {
     Symbols& syms = loader.GetSymbols();
 
+    HashBrowseFiles();
     bool ok = DBOpen((char*)outputFile.c_str());
 
     if (ok)
@@ -656,7 +871,8 @@ bool BRCWriter::write()
                     if (WriteLineData(syms))
                         if (WriteUsageData(syms))
                             if (WriteJumpTable(syms))
-                                ok = true;
+                                if (WriteBrowseFiles())
+                                    ok = true;
     }
     else
     {
@@ -664,5 +880,6 @@ bool BRCWriter::write()
     }
     if (dbPointer)
         sqlite3_close(dbPointer);
+    dbPointer = nullptr;
     return ok;
 }
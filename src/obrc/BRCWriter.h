@@ -28,6 +28,10 @@
 
 #include <string>
 #include <fstream>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
 #include "sqlite3.h"
 
 class BRCLoader;
@@ -36,12 +40,16 @@ class BRCWriter
 {
   public:
     BRCWriter(std::string OutputFile, BRCLoader& Loader) :
-        outputFile(OutputFile), loader(Loader), fileListCount(0), dbPointer(nullptr)
+        outputFile(OutputFile), loader(Loader), fileListCount(0), dbPointer(nullptr), incremental(false)
     {
     }
     ~BRCWriter();
 
+    // open an existing database and find the browse files which have changed since it was written.
+    // returns false if the database can't be updated incrementally
+    bool Compare(std::set<std::string>& changed);
     bool write();
+    bool update();
 
   protected:
     bool Begin(void);
@@ -52,12 +60,15 @@ class BRCWriter
     int CheckDb(void);
     int CreateTables(void);
     int DBOpen(char* name);
+    void HashBrowseFiles();
+    static sqlite3_int64 HashFile(const std::string& name);
+    bool BulkExec(const char* query, std::vector<sqlite3_int64>& data, int columns);
+    bool Select(const char* query, std::vector<sqlite3_int64>& data, std::vector<std::string>* names = nullptr);
 
-    bool Insert(sqlite3_int64 simpleId, sqlite3_int64 complexId);
     bool Insert(std::string fileName, int index);
     bool Insert(std::string symName, int type, sqlite3_int64* id);
-    bool Insert(sqlite3_int64 fileIndex, int start, int end, sqlite3_int64 nameIndex);
-    bool Insert(sqlite3_int64 symIndex, BrowseData* b, bool usages = false);
+    bool InsertBrowseFile(std::string browseName, sqlite3_int64 hash, sqlite3_int64* id);
+    void PushLineData(sqlite3_int64 symIndex, BrowseData* b, std::vector<sqlite3_int64>& data);
 
     bool WriteFileList();
     void InsertMappingSym(std::string name, SymData* orig, Symbols& syms, Symbols& newSyms);
@@ -67,6 +78,9 @@ class BRCWriter
     bool WriteLineData(Symbols& syms);
     bool WriteUsageData(Symbols& syms);
     bool WriteJumpTable(Symbols& syms);
+    bool WriteBrowseFiles();
+    bool LoadFileList();
+    bool UpdateFileList(std::set<sqlite3_int64>& affected);
 
     BRCLoader& loader;
 
@@ -75,8 +89,15 @@ class BRCWriter
     int fileListCount;
     sqlite3* dbPointer;
     std::map<int, sqlite3_int64> fileMap;
+    std::map<std::string, sqlite3_int64> browseHashes;
+    // browse file name -> id, hash of the browse files already in the database
+    std::map<std::string, std::pair<sqlite3_int64, sqlite3_int64>> browseFiles;
+    std::unordered_map<std::string, sqlite3_int64> fileIds;
+    std::set<sqlite3_int64> jumpSymbols;
+    bool incremental;
 
     static const char* tables;
     static const char* deletion;
+    static const char* prune;
 };
 #endif
@@ -161,14 +161,14 @@ asmError InstructionParser::GetInstruction(OCODE* ins, std::shared_ptr<Instructi
         case op_repz:
         case op_repe:
         case op_rep:
-            newIns = std::make_shared<Instruction>((unsigned char*)"\xf3", 1, true);
+            newIns = AsmArena::Make<Instruction>((unsigned char*)"\xf3", 1, true);
             break;
         case op_repnz:
         case op_repne:
-            newIns = std::make_shared<Instruction>((unsigned char*)"\xf2", 1, true);
+            newIns = AsmArena::Make<Instruction>((unsigned char*)"\xf2", 1, true);
             break;
         case op_lock:
-            newIns = std::make_shared<Instruction>((unsigned char*)"\xf0", 1, true);
+            newIns = AsmArena::Make<Instruction>((unsigned char*)"\xf0", 1, true);
             break;
         default: {
             switch (ins->opcode)
@@ -267,7 +267,7 @@ asmError InstructionParser::GetInstruction(OCODE* ins, std::shared_ptr<Instructi
             {
                 unsigned char buf[64];
                 bits.GetBytes(buf, (bits.GetBits() + 7) / 8);
-                newIns = std::make_shared<Instruction>(buf, (bits.GetBits() + 7) / 8);
+                newIns = AsmArena::Make<Instruction>(buf, (bits.GetBits() + 7) / 8);
                 operands = this->operands;
             }
             return rv;
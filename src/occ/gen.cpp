@@ -40,6 +40,8 @@
 #include "symfuncs.h"
 #include "gen.h"
 #include "ioptutil.h"
+#include "iblock.h"
+#include "itail.h"
 #define CONSTS_ONLY
 #include "rtti.h"
 #define MAX_ALIGNS 50
@@ -58,6 +60,9 @@ static int switch_deflab;
 static long long switch_range, switch_case_count, switch_case_max;
 static Optimizer::IMODE* switch_ip;
 static enum { swm_enumerate, swm_compactstart, swm_compact, swm_tree } switch_mode;
+static Optimizer::QUAD* vectorFunc;
+static int vectorScratch[2];
+static bool vectorSave;
 static int switch_lastcase;
 static AMODE *switch_apl, *switch_aph;
 static int switch_live;
@@ -2727,6 +2732,8 @@ void asm_parmblock(Optimizer::QUAD* q) /* push a block of memory */
 void asm_parmadj(Optimizer::QUAD* q) /* adjust stack after function call */
 {
     int mask;
+    if (q->tailcall) /* the stack was cleaned up before jumping to the function */
+        return;
     int i = beGetIcon(q->dc.left);
     if (i)
     {
@@ -2783,6 +2790,50 @@ static bool bltin_gosub(Optimizer::QUAD* q)
     }
     return false;
 }
+/*
+ * the optimizer marks calls whose result goes straight to the return.  The
+ * arguments we pushed get copied over our own incoming arguments, then the frame
+ * is torn down and we jump to the callee, which returns to our caller.  The copy
+ * goes from the top down, since the destination is always above the source.
+ * The stack adjustment and the epilogue are found by following the code from the
+ * call to the return the same way the optimizer did, through any gotos.
+ */
+static void gen_tailcall(Optimizer::QUAD* q, AMODE* target)
+{
+    Optimizer::QUAD *parmadj, *epilogue, *ret;
+    Optimizer::TailLabels(Optimizer::intermed_head);
+    if (!Optimizer::TailFollow(q, &parmadj, &epilogue, &ret))
+    {
+        gen_code(op_call, target, nullptr);
+        return;
+    }
+    parmadj->tailcall = true;
+    int n = beGetIcon(parmadj->dc.right);
+    int dest = usingEsp ? pushlevel + funcstackheight + 4 : 8;
+    for (int i = n - 4; i >= 0; i -= 4)
+    {
+        AMODE* src = beLocalAllocate<AMODE>();
+        src->mode = am_indisp;
+        src->preg = ESP;
+        src->offset = Optimizer::simpleIntNode(Optimizer::se_i, i);
+        src->keepesp = true;
+        AMODE* dst = beLocalAllocate<AMODE>();
+        dst->mode = am_indisp;
+        dst->preg = usingEsp ? ESP : EBP;
+        dst->offset = Optimizer::simpleIntNode(Optimizer::se_i, dest + i);
+        dst->keepesp = true;
+        // pop with an ESP based address uses the value of ESP after the pop
+        gen_codes(op_push, ISZ_UINT, src, 0);
+        gen_codes(op_pop, ISZ_UINT, dst, 0);
+    }
+    if (n)
+        gen_code(op_add, makedreg(ESP), aimmed(n));
+    pushlevel -= n;
+    int height = funcstackheight;
+    asm_epilogue(epilogue);
+    funcstackheight = height;
+    gen_code(op_jmp, target, 0);
+}
 void asm_gosub(Optimizer::QUAD* q) /* normal gosub to an immediate label or through a var */
 {
     Optimizer::SimpleExpression* en = NULL;
@@ -2798,7 +2849,12 @@ void asm_gosub(Optimizer::QUAD* q) /* normal gosub to an immediate label or thro
             en = GetSymRef(q->dc.left->offset3);
         getAmodes(q, &op, q->dc.left, &apl, &aph);
 
-        if (q->dc.left->mode == Optimizer::i_immed)
+        if (q->tailcall && q->dc.left->mode == Optimizer::i_immed && !isintconst(q->dc.left->offset))
+        {
+            apl->length = 0;
+            gen_tailcall(q, apl);
+        }
+        else if (q->dc.left->mode == Optimizer::i_immed)
         {
             if (isintconst(q->dc.left->offset))
             {
@@ -5081,6 +5137,8 @@ void asm_cppini(Optimizer::QUAD* q) /* cplusplus initialization (historic)*/ { (
  */
 void asm_prologue(Optimizer::QUAD* q) /* function prologue */
 {
+    vectorFunc = q;
+    vectorScratch[0] = -1;
     inframe =
         !!(beGetIcon(q->dc.left) & FRAME_FLAG_NEEDS_FRAME) || Optimizer::cparams.prm_debug || Optimizer::cparams.prm_stackalign;
     if (inframe)
@@ -5963,6 +6021,145 @@ void asm_atomic(Optimizer::QUAD* q)
             break;
     }
 }
+/* load a packed operand into an xmm register, either 16 bytes of memory or a value
+ * which gets copied to each element
+ */
+static void vectorOperand(Optimizer::QUAD* q, Optimizer::IMODE* im, AMODE* xmm)
+{
+    enum e_opcode op;
+    AMODE *ap, *aph;
+    int sz = q->ans->size;
+    getAmodes(q, &op, im, &ap, &aph);
+    if (im->mode == Optimizer::i_ind)
+    {
+        if (sz == ISZ_FLOAT)
+            gen_code_sse(op_movups, xmm, ap);
+        else if (sz == ISZ_DOUBLE)
+            gen_code_sse(op_movupd, xmm, ap);
+        else
+            gen_code_sse(op_movdqu, xmm, ap);
+        return;
+    }
+    if (sz >= ISZ_FLOAT)
+    {
+        if (ap->mode == am_immed)
+            make_floatconst(ap, sz);
+        if (ap->mode == am_xmmreg)
+        {
+            if (ap->preg != xmm->preg)
+                gen_code_sse(op_movaps, xmm, ap);
+        }
+        else
+        {
+            gen_code_sse(op_movss, op_movsd, sz, xmm, ap);
+        }
+        if (sz == ISZ_FLOAT)
+            gen_code_sse_imm(op_shufps, op_shufps, sz, xmm, xmm, aimmed(0));
+        else
+            gen_code_sse(op_unpcklpd, xmm, xmm);
+    }
+    else
+    {
+        if (ap->mode == am_immed)
+            ap = make_muldivval(ap);
+        ap->length = ISZ_UINT;
+        gen_code(op_movd, xmm, ap);
+        gen_code_sse_imm(op_pshufd, op_pshufd, sz, xmm, xmm, aimmed(0));
+    }
+}
+static void vectorRegsUsed(Optimizer::QUAD* q, Optimizer::IMODE* im, int& used)
+{
+    if (im && im->mode == Optimizer::i_direct && im->size >= ISZ_FLOAT && im->size <= ISZ_CLDOUBLE &&
+        im->offset->type == Optimizer::se_tempref && !im->offset->right)
+    {
+        int clr = beRegFromTemp(q, im) & 0xff;
+        used |= 1 << Optimizer::chosenAssembler->arch->regMap[clr][0];
+        if (im->size >= ISZ_CFLOAT)
+            used |= 1 << Optimizer::chosenAssembler->arch->regMap[clr][1];
+    }
+}
+/* the packed operations need two xmm registers of their own.  Use two that the register
+ * allocator didn't give to anything in this function, or xmm0 and xmm1 saved on the stack
+ * if it used them all
+ */
+static bool vectorScratchRegs(void)
+{
+    if (vectorScratch[0] < 0)
+    {
+        int used = 0, n = 0;
+        for (Optimizer::QUAD* q = vectorFunc; q && q->dc.opcode != Optimizer::i_epilogue; q = q->fwd)
+        {
+            if (q->temps & TEMP_ANS)
+                vectorRegsUsed(q, q->ans, used);
+            if (q->temps & TEMP_LEFT)
+                vectorRegsUsed(q, q->dc.left, used);
+            if (q->temps & TEMP_RIGHT)
+                vectorRegsUsed(q, q->dc.right, used);
+        }
+        for (int i = 7; i >= 0 && n < 2; i--)
+            if (!(used & (1 << i)))
+                vectorScratch[n++] = i;
+        vectorSave = n < 2;
+        if (vectorSave)
+        {
+            vectorScratch[0] = 0;
+            vectorScratch[1] = 1;
+        }
+    }
+    return vectorSave;
+}
+/* packed operations work on 16 bytes at a time, either four ints or floats or two doubles */
+static void vectorOp(Optimizer::QUAD* q, enum e_opcode opi, enum e_opcode opf, enum e_opcode opd)
+{
+    enum e_opcode op;
+    AMODE *apa, *aph;
+    bool save = vectorScratchRegs();
+    AMODE* x0 = makeSSE(vectorScratch[0]);
+    AMODE* x1 = makeSSE(vectorScratch[1]);
+    int sz = q->ans->size;
+    if (save)
+    {
+        gen_codes(op_sub, ISZ_UINT, makedreg(ESP), aimmed(32));
+        pushlevel += 32;
+        gen_code_sse(op_movdqu, make_stack(0), x0);
+        gen_code_sse(op_movdqu, make_stack(-16), x1);
+    }
+    /* load a broadcast value first, in case it lives in one of the scratch registers */
+    if (q->dc.right && q->dc.right->mode != Optimizer::i_ind)
+    {
+        vectorOperand(q, q->dc.right, x1);
+        vectorOperand(q, q->dc.left, x0);
+    }
+    else
+    {
+        vectorOperand(q, q->dc.left, x0);
+        if (q->dc.right)
+            vectorOperand(q, q->dc.right, x1);
+    }
+    if (q->dc.right)
+        gen_code_sse(sz == ISZ_FLOAT ? opf : sz == ISZ_DOUBLE ? opd : opi, x0, x1);
+    getAmodes(q, &op, q->ans, &apa, &aph);
+    if (sz == ISZ_FLOAT)
+        gen_code_sse(op_movups, apa, x0);
+    else if (sz == ISZ_DOUBLE)
+        gen_code_sse(op_movupd, apa, x0);
+    else
+        gen_code_sse(op_movdqu, apa, x0);
+    if (save)
+    {
+        gen_code_sse(op_movdqu, x0, make_stack(0));
+        gen_code_sse(op_movdqu, x1, make_stack(-16));
+        gen_codes(op_add, ISZ_UINT, makedreg(ESP), aimmed(32));
+        pushlevel -= 32;
+    }
+}
+void asm_vadd(Optimizer::QUAD* q) { vectorOp(q, op_paddd, op_addps, op_addpd); }
+void asm_vsub(Optimizer::QUAD* q) { vectorOp(q, op_psubd, op_subps, op_subpd); }
+void asm_vmul(Optimizer::QUAD* q) { vectorOp(q, op_nop, op_mulps, op_mulpd); }
+void asm_vand(Optimizer::QUAD* q) { vectorOp(q, op_pand, op_andps, op_andpd); }
+void asm_vor(Optimizer::QUAD* q) { vectorOp(q, op_por, op_orps, op_orpd); }
+void asm_veor(Optimizer::QUAD* q) { vectorOp(q, op_pxor, op_xorps, op_xorpd); }
+void asm_vassn(Optimizer::QUAD* q) { vectorOp(q, op_nop, op_nop, op_nop); }
 void asm_expressiontag(Optimizer::QUAD* q) {}
 void asm_seh(Optimizer::QUAD* q) {}
 void asm_tag(Optimizer::QUAD* q) {}
@@ -149,5 +149,12 @@ void asm_atomic(Optimizer::QUAD* q);
 void asm_expressiontag(Optimizer::QUAD* q);
 void asm_seh(Optimizer::QUAD* q);
 void asm_tag(Optimizer::QUAD* q);
+void asm_vadd(Optimizer::QUAD* q);
+void asm_vsub(Optimizer::QUAD* q);
+void asm_vmul(Optimizer::QUAD* q);
+void asm_vand(Optimizer::QUAD* q);
+void asm_vor(Optimizer::QUAD* q);
+void asm_veor(Optimizer::QUAD* q);
+void asm_vassn(Optimizer::QUAD* q);
 
 }  // namespace occx86
\ No newline at end of file
@@ -304,6 +304,13 @@ static void (*oplst[])(Optimizer::QUAD* q) = {
     iop_cpblk,
     iop_initobj,
     iop_sizeof,
+    asm_vadd,
+    asm_vsub,
+    asm_vmul,
+    asm_vand,
+    asm_vor,
+    asm_veor,
+    asm_vassn,
 };
 
 void generate_instructions(Optimizer::QUAD* intermed_head)
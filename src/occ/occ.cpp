@@ -46,6 +46,7 @@
 #include "gen.h"
 #include "outasm.h"
 #include "peep.h"
+#include "peepsched.h"
 #include "outcode.h"
 #include "igen.h"
 #include "ilunstream.h"
@@ -513,6 +514,7 @@ int main(int argc, char* argv[])
                 if (!SaveFile(p.c_str()))
                     Utils::Fatal("Cannot open '%s' for write", Parser::outFile);
             }
+            oa_schedule_stats();
             if (Optimizer::cparams.prm_displaytiming)
             {
                 stopTime = clock();
@@ -141,7 +141,8 @@ static std::shared_ptr<Section> dummySection = std::make_shared<Section>("dummy"
 
 void omfInit(void)
 {
-    memset(sections, 0, sizeof(sections));
+    for (auto& s : sections)
+        s.reset();
     currentSection = nullptr;
     globals.clear();
     locals.clear();
@@ -184,7 +185,8 @@ void outcode_file_init(void)
     lblpubs.clear();
     lblvirt.clear();
     strlabs.clear();
-    memset(sections, 0, sizeof(sections));
+    for (auto& s : sections)
+        s.reset();
     virtuals.clear();
     virtualSyms.clear();
     currentSection = 0;
@@ -206,7 +208,7 @@ void omf_put_extern(Optimizer::SimpleSymbol* sym, int code)
 {
     externs.insert(sym);
     std::string name = sym->outputName;
-    std::shared_ptr<Label> l = std::make_shared<Label>(name, lblExterns.size(), 0);
+    std::shared_ptr<Label> l = AsmArena::Make<Label>(name, lblExterns.size(), 0);
     l->SetExtern(true);
     lblExterns[l->GetName()] = l;
 }
@@ -233,12 +235,18 @@ std::shared_ptr<Label> LookupLabel(const std::string& string)
 }
 void Release()
 {
+    // drop the file's sections and labels so their arena pages can be freed
     lblExterns.clear();
     lblpubs.clear();
     lbllabs.clear();
     lblvirt.clear();
-    sections->reset();
-    sections->reset();
+    labelMap.clear();
+    strlabs.clear();
+    virtuals.clear();
+    virtualSyms.clear();
+    for (auto& s : sections)
+        s.reset();
+    currentSection = nullptr;
 }
 
 ObjSection* LookupSection(std::string& string)
@@ -616,7 +624,7 @@ static std::shared_ptr<Label> GetLabel(int lbl)
         char buf[256];
         sprintf(buf, "L_%d", lbl);
         std::string name = buf;
-        l = std::make_shared<Label>(name, labelMap.size(), currentSection->GetSect());
+        l = AsmArena::Make<Label>(name, labelMap.size(), currentSection->GetSect());
         labelMap[lbl] = l;
         lbllabs[l->GetName()] = l;
     }
@@ -625,34 +633,34 @@ static std::shared_ptr<Label> GetLabel(int lbl)
 void outcode_gen_strlab(Optimizer::SimpleSymbol* sym)
 {
     std::string name = sym->outputName;
-    std::shared_ptr<Label> l = std::make_shared<Label>(name, strlabs.size(), currentSection->GetSect());
+    std::shared_ptr<Label> l = AsmArena::Make<Label>(name, strlabs.size(), currentSection->GetSect());
     strlabs.push_back(l);
-    InsertInstruction(std::make_shared<Instruction>(l));
+    InsertInstruction(AsmArena::Make<Instruction>(l));
     lblpubs[name] = l;
 }
 void InsertLabel(int lbl)
 {
     std::shared_ptr<Label> l = GetLabel(lbl);
     l->SetSect(currentSection->GetSect());
-    std::shared_ptr<Instruction> newIns = std::make_shared<Instruction>(l);
+    std::shared_ptr<Instruction> newIns = AsmArena::Make<Instruction>(l);
     InsertInstruction(newIns);
 }
 
 void emit(void* data, int len)
 {
-    std::shared_ptr<Instruction> newIns = std::make_shared<Instruction>((unsigned char*)data, len, true);
+    std::shared_ptr<Instruction> newIns = AsmArena::Make<Instruction>((unsigned char*)data, len, true);
     InsertInstruction(newIns);
 }
 void emit(void* data, int len, std::shared_ptr<Fixup> fixup, int fixofs)
 {
-    std::shared_ptr<Instruction> newIns = std::make_shared<Instruction>((unsigned char*)data, len, true);
+    std::shared_ptr<Instruction> newIns = AsmArena::Make<Instruction>((unsigned char*)data, len, true);
     newIns->Add(fixup);
     fixup->SetInsOffs(fixofs);
     InsertInstruction(newIns);
 }
 void emit(std::shared_ptr<Label> label)
 {
-    std::shared_ptr<Instruction> newIns = std::make_shared<Instruction>(label);
+    std::shared_ptr<Instruction> newIns = AsmArena::Make<Instruction>(label);
     InsertInstruction(newIns);
 }
 
@@ -661,7 +669,7 @@ void emit(int size)
     // size < 0 = align > 0 = reserve
     if (size > 0)
     {
-        std::shared_ptr<Instruction> newIns = std::make_shared<Instruction>(size, 1);
+        std::shared_ptr<Instruction> newIns = AsmArena::Make<Instruction>(size, 1);
         InsertInstruction(newIns);
     }
     else
@@ -669,7 +677,7 @@ void emit(int size)
         if (size < 0)
         {
             size = -size;
-            std::shared_ptr<Instruction> newIns = std::make_shared<Instruction>(size);
+            std::shared_ptr<Instruction> newIns = AsmArena::Make<Instruction>(size);
             InsertInstruction(newIns);
         }
     }
@@ -684,7 +692,7 @@ std::shared_ptr<Fixup> gen_symbol_fixup(Optimizer::SimpleSymbol* pub, int offset
         std::shared_ptr<AsmExprNode> expr1 = std::make_shared<AsmExprNode>(offset);
         expr = std::make_shared<AsmExprNode>(AsmExprNode::ADD, expr, expr1);
     }
-    std::shared_ptr<Fixup> f = std::make_shared<Fixup>(expr, 4, !!PC, PC ? 4 : 0);
+    std::shared_ptr<Fixup> f = AsmArena::Make<Fixup>(expr, 4, !!PC, PC ? 4 : 0);
     return f;
 }
 std::shared_ptr<Fixup> gen_label_fixup(int lab, int offset, bool PC)
@@ -696,7 +704,7 @@ std::shared_ptr<Fixup> gen_label_fixup(int lab, int offset, bool PC)
         std::shared_ptr<AsmExprNode> expr1 = std::make_shared<AsmExprNode>(offset);
         expr = std::make_shared<AsmExprNode>(AsmExprNode::ADD, expr, expr1);
     }
-    std::shared_ptr<Fixup> f = std::make_shared<Fixup>(expr, 4, !!PC, PC ? 4 : 0);
+    std::shared_ptr<Fixup> f = AsmArena::Make<Fixup>(expr, 4, !!PC, PC ? 4 : 0);
     return f;
 }
 std::shared_ptr<Fixup> gen_threadlocal_fixup(Optimizer::SimpleSymbol* tls, Optimizer::SimpleSymbol* base, int offset)
@@ -709,7 +717,7 @@ std::shared_ptr<Fixup> gen_threadlocal_fixup(Optimizer::SimpleSymbol* tls, Optim
         expr1 = std::make_shared<AsmExprNode>(offset);
         expr = std::make_shared<AsmExprNode>(AsmExprNode::ADD, expr, expr1);
     }
-    std::shared_ptr<Fixup> f = std::make_shared<Fixup>(expr, 4, false);
+    std::shared_ptr<Fixup> f = AsmArena::Make<Fixup>(expr, 4, false);
     return f;
 }
 std::shared_ptr<Fixup> gen_diff_fixup(int lab1, int lab2)
@@ -719,7 +727,7 @@ std::shared_ptr<Fixup> gen_diff_fixup(int lab1, int lab2)
     l = GetLabel(lab2);
     std::shared_ptr<AsmExprNode> expr1 = std::make_shared<AsmExprNode>(l->GetName());
     expr = std::make_shared<AsmExprNode>(AsmExprNode::SUB, expr, expr1);
-    std::shared_ptr<Fixup> f = std::make_shared<Fixup>(expr, 4, false);
+    std::shared_ptr<Fixup> f = AsmArena::Make<Fixup>(expr, 4, false);
     return f;
 }
 void outcode_dump_muldivval(void)
@@ -891,7 +899,7 @@ void outcode_start_virtual_seg(Optimizer::SimpleSymbol* sym, int data)
     Parser::instructionParser->Setup(virtsect.get());
     AsmExpr::SetSection(virtsect);
     std::string name = sym->outputName;
-    std::shared_ptr<Label> l = std::make_shared<Label>(name, lblvirt.size(), virtualSegmentNumber - 1);
+    std::shared_ptr<Label> l = AsmArena::Make<Label>(name, lblvirt.size(), virtualSegmentNumber - 1);
     l->SetOffset(0);
     lblvirt[name] = l;
 }
@@ -905,7 +913,7 @@ void outcode_end_virtual_seg(Optimizer::SimpleSymbol* sym)
 
 /*-------------------------------------------------------------------------*/
 
-void InsertAttrib(ATTRIBDATA* ad) { InsertInstruction(std::make_shared<Instruction>(ad)); }
+void InsertAttrib(ATTRIBDATA* ad) { InsertInstruction(AsmArena::Make<Instruction>(ad)); }
 void InsertLine(Optimizer::LINEDATA* linedata)
 {
     ATTRIBDATA* attrib = Allocate<ATTRIBDATA>();
@@ -966,7 +974,7 @@ void AddFixup(std::shared_ptr<Instruction>& newIns, OCODE* ins, const std::list<
         {
             memcpy(newIns->GetBytes(), &n, 4);
             std::shared_ptr<AsmExprNode> expr = MakeFixup(ins->oper1->offset);
-            std::shared_ptr<Fixup> f = std::make_shared<Fixup>(expr, 4, false);
+            std::shared_ptr<Fixup> f = AsmArena::Make<Fixup>(expr, 4, false);
             newIns->Add(f);
         }
     }
@@ -985,7 +993,7 @@ void AddFixup(std::shared_ptr<Instruction>& newIns, OCODE* ins, const std::list<
                 if (n < 0)
                     n = -n;
                 auto temp = std::make_shared<AsmExprNode>(*(AsmExprNode*)operand->node);
-                std::shared_ptr<Fixup> f = std::make_shared<Fixup>(temp, (operand->size + 7) / 8, operand->relOfs != 0, n, operand->relOfs > 0);
+                std::shared_ptr<Fixup> f = AsmArena::Make<Fixup>(temp, (operand->size + 7) / 8, operand->relOfs != 0, n, operand->relOfs > 0);
                 f->SetInsOffs((operand->pos + 7) / 8);
                 newIns->Add(f);
             }
@@ -1077,13 +1085,13 @@ void outcode_AssembleIns(OCODE* ins)
                 outcode_genbyte(ins->oper1->offset->i);
                 break;
             case op_align: {
-                std::shared_ptr<Instruction> newIns = std::make_shared<Instruction>(ins->oper1->offset->i);
+                std::shared_ptr<Instruction> newIns = AsmArena::Make<Instruction>(ins->oper1->offset->i);
                 InsertInstruction(newIns);
                 break;
             }
             case op_dd: {
                 int i = 0;
-                std::shared_ptr<Instruction> newIns = std::make_shared<Instruction>(&i, 4, true);
+                std::shared_ptr<Instruction> newIns = AsmArena::Make<Instruction>(&i, 4, true);
                 const std::list<Numeric*> operands;
                 AddFixup(newIns, ins, operands);
                 InsertInstruction(newIns);
@@ -32,6 +32,7 @@
 #include "OptUtils.h"
 #include "gen.h"
 #include "peep.h"
+#include "peepsched.h"
 #include "outcode.h"
 #include "outasm.h"
 #include "memory.h"
@@ -378,6 +379,7 @@ void flush_peep(Optimizer::SimpleSymbol* funcsp, Optimizer::QUAD* list)
     (void)list;
     oa_peep(); /* do the peephole optimizations */
     oa_peep();
+    oa_schedule();
     if (peep_head)
         outcode_gen(peep_head);
     if (Optimizer::cparams.prm_asmfile)
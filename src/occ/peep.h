@@ -25,7 +25,7 @@
 
 namespace occx86
 {
-extern OCODE* peep_tail;
+extern OCODE *peep_head, *peep_tail;
 
 void o_peepini(void);
 void oa_adjust_codelab(void* select, int offset);
@@ -0,0 +1,705 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ * 
+ */
+
+#include <cstdio>
+#include <climits>
+#include <cstring>
+#include <vector>
+#include "be.h"
+#include "config.h"
+#include "gen.h"
+#include "occ.h"
+#include "ildata.h"
+#include "OptUtils.h"
+#include "peep.h"
+#include "peepsched.h"
+
+/* instruction scheduling
+ *
+ * this runs on the peep list after the peephole optimizations, right before the
+ * code is assembled.  The list is broken into regions of simple register, memory
+ * and sse instructions; anything else, such as labels, branches, calls, pushes and
+ * pops, string instructions or the x87 stack instructions, ends a region and stays
+ * where it is.  Line numbers and other markers move along with the instruction
+ * following them.
+ *
+ * each region gets a dependence graph over the registers, the flags and memory, and
+ * is list scheduled against a simple model of a modern x86: four instructions issue
+ * per cycle, with two loads, one store and one multiply, and the usual latencies for
+ * loads, multiplies and sse arithmetic.  Instructions on the longest path to the end
+ * of the region go first.  The new order is only used if the model says it finishes
+ * sooner than the original one.
+ *
+ * memory accesses are ordered unless they can be shown to be disjoint: two frame
+ * accesses with known offsets from the same register and stack level, two accesses
+ * to different globals, or a frame access and a global.  Accesses through pointers may touch the frame if the function ever
+ * computes the address of something in it.  Loads through pointers keep their order
+ * with respect to each other so that volatile accesses aren't rearranged.
+ */
+#define SCHED_MAX_REGION 64 /* longest region to schedule */
+#define SCHED_WIDTH 4       /* instructions issued per cycle */
+#define SCHED_LOAD_LATENCY 4
+#define SCHED_FORWARD_LATENCY 5 /* store to load forwarding */
+
+#define SCHED_FLAGS 16 /* bit for the flags in the register masks, below it are the GPRs then the xmm regs */
+
+namespace occx86
+{
+enum e_schedunit
+{
+    su_alu,
+    su_mul,
+    su_div,
+    su_fpadd,
+    su_fpmul,
+    su_load,
+    su_store,
+    su_max
+};
+static const int schedUnits[su_max] = {4, 1, 1, 2, 2, 2, 1};
+
+enum e_schedmem
+{
+    sm_none,
+    sm_frame,
+    sm_global,
+    sm_pointer
+};
+struct SchedAccess
+{
+    e_schedmem kind;
+    int base;                     /* frame register */
+    bool raw;                     /* ESP displacement not adjusted for the stack level */
+    Optimizer::SimpleSymbol* sym; /* global */
+    int label;                    /* global label, if not a symbol */
+    bool known;                   /* offset is known */
+    long long lo, hi;
+};
+struct SchedNode
+{
+    OCODE* first; /* first marker moving with the instruction */
+    OCODE* ins;
+    unsigned read, written;
+    int latency;
+    int unit;
+    bool load, store;
+    SchedAccess mem;
+    std::vector<std::pair<int, int>> succs;
+    int preds;
+    int earliest;
+    int height;
+};
+
+static bool frameEscapes;
+static long long cyclesBefore, cyclesAfter;
+static int regionsScheduled;
+
+static bool SchedMarker(OCODE* ip)
+{
+    switch ((e_op)ip->opcode)
+    {
+        case op_line:
+        case op_blockstart:
+        case op_blockend:
+        case op_varstart:
+        case op_comment:
+            return true;
+        default:
+            return false;
+    }
+}
+static bool SchedPartial(AMODE* ap)
+{
+    int len = ap->length < 0 ? -ap->length : ap->length;
+    return len == ISZ_UCHAR || len == ISZ_BOOLEAN || len == ISZ_USHORT || len == ISZ_WCHAR || len == ISZ_U16;
+}
+static bool SchedOffset(Optimizer::SimpleExpression* exp, int sign, SchedAccess& mem, long long& offset)
+{
+    switch (exp->type)
+    {
+        case Optimizer::se_i:
+        case Optimizer::se_ui:
+            offset += sign * exp->i;
+            return true;
+        case Optimizer::se_add:
+            return SchedOffset(exp->left, sign, mem, offset) && SchedOffset(exp->right, sign, mem, offset);
+        case Optimizer::se_sub:
+            return SchedOffset(exp->left, sign, mem, offset) && SchedOffset(exp->right, -sign, mem, offset);
+        case Optimizer::se_auto:
+            // the same adjustments the assembly output makes
+            if (mem.kind != sm_frame || sign < 0)
+                return false;
+            if (exp->sp->storage_class == Optimizer::scc_parameter)
+            {
+                if (Optimizer::fastcallAlias)
+                    return false;
+                offset += exp->sp->offset + (usingEsp ? 0 : 4);
+                return true;
+            }
+            offset += exp->sp->offset;
+            return exp->sp->offset < 0;
+        case Optimizer::se_global:
+        case Optimizer::se_pc:
+            if (mem.kind != sm_global || sign < 0 || mem.sym || mem.label)
+                return false;
+            mem.sym = exp->sp;
+            return true;
+        case Optimizer::se_labcon:
+            if (mem.kind != sm_global || sign < 0 || mem.sym || mem.label)
+                return false;
+            mem.label = exp->i;
+            return true;
+        default:
+            return false;
+    }
+}
+static int SchedWidth(OCODE* ip, AMODE* ap)
+{
+    switch (ip->opcode)
+    {
+        case op_movss:
+        case op_addss:
+        case op_subss:
+        case op_mulss:
+        case op_divss:
+        case op_sqrtss:
+        case op_comiss:
+        case op_ucomiss:
+        case op_cvtss2sd:
+        case op_cvtss2si:
+        case op_cvttss2si:
+        case op_movd:
+            return 4;
+        case op_movsd:
+        case op_addsd:
+        case op_subsd:
+        case op_mulsd:
+        case op_divsd:
+        case op_sqrtsd:
+        case op_comisd:
+        case op_ucomisd:
+        case op_cvtsd2ss:
+        case op_cvtsd2si:
+        case op_cvttsd2si:
+        case op_movq:
+            return 8;
+        case op_movaps:
+        case op_movups:
+        case op_movapd:
+        case op_movupd:
+        case op_addps:
+        case op_addpd:
+        case op_subps:
+        case op_subpd:
+        case op_mulps:
+        case op_mulpd:
+        case op_andps:
+        case op_andpd:
+        case op_orps:
+        case op_orpd:
+        case op_xorps:
+        case op_xorpd:
+        case op_pxor:
+        case op_pand:
+        case op_por:
+        case op_paddd:
+        case op_psubd:
+            return 16;
+        default: {
+            int n = ap->length ? Optimizer::sizeFromISZ(ap->length) : 0;
+            return n > 0 ? n : 16;
+        }
+    }
+}
+/* registers and memory an operand touches.  Returns false for anything we don't understand */
+static bool SchedOperand(OCODE* ip, AMODE* ap, bool read, bool write, SchedNode& n)
+{
+    switch (ap->mode)
+    {
+        case am_immed:
+            return !write;
+        case am_dreg: {
+            int reg = ap->preg;
+            if (reg < 0 || reg > 7)
+                return false;
+            if (SchedPartial(ap))
+            {
+                if (ap->length == ISZ_UCHAR || ap->length == -ISZ_UCHAR || ap->length == ISZ_BOOLEAN)
+                    reg &= 3;
+                // writing part of a register merges with the rest of it
+                read |= write;
+            }
+            if (reg == ESP && write)
+                return false;
+            if (read)
+                n.read |= 1 << reg;
+            if (write)
+                n.written |= 1 << reg;
+            return true;
+        }
+        case am_xmmreg:
+            if (ap->preg < 0 || ap->preg > 7)
+                return false;
+            if (read)
+                n.read |= 1 << (ap->preg + 8);
+            if (write)
+                n.written |= 1 << (ap->preg + 8);
+            return true;
+        case am_indisp:
+        case am_indispscale:
+        case am_direct: {
+            if (ap->preg > 7 || ap->sreg > 7 || n.mem.kind != sm_none)
+                return false;
+            if (ap->mode != am_direct && ap->preg >= 0)
+                n.read |= 1 << ap->preg;
+            if (ap->mode == am_indispscale && ap->sreg >= 0)
+                n.read |= 1 << ap->sreg;
+            if (ip->opcode == op_lea)
+                return true;
+            n.load |= read;
+            n.store |= write;
+            if (ap->seg)
+                n.mem.kind = sm_pointer;
+            else if (ap->mode == am_direct || (ap->mode == am_indisp && ap->preg < 0))
+                n.mem.kind = sm_global;
+            else if (ap->preg == ESP || (ap->preg == EBP && !usingEsp))
+                n.mem.kind = sm_frame;
+            else
+                n.mem.kind = sm_pointer;
+            n.mem.base = ap->preg;
+            // the backend adds the stack level to ESP displacements when it generates them,
+            // except where it keeps ESP as it is; the two can't be compared
+            n.mem.raw = ap->preg == ESP && (ap->keepesp || !ap->offset);
+            long long offset = 0;
+            n.mem.known = ap->mode != am_indispscale && n.mem.kind != sm_pointer &&
+                          (!ap->offset || SchedOffset(ap->offset, 1, n.mem, offset));
+            if (n.mem.kind == sm_global && !n.mem.sym && !n.mem.label)
+                n.mem.known = false;
+            n.mem.lo = offset;
+            n.mem.hi = offset + SchedWidth(ip, ap);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+/* the timing class and operand usage of an instruction, false if it has to stay where it is */
+static bool SchedClassify(OCODE* ip, SchedNode& n)
+{
+    bool readDest = true, writeDest = true, hasSource = true;
+    n.latency = 1;
+    n.unit = su_alu;
+    if (ip->noopt || !ip->oper1 || ip->oper3)
+        return false;
+    if (ip->back && (ip->back->opcode == op_lock || ip->back->opcode == op_rep || ip->back->opcode == op_repe ||
+                     ip->back->opcode == op_repne || ip->back->opcode == op_repz || ip->back->opcode == op_repnz))
+        return false;
+    switch (ip->opcode)
+    {
+        case op_mov:
+        case op_movzx:
+        case op_movsx:
+        case op_lea:
+            readDest = false;
+            break;
+        case op_add:
+        case op_sub:
+        case op_and:
+        case op_or:
+        case op_xor:
+            n.written |= 1 << SCHED_FLAGS;
+            break;
+        case op_adc:
+        case op_sbb:
+            n.read |= 1 << SCHED_FLAGS;
+            n.written |= 1 << SCHED_FLAGS;
+            break;
+        case op_cmp:
+        case op_test:
+            writeDest = false;
+            n.written |= 1 << SCHED_FLAGS;
+            break;
+        case op_shl:
+        case op_shr:
+        case op_sal:
+        case op_sar:
+        case op_rol:
+        case op_ror:
+            // a shift by zero leaves the flags alone
+            n.read |= 1 << SCHED_FLAGS;
+            n.written |= 1 << SCHED_FLAGS;
+            break;
+        case op_inc:
+        case op_dec:
+        case op_neg:
+            hasSource = false;
+            n.read |= 1 << SCHED_FLAGS;
+            n.written |= 1 << SCHED_FLAGS;
+            break;
+        case op_not:
+            hasSource = false;
+            break;
+        case op_imul:
+            if (!ip->oper2)
+                return false;
+            n.latency = 3;
+            n.unit = su_mul;
+            n.written |= 1 << SCHED_FLAGS;
+            break;
+        case op_movss:
+        case op_movsd:
+        case op_movaps:
+        case op_movups:
+        case op_movapd:
+        case op_movupd:
+        case op_movd:
+        case op_movq:
+            readDest = false;
+            break;
+        case op_cvtsi2ss:
+        case op_cvtsi2sd:
+        case op_cvtss2sd:
+        case op_cvtsd2ss:
+        case op_cvtss2si:
+        case op_cvtsd2si:
+        case op_cvttss2si:
+        case op_cvttsd2si:
+            readDest = false;
+            n.latency = 4;
+            n.unit = su_fpadd;
+            break;
+        case op_addss:
+        case op_addsd:
+        case op_subss:
+        case op_subsd:
+        case op_addps:
+        case op_addpd:
+        case op_subps:
+        case op_subpd:
+            n.latency = 4;
+            n.unit = su_fpadd;
+            break;
+        case op_mulss:
+        case op_mulsd:
+        case op_mulps:
+        case op_mulpd:
+            n.latency = 4;
+            n.unit = su_fpmul;
+            break;
+        case op_divss:
+        case op_sqrtss:
+            n.latency = 11;
+            n.unit = su_div;
+            break;
+        case op_divsd:
+        case op_sqrtsd:
+            n.latency = 14;
+            n.unit = su_div;
+            break;
+        case op_comiss:
+        case op_comisd:
+        case op_ucomiss:
+        case op_ucomisd:
+            writeDest = false;
+            n.written |= 1 << SCHED_FLAGS;
+            n.latency = 3;
+            break;
+        case op_andps:
+        case op_andpd:
+        case op_orps:
+        case op_orpd:
+        case op_xorps:
+        case op_xorpd:
+        case op_pxor:
+        case op_pand:
+        case op_por:
+        case op_paddd:
+        case op_psubd:
+            break;
+        default:
+            if (ip->opcode >= op_seta && ip->opcode <= op_setz && !ip->oper2)
+            {
+                readDest = false;
+                hasSource = false;
+                n.read |= 1 << SCHED_FLAGS;
+                break;
+            }
+            return false;
+    }
+    if (hasSource != !!ip->oper2)
+        return false;
+    if (!SchedOperand(ip, ip->oper1, readDest, writeDest, n))
+        return false;
+    if (hasSource && !SchedOperand(ip, ip->oper2, true, false, n))
+        return false;
+    if (n.load)
+        n.latency += SCHED_LOAD_LATENCY;
+    return true;
+}
+static bool SchedAlias(SchedAccess& a, SchedAccess& b)
+{
+    if (a.kind == sm_pointer || b.kind == sm_pointer)
+        return a.kind != sm_frame && b.kind != sm_frame ? true : frameEscapes;
+    if (a.kind != b.kind)
+        return false;
+    if (!a.known || !b.known)
+        return true;
+    if (a.kind == sm_frame && (a.base != b.base || a.raw != b.raw))
+        return true;
+    if (a.kind == sm_global && (a.sym != b.sym || a.label != b.label))
+        return false;
+    return a.lo < b.hi && b.lo < a.hi;
+}
+static void SchedEdge(std::vector<SchedNode>& nodes, int from, int to, int latency)
+{
+    for (auto& s : nodes[from].succs)
+        if (s.first == to)
+        {
+            if (latency > s.second)
+                s.second = latency;
+            return;
+        }
+    nodes[from].succs.push_back(std::pair<int, int>(to, latency));
+    nodes[to].preds++;
+}
+static void SchedDependencies(std::vector<SchedNode>& nodes)
+{
+    for (int j = 0; j < nodes.size(); j++)
+    {
+        auto& b = nodes[j];
+        for (int i = 0; i < j; i++)
+        {
+            auto& a = nodes[i];
+            if (a.written & b.read)
+                SchedEdge(nodes, i, j, a.latency);
+            if (a.written & b.written)
+                SchedEdge(nodes, i, j, 1);
+            if (a.read & b.written)
+                SchedEdge(nodes, i, j, 0);
+            if ((a.load || a.store) && (b.load || b.store))
+            {
+                if (a.store || b.store)
+                {
+                    if (SchedAlias(a.mem, b.mem))
+                        SchedEdge(nodes, i, j, a.store && b.load ? SCHED_FORWARD_LATENCY : a.store ? 1 : 0);
+                }
+                else if (a.mem.kind != sm_frame && b.mem.kind != sm_frame)
+                {
+                    SchedEdge(nodes, i, j, 0);
+                }
+            }
+        }
+    }
+    for (int i = nodes.size() - 1; i >= 0; i--)
+    {
+        nodes[i].height = nodes[i].latency;
+        for (auto s : nodes[i].succs)
+            if (s.second + nodes[s.first].height > nodes[i].height)
+                nodes[i].height = s.second + nodes[s.first].height;
+    }
+}
+static bool SchedFits(SchedNode& n, int* used)
+{
+    if (used[n.unit] >= schedUnits[n.unit])
+        return false;
+    if (n.load && used[su_load] >= schedUnits[su_load])
+        return false;
+    if (n.store && used[su_store] >= schedUnits[su_store])
+        return false;
+    return true;
+}
+static void SchedIssue(SchedNode& n, int* used)
+{
+    used[n.unit]++;
+    if (n.load)
+        used[su_load]++;
+    if (n.store)
+        used[su_store]++;
+}
+/* cycles the region takes in the original order */
+static int SchedInOrder(std::vector<SchedNode>& nodes)
+{
+    std::vector<int> ready(nodes.size(), 0);
+    int used[su_max] = {}, issued = 0, cycle = 0, length = 0;
+    for (int i = 0; i < nodes.size(); i++)
+    {
+        auto& n = nodes[i];
+        if (ready[i] > cycle || issued >= SCHED_WIDTH || !SchedFits(n, used))
+        {
+            cycle = ready[i] > cycle ? ready[i] : cycle + 1;
+            memset(used, 0, sizeof(used));
+            issued = 0;
+            i--;
+            continue;
+        }
+        SchedIssue(n, used);
+        issued++;
+        for (auto s : n.succs)
+            if (cycle + s.second > ready[s.first])
+                ready[s.first] = cycle + s.second;
+        if (cycle + n.latency > length)
+            length = cycle + n.latency;
+    }
+    return length;
+}
+/* list schedule the region, returns the cycles it takes and the new order */
+static int SchedList(std::vector<SchedNode>& nodes, std::vector<int>& order)
+{
+    std::vector<int> preds(nodes.size());
+    for (int i = 0; i < nodes.size(); i++)
+    {
+        preds[i] = nodes[i].preds;
+        nodes[i].earliest = 0;
+    }
+    int used[su_max] = {}, issued = 0, cycle = 0, length = 0;
+    while (order.size() < nodes.size())
+    {
+        int best = -1;
+        if (issued < SCHED_WIDTH)
+        {
+            for (int i = 0; i < nodes.size(); i++)
+                if (!preds[i] && nodes[i].earliest <= cycle && SchedFits(nodes[i], used) &&
+                    (best < 0 || nodes[i].height > nodes[best].height))
+                    best = i;
+        }
+        if (best < 0)
+        {
+            cycle++;
+            memset(used, 0, sizeof(used));
+            issued = 0;
+            continue;
+        }
+        auto& n = nodes[best];
+        order.push_back(best);
+        preds[best] = -1;
+        SchedIssue(n, used);
+        issued++;
+        for (auto s : n.succs)
+        {
+            preds[s.first]--;
+            if (cycle + s.second > nodes[s.first].earliest)
+                nodes[s.first].earliest = cycle + s.second;
+        }
+        if (cycle + n.latency > length)
+            length = cycle + n.latency;
+    }
+    return length;
+}
+static void SchedRegion(std::vector<SchedNode>& nodes)
+{
+    if (nodes.size() < 2)
+        return;
+    SchedDependencies(nodes);
+    int before = SchedInOrder(nodes);
+    std::vector<int> order;
+    int after = SchedList(nodes, order);
+    cyclesBefore += before;
+    if (after >= before)
+    {
+        cyclesAfter += before;
+        return;
+    }
+    cyclesAfter += after;
+    regionsScheduled++;
+    OCODE* prev = nodes.front().first->back;
+    OCODE* next = nodes.back().ins->fwd;
+    for (auto i : order)
+    {
+        auto& n = nodes[i];
+        n.first->back = prev;
+        if (prev)
+            prev->fwd = n.first;
+        else
+            peep_head = n.first;
+        prev = n.ins;
+    }
+    prev->fwd = next;
+    if (next)
+        next->back = prev;
+    else
+        peep_tail = prev;
+}
+static void SchedFrameEscapes(void)
+{
+    frameEscapes = false;
+    for (OCODE* ip = peep_head; ip && !frameEscapes; ip = ip->fwd)
+    {
+        if (ip->opcode < op_aaa || !ip->oper2)
+            continue;
+        if (ip->opcode == op_lea)
+            frameEscapes = (ip->oper2->mode == am_indisp || ip->oper2->mode == am_indispscale) &&
+                           (ip->oper2->preg == ESP || ip->oper2->preg == EBP);
+        else
+            frameEscapes = ip->oper2->mode == am_dreg && (ip->oper2->preg == ESP || ip->oper2->preg == EBP) &&
+                           !SchedPartial(ip->oper2) && ip->oper1->mode == am_dreg && ip->oper1->preg != ESP;
+    }
+}
+void oa_schedule(void)
+{
+    if (!Optimizer::cparams.prm_bepeep || !Optimizer::cparams.prm_optimize_for_speed || Optimizer::cparams.prm_debug)
+        return;
+    SchedFrameEscapes();
+    std::vector<SchedNode> nodes;
+    OCODE* first = nullptr;
+    for (OCODE* ip = peep_head; ip;)
+    {
+        OCODE* next = ip->fwd;
+        if (SchedMarker(ip))
+        {
+            if (!first)
+                first = ip;
+        }
+        else
+        {
+            SchedNode n = {};
+            if (ip->opcode >= op_aaa && SchedClassify(ip, n))
+            {
+                n.first = first ? first : ip;
+                n.ins = ip;
+                nodes.push_back(n);
+                if (nodes.size() >= SCHED_MAX_REGION)
+                {
+                    SchedRegion(nodes);
+                    nodes.clear();
+                }
+            }
+            else
+            {
+                SchedRegion(nodes);
+                nodes.clear();
+            }
+            first = nullptr;
+        }
+        ip = next;
+    }
+    SchedRegion(nodes);
+}
+void oa_schedule_stats(void)
+{
+    if (Optimizer::cparams.verbosity >= 2 && cyclesBefore)
+        printf("Scheduling: %d regions reordered, estimated cycles %lld -> %lld\n", regionsScheduled, cyclesBefore,
+               cyclesAfter);
+}
+}  // namespace occx86
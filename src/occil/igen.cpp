@@ -88,6 +88,8 @@ static void iop_initblk(Optimizer::QUAD* q) { asm_initblock(q); }
 static void iop_cpblk(Optimizer::QUAD* q) { asm_assnblock(q); }
 static void iop_initobj(Optimizer::QUAD* q) { asm_initobj(q); }
 static void iop_sizeof(Optimizer::QUAD* q) { asm_sizeof(q); }
+/* the packed operations are never generated for msil */
+static void iop_vector(Optimizer::QUAD* q) {}
 /*-------------------------------------------------------------------------*/
 
 static void iop_asmcond(Optimizer::QUAD* q) {}
@@ -298,7 +300,14 @@ static void (*oplst[])(Optimizer::QUAD* q) = {
     iop_initblk,
     iop_cpblk,
     iop_initobj,
-    iop_sizeof};
+    iop_sizeof,
+    iop_vector,
+    iop_vector,
+    iop_vector,
+    iop_vector,
+    iop_vector,
+    iop_vector,
+    iop_vector};
 
 void generate_instructions(Optimizer::QUAD* intermed_head)
 {
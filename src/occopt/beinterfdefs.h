@@ -114,6 +114,8 @@ typedef struct
     bool msilAllowExtensions;    /* occil: allow extensions*/
     bool prm_displaytiming;      /* display timing info */
     bool prm_makelib;            /* make library */
+    bool prm_profilegen;         /* instrument blocks with execution counters */
+    bool prm_profileuse;         /* optimize with execution counts from a profile */
     int  prm_stackprotect;       /* stack protection mode */
     int  prm_netcore_version;    /* .net core version to compile against.   0 = none, NetCore::DummyNeedsLatest = latest*/
 } COMPILER_PARAMS;
@@ -259,6 +261,7 @@ typedef struct
 #define DO_NOMULTOSHIFT 16384
 #define DO_NOALIAS 32768
 #define DO_NOCONST 0x10000
+#define DO_NOVECTOR 0x20000
 
     int erropts; /* error options */
 #define EO_RETURNASERR 1
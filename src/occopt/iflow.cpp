@@ -31,10 +31,12 @@
 /* Define this to get a dump of the flow graph and dominator tree
  * These are dumped into ccfg.$$$
  */
+#include <algorithm>
 #include <cstdio>
 #include <malloc.h>
 #include <cstring>
 #include <unordered_map>
+#include <vector>
 #include "ioptimizer.h"
 #include "beinterfdefs.h"
 #include "iflow.h"
@@ -553,6 +555,11 @@ static int RemoveCriticalEdges(enum e_fgtype type, Block* parent, Block* in)
                     QUAD *quad, *quad2;
 
                     m->block->critical = true;
+                    if (in->profiled && f->block->profiled)
+                    {
+                        m->block->profiled = true;
+                        m->block->execCount = std::min(in->execCount, f->block->execCount);
+                    }
 
                     /* note : the following does NOT insert jmps for the
                      * newly added block
@@ -943,14 +950,10 @@ static void InsertLabel(Block* b, int label)
     head->back = head->back->fwd = lbl;
     lbl->block = b;
 }
-static void MoveBlockTo(Block* b)
+static void EndWithJump(Block* b)
 {
-    Block* prev = b->pred->block;
     Block* succ = b->succ->block;
-    QUAD* head;
-    QUAD* tail = prev->tail;
     QUAD* jmp = Allocate<QUAD>();
-    QUAD* insert = b->tail;
     int label = nextLabel++;
     if (b->tail->dc.opcode == i_blockend)
         RemoveInstruction(b->tail);
@@ -966,20 +969,30 @@ static void MoveBlockTo(Block* b)
     b->tail = jmp;
 
     InsertLabel(succ, label);
-
-    // unlink
+}
+static void DetachBlock(Block* b)
+{
     if (b->head == criticalThunks)
         criticalThunks = b->tail->fwd;
     if (b->head->back)
         b->head->back->fwd = b->tail->fwd;
     if (b->tail->fwd)
         b->tail->fwd->back = b->head->back;
-
-    // relink
-    prev->tail->fwd->back = b->tail;
-    b->tail->fwd = prev->tail->fwd;
-    prev->tail->fwd = b->head;
-    b->head->back = prev->tail;
+}
+static void AttachBlock(Block* b, QUAD* after)
+{
+    if (after->fwd)
+        after->fwd->back = b->tail;
+    b->tail->fwd = after->fwd;
+    after->fwd = b->head;
+    b->head->back = after;
+}
+static void MoveBlockTo(Block* b)
+{
+    Block* prev = b->pred->block;
+    EndWithJump(b);
+    DetachBlock(b);
+    AttachBlock(b, prev->tail);
 }
 static void SwapBranchSense(QUAD* jmp)
 {
@@ -1176,6 +1189,160 @@ void RemoveCriticalThunks(void)
         }
     }
 }
+/* profile driven branch layout
+ *
+ * when the taken side of a conditional branch runs much more often than the side
+ * which falls through, reverse the sense of the branch and move things around so the
+ * frequent side falls through.  Either the block which fell through moves to the end
+ * of the function, or if that won't work the block which was branched to moves up
+ * to follow the branch.
+ */
+static long long EdgeCount(Block* b, Block* s, Block* other)
+{
+    if (s->profiled && !s->pred->next)
+        return s->execCount;
+    if (b->profiled && other->profiled && !other->pred->next && b->execCount >= other->execCount)
+        return b->execCount - other->execCount;
+    return -1;
+}
+static bool FallsInto(Block* b)
+{
+    QUAD* q = b->head->back;
+    while (q && (q->ignoreMe || q->dc.opcode == i_blockend || q->dc.opcode == i_line || q->dc.opcode == i_dbgblock ||
+                 q->dc.opcode == i_dbgblockend || q->dc.opcode == i_label))
+        q = q->back;
+    return !q || (q->dc.opcode != i_goto && q->dc.opcode != i_ret);
+}
+static Block* NextBlock(Block* b)
+{
+    QUAD* q = b->tail->fwd;
+    while (q && (q->ignoreMe || q->dc.opcode == i_blockend))
+        q = q->fwd;
+    return q && q->dc.opcode == i_block ? q->block : nullptr;
+}
+/* debug scopes are lexical, so the scope markers stay where the block was */
+static void LeaveScopeMarkers(Block* b)
+{
+    QUAD* at = b->head->back;
+    QUAD* end = b->tail->fwd;
+    if (at->dc.opcode == i_blockend)
+        at = at->back;
+    for (QUAD* q = b->head->fwd; q != end;)
+    {
+        QUAD* next = q->fwd;
+        if (q->dc.opcode == i_dbgblock || q->dc.opcode == i_dbgblockend)
+        {
+            if (b->tail == q)
+                b->tail = q->back;
+            q->back->fwd = q->fwd;
+            if (q->fwd)
+                q->fwd->back = q->back;
+            q->fwd = at->fwd;
+            q->back = at;
+            at->fwd->back = q;
+            at->fwd = q;
+            q->block = at->block;
+            if (at->block->tail == at)
+                at->block->tail = q;
+            at = q;
+        }
+        q = next;
+    }
+}
+static bool CanMoveBlock(Block* b)
+{
+    if (b == blockArray[0] || b->blocknum == exitBlock || b->head->moveBarrier || b->alwayslive || !b->pred ||
+        b->pred->next || (b->succ && b->succ->next))
+        return false;
+    for (QUAD* q = b->head; q != b->tail->fwd; q = q->fwd)
+    {
+        switch (q->dc.opcode)
+        {
+            case i_prologue:
+            case i_epilogue:
+            case i_ret:
+            case i_functailstart:
+            case i_functailend:
+                return false;
+            default:
+                break;
+        }
+    }
+    return b->succ != nullptr;
+}
+int ArrangeProfiledBranches(void)
+{
+    std::vector<Block*> order;
+    QUAD* last = nullptr;
+    for (QUAD* q = intermed_head; q; q = q->fwd)
+    {
+        switch (q->dc.opcode)
+        {
+            case i_tryblock:
+            case i_seh:
+            case i_beginexcept:
+            case i_endexcept:
+            case i_computedgoto:
+            case i_asmgoto:
+            case i_asmcond:
+                return 0;
+            case i_block:
+                if (q->block && !q->block->dead)
+                    order.push_back(q->block);
+                break;
+            default:
+                break;
+        }
+        last = q;
+    }
+    int rv = 0;
+    for (auto b : order)
+    {
+        QUAD* bjmp = beforeJmp(b->tail, false);
+        if (bjmp->dc.opcode < i_jne || bjmp->dc.opcode > i_jge || !b->succ || !b->succ->next || b->succ->next->next ||
+            (bjmp->dc.left && bjmp->dc.left->size >= ISZ_FLOAT))
+            continue;
+        Block* f = b->succ->block;
+        Block* t = b->succ->next->block;
+        if (f == t || f->dead || t->dead)
+            continue;
+        long long taken = EdgeCount(b, t, f);
+        long long fallthrough = EdgeCount(b, f, t);
+        if (taken < 0 || fallthrough < 0 || taken <= 2 * fallthrough)
+            continue;
+        if (NextBlock(b) == f && NextBlock(f) == t && CanMoveBlock(f))
+        {
+            int lbl = nextLabel++;
+            InsertLabel(f, lbl);
+            bjmp->dc.v.label = lbl;
+            SwapBranchSense(bjmp);
+            if (beforeJmp(f->tail, false)->dc.opcode != i_goto)
+                EndWithJump(f);
+            LeaveScopeMarkers(f);
+            DetachBlock(f);
+            AttachBlock(f, last);
+            last = f->tail;
+            intermed_tail = last;
+            rv++;
+        }
+        else if (t->pred && !t->pred->next && !FallsInto(t) && CanMoveBlock(t) &&
+                 beforeJmp(t->tail, false)->dc.opcode == i_goto)
+        {
+            int lbl = nextLabel++;
+            InsertLabel(f, lbl);
+            bjmp->dc.v.label = lbl;
+            SwapBranchSense(bjmp);
+            LeaveScopeMarkers(t);
+            if (t->tail == last)
+                last = t->head->back;
+            DetachBlock(t);
+            AttachBlock(t, b->tail);
+            intermed_tail = last;
+            rv++;
+        }
+    }
+    return rv;
+}
 void unlinkBlock(Block* succ, Block* pred)
 {
     BLOCKLIST** bl = &succ->pred;
@@ -1224,7 +1391,7 @@ void doms_only(bool always)
         *criticalThunkPtr = Allocate<QUAD>();
         (*criticalThunkPtr)->dc.opcode = i_label;
         (*criticalThunkPtr)->dc.v.label = -1;
-        criticalThunkPtr = (QUAD**)*criticalThunkPtr;
+        criticalThunkPtr = &(*criticalThunkPtr)->fwd;
     }
     CancelInfinite(blockCount);
 
@@ -37,6 +37,7 @@ bool dominatedby(Block* src, Block* ancestor);
 enum e_fgtype getEdgeType(int first, int second);
 void UnlinkCritical(Block* s);
 void RemoveCriticalThunks(void);
+int ArrangeProfiledBranches(void);
 void unlinkBlock(Block* succ, Block* pred);
 void doms_only(bool always);
 void flows_and_doms(void);
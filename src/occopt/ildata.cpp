@@ -79,6 +79,7 @@ std::map<std::string, std::string> bePragma;
 std::list<MsilProperty> msilProperties;
 std::string prm_OutputDefFile;
 std::string prm_OutputImportLibraryFile;
+std::string prm_profileFile = "occ.prof";
 std::string prm_assemblerSpecifier;
 std::string outputFileName;
 std::string assemblerFileExtension;
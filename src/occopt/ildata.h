@@ -219,6 +219,7 @@ extern std::map<std::string, std::string> bePragma;
 extern std::list<MsilProperty> msilProperties;
 extern std::string prm_OutputDefFile;
 extern std::string prm_OutputImportLibraryFile;
+extern std::string prm_profileFile;
 
 extern std::string prm_assemblerSpecifier;
 extern std::string outputFileName;
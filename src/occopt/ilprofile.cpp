@@ -0,0 +1,136 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ * 
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ioptimizer.h"
+#include "beinterfdefs.h"
+#include "ildata.h"
+#include "ilprofile.h"
+#include "Utils.h"
+
+/* profile data
+ *
+ * a program built with -fprofile-generate counts how many times each block of each
+ * function runs, and when it exits adds the counts to those already in a text file,
+ * so that the profile covers every run of the program.  Each function is one entry
+ * in the file:
+ *
+ *     name count c0 c1 ... c(count-1)
+ *
+ * the name is the output name of the function, with '@' and the full path of the
+ * source file appended for static functions so that files with the same name in
+ * different directories don't share counts.  The counts are indexed by block number, and
+ * block 0 is the function entry so c0 is the number of calls.  A word starting with
+ * '#' comments out the rest of the line, and a profile can also be written by hand.
+ *
+ * with -fprofile-use the parser looks at the call counts when deciding what to inline,
+ * and the optimizer puts the block counts on the flow graph.
+ */
+
+namespace Optimizer
+{
+static std::unordered_map<std::string, std::vector<unsigned long long>> profileCounts;
+static std::string profileModule;
+static unsigned long long profileHottest;
+static bool profileLoaded;
+
+static void ProfileLoad()
+{
+    profileLoaded = true;
+    FILE* fil = fopen(prm_profileFile.c_str(), "r");
+    if (!fil)
+        return;
+    char name[4096];
+    while (fscanf(fil, "%4095s", name) == 1)
+    {
+        if (name[0] == '#')
+        {
+            int ch;
+            while ((ch = fgetc(fil)) != EOF && ch != '\n')
+                ;
+            continue;
+        }
+        unsigned count;
+        if (fscanf(fil, "%u", &count) != 1)
+            break;
+        std::vector<unsigned long long> counts(count);
+        unsigned i;
+        for (i = 0; i < count; i++)
+            if (fscanf(fil, "%llu", &counts[i]) != 1)
+                break;
+        if (i < count)
+            break;
+        if (count && counts[0] > profileHottest)
+            profileHottest = counts[0];
+        profileCounts[name] = std::move(counts);
+    }
+    fclose(fil);
+}
+void ProfileModule(const char* fileName)
+{
+    profileModule = Utils::AbsolutePath(fileName);
+    /* a blank would end the name in the profile */
+    for (auto& ch : profileModule)
+        if (isspace((unsigned char)ch))
+            ch = '?';
+}
+std::string ProfileKey(const char* name, bool isStatic)
+{
+    std::string rv = name;
+    if (isStatic)
+        rv += "@" + profileModule;
+    return rv;
+}
+const std::vector<unsigned long long>* ProfileCounts(const std::string& key)
+{
+    if (!cparams.prm_profileuse)
+        return nullptr;
+    if (!profileLoaded)
+        ProfileLoad();
+    auto it = profileCounts.find(key);
+    if (it == profileCounts.end() || it->second.empty())
+        return nullptr;
+    return &it->second;
+}
+/* a function is hot when it is called at least a sixteenth as often as the most
+ * frequently called function in the profile
+ */
+e_heat ProfileHeat(const char* name, bool isStatic)
+{
+    auto counts = ProfileCounts(ProfileKey(name, isStatic));
+    if (!counts)
+        return heat_unknown;
+    unsigned long long calls = (*counts)[0];
+    if (!calls)
+        return heat_cold;
+    if (calls >= profileHottest / 16)
+        return heat_hot;
+    return heat_warm;
+}
+}  // namespace Optimizer
@@ -38,6 +38,8 @@
 #include <unordered_map>
 #include <map>
 #include <set>
+#include <vector>
+#include <algorithm>
 #include "ildata.h"
 namespace Optimizer
 {
@@ -51,7 +53,8 @@ static std::unordered_map<std::string, int> cachedText2;
 static size_t textOffset;
 static std::map<IMODE*, int> cachedImodes;
 static std::set<SimpleSymbol*> cachedAutos;
-static std::set<SimpleSymbol*> cachedTemps;
+// by temp number, so that the temps go out in the same order wherever they were allocated
+static std::map<int, SimpleSymbol*> cachedTemps;
 
 static SharedMemory* sharedRegion;
 // the next are intended not to be reset on each read, as there will be another file streamed next
@@ -635,6 +638,7 @@ static void StreamXParams()
     StreamString(prm_assemblyVersion);
     StreamString(prm_namespace_and_class);
     StreamString(specifiedLibs);
+    StreamString(prm_profileFile);
     StreamStringList(inputFiles);
     StreamStringList(backendFiles);
     StreamStringList(libIncludes);
@@ -728,7 +732,7 @@ static void CacheOffset(FunctionData* fd, SimpleExpression* offset)
         }
         else if (offset->type == Optimizer::se_tempref)
         {
-            cachedTemps.insert(offset->sp);
+            cachedTemps.emplace(offset->sp->i, offset->sp);
         }
         else
         {
@@ -765,14 +769,15 @@ static void StreamIModes(FunctionData* fd)
 static void StreamTemps()
 {
     int count = 0;
-    for (auto t : cachedTemps)
+    for (auto&& t : cachedTemps)
     {
-        if (t->loadTemp | t->pushedtotemp)
+        if (t.second->loadTemp | t.second->pushedtotemp)
             count++;
     }
     StreamIndex(count);
-    for (auto t : cachedTemps)
+    for (auto&& v : cachedTemps)
     {
+        auto t = v.second;
         if (t->loadTemp | t->pushedtotemp)
         {
             StreamIndex(t->i);
@@ -786,13 +791,18 @@ static void StreamTemps()
         }
     }
 }
-static void StreamLoadCache(std::map<IMODE*, IMODE*> hash)
+static void StreamLoadCache(std::map<IMODE*, IMODE*>& hash)
 {
-    StreamIndex(hash.size());
-    for (auto v : hash)
+    // the map is ordered by address, so put the entries in the order of the imode list instead
+    std::vector<std::pair<int, int>> entries;
+    for (auto&& v : hash)
+        entries.push_back({cachedImodes[v.first], cachedImodes[v.second]});  // the second is a tempreg
+    std::sort(entries.begin(), entries.end());
+    StreamIndex(entries.size());
+    for (auto&& v : entries)
     {
-        StreamIndex(cachedImodes[v.first]);
-        StreamIndex(cachedImodes[v.second]);  // a tempreg number
+        StreamIndex(v.first);
+        StreamIndex(v.second);
     }
 }
 static void StreamFunc(FunctionData* fd)
@@ -612,6 +612,7 @@ static void UnstreamXParams()
     UnstreamString(prm_assemblyVersion);
     UnstreamString(prm_namespace_and_class);
     UnstreamString(specifiedLibs);
+    UnstreamString(prm_profileFile);
     UnstreamStringList(inputFiles);
     UnstreamStringList(backendFiles);
     UnstreamStringList(libIncludes);
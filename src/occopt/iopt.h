@@ -347,6 +347,7 @@ struct Block
     int onstack : 1;
     int globalChanged : 1;
     int alwayslive : 1;
+    int profiled : 1; /* execCount came from a profile */
     short callcount;
     short preWalk;
     short postWalk;
@@ -357,6 +358,7 @@ struct Block
     int reversePostOrder;
     int spillCost;
     int nesting;
+    unsigned long long execCount;
     struct _blocklist* dominates;
     struct _blocklist* dominanceFrontier;
     struct _blocklist *pred, *succ;
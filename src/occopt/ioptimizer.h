@@ -437,6 +437,8 @@ struct ArgList
         i_gcsestub, i_expressiontag, i_tag, i_seh,
         /* msil */
         i__initblk, i__cpblk, i__initobj, i__sizeof,
+        /* packed operations on 16 bytes of memory */
+        i_vadd, i_vsub, i_vmul, i_vand, i_vor, i_veor, i_vassn,
         /* Dag- specific stuff */
         i_var, i_const, i_ptr, i_labcon,
         /* end marker */
@@ -598,6 +600,7 @@ typedef struct quad
             int ptrbox : 1;          // msil - box this pointer
             int runtimeIsStore : 1;
             int moveBarrier : 1;     /* can't move instructions past this point, e.g. for computed goto/label */
+            int tailcall : 1;        /* call can be replaced by a jump to the callee */
         };
         unsigned flags;
     };
@@ -405,6 +405,13 @@ static void iop_sizeof(Optimizer::QUAD* q)
     oprintf(icdFile, " = SIZEOF ");
     putamode(q, q->dc.left);
 }
+static void iop_vadd(Optimizer::QUAD* q) { putbin(q, "V+"); }
+static void iop_vsub(Optimizer::QUAD* q) { putbin(q, "V-"); }
+static void iop_vmul(Optimizer::QUAD* q) { putbin(q, "V*"); }
+static void iop_vand(Optimizer::QUAD* q) { putbin(q, "V&"); }
+static void iop_vor(Optimizer::QUAD* q) { putbin(q, "V|"); }
+static void iop_veor(Optimizer::QUAD* q) { putbin(q, "V^"); }
+static void iop_vassn(Optimizer::QUAD* q) { putunary(q, "V"); }
 /*-------------------------------------------------------------------------*/
 
 static void iop_asmcond(Optimizer::QUAD* q) { oprintf(icdFile, "\tASMCOND\tL_%d:PC", q->dc.v.label); }
@@ -874,7 +881,14 @@ static void (*oplst[])(Optimizer::QUAD* q) = {
     iop_initblk,
     iop_cpblk,
     iop_initobj,
-    iop_sizeof};
+    iop_sizeof,
+    iop_vadd,
+    iop_vsub,
+    iop_vmul,
+    iop_vand,
+    iop_vor,
+    iop_veor,
+    iop_vassn};
 /*-------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------*/
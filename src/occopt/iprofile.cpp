@@ -0,0 +1,255 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ioptimizer.h"
+#include "beinterfdefs.h"
+#include "iprofile.h"
+#include "ilprofile.h"
+#include "iblock.h"
+#include "iflow.h"
+#include "ildata.h"
+#include "optmain.h"
+#include "OptUtils.h"
+#include "rewritex86.h"
+#include "memory.h"
+
+/* profile guided optimization
+ *
+ * with -fprofile-generate every block of a function gets an instruction sequence
+ * which increments a counter for the block.  This happens right after the flow graph
+ * is first built, before any optimization changes the blocks, so that a later build
+ * with the same options and -fprofile-use numbers the blocks the same way and can
+ * put the counts back on them.  The counters for a function live in a table in the
+ * data segment:
+ *
+ *     next, name, file, count, counts[count]
+ *
+ * the first time the function runs it passes the table to __profile_register in the
+ * run time library, which links it into a list that is written to the profile file
+ * when the program exits.  The entry block only holds the prologue, so the entry
+ * count and the registration go at the top of the block after it.  That also keeps
+ * them after the loads of fastcall parameters, which get put there later.
+ *
+ * with -fprofile-use the counts go on the blocks; if the function changed since the
+ * profile was taken, which we know because the number of blocks is different, the
+ * profile is ignored for the function.  Edge counts aren't recorded; where they are
+ * needed they are derived from the counts of blocks with one predecessor.
+ */
+namespace Optimizer
+{
+struct ProfileTable
+{
+    int label;
+    std::string name;
+    int count;
+};
+static std::vector<ProfileTable> profileTables;
+static bool functionProfiled;
+static int profileInstrumented, profileAnnotated, profileMismatched, profileBranches;
+
+static bool ProfileEligible(void)
+{
+    return architecture == ARCHITECTURE_X86 && !functionHasAssembly && !currentFunction->anyTry && blockCount > 2 &&
+           blockArray[0] && blockArray[1] && blockArray[0]->succ && !blockArray[0]->succ->next &&
+           blockArray[0]->succ->block == blockArray[1] && blockArray[1]->pred && !blockArray[1]->pred->next;
+}
+static bool ProfileBlock(Block* b)
+{
+    return b && !b->dead && !b->critical && !b->unuseThunk && b->blocknum != 0 && b->blocknum != exitBlock;
+}
+static IMODE* ProfileLabel(int label)
+{
+    IMODE* rv = Allocate<IMODE>();
+    rv->mode = i_immed;
+    rv->size = ISZ_ADDR;
+    rv->offset = Allocate<SimpleExpression>();
+    rv->offset->type = se_labcon;
+    rv->offset->i = label;
+    return rv;
+}
+/* the instructions are linked in by hand because there is no temp info yet; they
+ * go after the labels of the block, just as the parser would have generated them
+ */
+static QUAD* ProfileInsert(QUAD* at, enum i_ops op, IMODE* ans, IMODE* left, IMODE* right)
+{
+    QUAD* q = Allocate<QUAD>();
+    q->dc.opcode = op;
+    q->ans = ans;
+    q->dc.left = left;
+    q->dc.right = right;
+    q->block = at->block;
+    q->fwd = at->fwd;
+    q->back = at;
+    if (at->fwd)
+        at->fwd->back = q;
+    at->fwd = q;
+    if (at->block->tail == at)
+        at->block->tail = q;
+    return q;
+}
+static QUAD* ProfileIncrement(QUAD* at, int label, int offset)
+{
+    IMODE* addr = tempreg(ISZ_ADDR, 0);
+    IMODE* ind = Allocate<IMODE>();
+    ind->mode = i_ind;
+    ind->offset = addr->offset;
+    ind->ptrsize = ISZ_ADDR;
+    ind->size = ISZ_ULONGLONG;
+    IMODELIST* iml = Allocate<IMODELIST>();
+    iml->im = ind;
+    iml->next = addr->offset->sp->imind;
+    addr->offset->sp->imind = iml;
+    IMODE* value = tempreg(ISZ_ULONGLONG, 0);
+    IMODE* sum = tempreg(ISZ_ULONGLONG, 0);
+    at = ProfileInsert(at, i_add, addr, ProfileLabel(label), make_immed(ISZ_ADDR, offset));
+    at = ProfileInsert(at, i_assn, value, ind, nullptr);
+    at = ProfileInsert(at, i_add, sum, value, make_immed(ISZ_ULONGLONG, 1));
+    return ProfileInsert(at, i_assn, ind, sum, nullptr);
+}
+static QUAD* ProfileStart(Block* b)
+{
+    QUAD* q = b->head;
+    while (q != b->tail && (q->fwd->dc.opcode == i_label || q->fwd->dc.opcode == i_line))
+        q = q->fwd;
+    return q;
+}
+/* the counters are long long so that a long run doesn't wrap them, and they start on
+ * a boundary of their own size just as they do in the structure the run time library
+ * declares for the table
+ */
+static int ProfileHeader(void)
+{
+    int counterSize = sizeFromISZ(ISZ_ULONGLONG);
+    int header = 3 * sizeFromISZ(ISZ_ADDR) + sizeFromISZ(ISZ_UINT);
+    return (header + counterSize - 1) / counterSize * counterSize;
+}
+static void ProfileInstrument(void)
+{
+    int ptrSize = sizeFromISZ(ISZ_ADDR);
+    int counterSize = sizeFromISZ(ISZ_ULONGLONG);
+    int header = ProfileHeader();
+    int label = nextLabel++;
+    for (int i = 1; i < blockCount; i++)
+    {
+        Block* b = blockArray[i];
+        if (ProfileBlock(b))
+        {
+            QUAD* q = ProfileIncrement(ProfileStart(b), label, header + i * counterSize);
+            if (b == blockArray[1])
+            {
+                q = ProfileIncrement(q, label, header);
+                q = ProfileInsert(q, i_parm, nullptr, ProfileLabel(label), nullptr);
+                q = ProfileInsert(q, i_gosub, nullptr, rwSetSymbol("___profile_register", true), nullptr);
+                ProfileInsert(q, i_parmadj, nullptr, make_parmadj(ptrSize), make_parmadj(ptrSize));
+            }
+        }
+    }
+    profileTables.push_back({label, ProfileKey(currentFunction->outputName, currentFunction->storage_class == scc_static),
+                             blockCount});
+    profileInstrumented++;
+}
+static void ProfileAnnotate(void)
+{
+    auto counts = ProfileCounts(ProfileKey(currentFunction->outputName, currentFunction->storage_class == scc_static));
+    if (!counts)
+        return;
+    if (counts->size() != blockCount)
+    {
+        profileMismatched++;
+        return;
+    }
+    for (int i = 0; i < blockCount; i++)
+    {
+        Block* b = blockArray[i];
+        if (b && !b->dead && !b->critical && !b->unuseThunk)
+        {
+            b->profiled = true;
+            b->execCount = b->blocknum == exitBlock ? (*counts)[0] : (*counts)[i];
+        }
+    }
+    functionProfiled = true;
+    profileAnnotated++;
+}
+void ProfileFunction(void)
+{
+    functionProfiled = false;
+    if (!ProfileEligible())
+        return;
+    if (cparams.prm_profilegen)
+        ProfileInstrument();
+    else if (cparams.prm_profileuse)
+        ProfileAnnotate();
+}
+void ProfileLayout(void)
+{
+    if (functionProfiled)
+        profileBranches += ArrangeProfiledBranches();
+}
+void ProfileData(void)
+{
+    if (profileTables.empty())
+        return;
+    dseg();
+    int file = nextLabel++;
+    put_label(file);
+    putstring(prm_profileFile.c_str(), prm_profileFile.size());
+    genbyte(0);
+    std::vector<int> names;
+    for (auto&& t : profileTables)
+    {
+        names.push_back(nextLabel);
+        put_label(nextLabel++);
+        putstring(t.name.c_str(), t.name.size());
+        genbyte(0);
+    }
+    int pad = ProfileHeader() - 3 * sizeFromISZ(ISZ_ADDR) - sizeFromISZ(ISZ_UINT);
+    for (size_t i = 0; i < profileTables.size(); i++)
+    {
+        align(sizeFromISZ(ISZ_ULONGLONG));
+        put_label(profileTables[i].label);
+        genaddress(0);
+        gen_labref(names[i]);
+        gen_labref(file);
+        genint(profileTables[i].count);
+        if (pad)
+            genstorage(pad);
+        genstorage(profileTables[i].count * sizeFromISZ(ISZ_ULONGLONG));
+    }
+    profileTables.clear();
+}
+void ProfileStats(void)
+{
+    if (cparams.verbosity >= 2)
+    {
+        if (cparams.prm_profilegen)
+            printf("Profile: %d functions instrumented\n", profileInstrumented);
+        else if (cparams.prm_profileuse)
+            printf("Profile: %d functions profiled, %d did not match the profile, %d branches rearranged\n",
+                   profileAnnotated, profileMismatched, profileBranches);
+    }
+}
+}  // namespace Optimizer
@@ -23,6 +23,7 @@
  * 
  */
 
+#include <algorithm>
 #include <cstdio>
 #include <malloc.h>
 #include <cstring>
@@ -2223,12 +2224,22 @@ static int LoopNesting(Loop* loop)
     }
     return rv;
 }
+/* with a profile, a block costs ten times the number of times it runs per call
+ * to the function, which is about what the loop nesting would guess for it
+ */
 static void CalculateNesting(void)
 {
     int i;
+    unsigned long long entry = blockArray[0]->profiled ? blockArray[0]->execCount : 0;
     for (i = 0; i < blockCount; i++)
         if (blockArray[i])
-            blockArray[i]->spillCost = LoopNesting(blockArray[i]->loopParent);
+        {
+            if (entry && blockArray[i]->profiled)
+                blockArray[i]->spillCost =
+                    std::max(1ULL, std::min(1000000ULL, blockArray[i]->execCount * 10ULL / entry));
+            else
+                blockArray[i]->spillCost = LoopNesting(blockArray[i]->loopParent);
+        }
 }
 void Precolor(bool optimized)
 {
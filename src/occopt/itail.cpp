@@ -0,0 +1,223 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ * 
+ */
+
+#include <climits>
+#include <unordered_map>
+#include "ioptimizer.h"
+#include "beinterfdefs.h"
+#include "ildata.h"
+#include "itail.h"
+#include "iblock.h"
+#include "config.h"
+#include "optmain.h"
+#include "optmodules.h"
+
+/* tail and sibling calls
+ *
+ * this runs after the prologue and epilogue are filled in and any stack checking
+ * code has been added, so the code following a call is what will really be generated.
+ * A call is marked as a tail call when nothing but register moves of the return value,
+ * the stack adjustment for the call, and jumps and labels separate it from the epilogue
+ * and return of the function.  The backend then copies the arguments it pushed over
+ * the incoming arguments of the function, tears the frame down and jumps to the callee,
+ * which returns directly to our caller.
+ *
+ * that only works if the callee leaves the stack the way our caller expects it:
+ *
+ *     caller pops arguments (cdecl) -> we must not pop any either
+ *     callee pops arguments (stdcall) -> it must pop as many bytes as we would
+ *
+ * and the arguments must fit in the space our own arguments take.  Calls which pass
+ * arguments in the fastcall registers are left alone, since tearing the frame down
+ * may pop over them.  So are functions which might have let the address of something
+ * in their frame escape, or which need the frame to unwind exceptions or longjmp.
+ *
+ * the backend follows the same path from the call to the return to find the stack
+ * adjustment and the epilogue it has to generate in place of the call.
+ */
+#define TAIL_MAX_WALK 64 /* max instructions between the call and the return */
+
+namespace Optimizer
+{
+static std::unordered_map<int, QUAD*> tailLabels;
+
+static bool TailFrameEscapes(void)
+{
+    for (QUAD* q = intermed_head; q; q = q->fwd)
+    {
+        IMODE* ims[3] = {q->ans, q->dc.left, q->dc.right};
+        for (auto im : ims)
+            if (im && im->mode == i_immed && im->offset && im->offset->type == se_auto)
+                return true;
+    }
+    for (auto sym : functionVariables)
+        if ((sym->storage_class == scc_auto || sym->storage_class == scc_parameter) && sym->addressTaken)
+            return true;
+    return false;
+}
+static int TailParamSize(QUAD* ret)
+{
+    // callee pops its arguments, the size is right there
+    if (ret->dc.left && ret->dc.left->offset->i)
+        return ret->dc.left->offset->i;
+    int lo = INT_MAX, hi = INT_MIN;
+    for (auto sym : functionVariables)
+        if (sym->storage_class == scc_parameter)
+        {
+            if (sym->offset < lo)
+                lo = sym->offset;
+            if (sym->offset + ((sym->size + 3) & ~3) > hi)
+                hi = sym->offset + ((sym->size + 3) & ~3);
+        }
+    return lo < hi ? hi - lo : 0;
+}
+static bool TailIsRegister(IMODE* im)
+{
+    return im->mode == i_direct && im->offset->type == se_tempref && im->size < ISZ_FLOAT && im->size > -ISZ_FLOAT;
+}
+void TailLabels(QUAD* head)
+{
+    tailLabels.clear();
+    for (QUAD* q = head; q; q = q->fwd)
+        if (q->dc.opcode == i_label)
+            tailLabels[q->dc.v.label] = q;
+}
+/* follows the code after a call to the return, fills in the stack adjustment for the
+ * call, the epilogue and the return.  Returns false if anything else would be generated
+ * along the way.  Gotos are looked up in the labels collected by TailLabels
+ */
+bool TailFollow(QUAD* gosub, QUAD** parmadj, QUAD** epilogue, QUAD** ret)
+{
+    IMODE* value = nullptr;
+    *parmadj = *epilogue = *ret = nullptr;
+    int n = 0;
+    for (QUAD* q = gosub->fwd; q && n < TAIL_MAX_WALK; q = q->fwd, n++)
+    {
+        switch (q->dc.opcode)
+        {
+            case i_line:
+            case i_label:
+            case i_block:
+            case i_blockend:
+            case i_dbgblock:
+            case i_dbgblockend:
+            case i_varstart:
+            case i_expressiontag:
+            case i_tag:
+            case i_nop:
+                break;
+            case i_parmadj:
+                if (*parmadj || *epilogue)
+                    return false;
+                *parmadj = q;
+                break;
+            case i_assn:
+                // moving the return value around, in the same register
+                if (*epilogue || !TailIsRegister(q->ans) || !TailIsRegister(q->dc.left) || q->ans->size != q->dc.left->size ||
+                    q->ansColor < 0 || q->ansColor != q->leftColor)
+                    return false;
+                if (!q->dc.left->retval && (!value || q->dc.left->offset->sp != value->offset->sp))
+                    return false;
+                value = q->ans;
+                break;
+            case i_goto: {
+                auto it = tailLabels.find(q->dc.v.label);
+                if (it == tailLabels.end())
+                    return false;
+                q = it->second;
+                break;
+            }
+            case i_epilogue:
+                if (*epilogue || !*parmadj)
+                    return false;
+                *epilogue = q;
+                break;
+            case i_ret:
+                if (!*epilogue)
+                    return false;
+                *ret = q;
+                return true;
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+static bool TailCompatible(QUAD* gosub, QUAD* parmadj, QUAD* ret)
+{
+    if (gosub->dc.left->mode != i_immed || isintconst(gosub->dc.left->offset) || gosub->fastcall)
+        return false;
+    // a floating point value left on the FPU stack would have been popped after the call
+    if (gosub->novalue >= ISZ_FLOAT)
+        return false;
+    // registers saved around the call
+    if (parmadj->dc.v.i & 0x30b)
+        return false;
+    int pushed = parmadj->dc.right->offset->i;
+    int popped = parmadj->dc.left->offset->i;
+    int retpop = ret->dc.left ? ret->dc.left->offset->i : 0;
+    if (pushed & 3)
+        return false;
+    if (popped == pushed)
+    {
+        if (retpop)
+            return false;
+    }
+    else if (popped != 0 || pushed != retpop)
+    {
+        return false;
+    }
+    if (pushed > TailParamSize(ret))
+        return false;
+    // copying the arguments takes more code than the call did
+    if (pushed && !cparams.prm_optimize_for_speed)
+        return false;
+    // arguments in fastcall registers would be clobbered tearing the frame down
+    for (QUAD* q = gosub->back; q && q->dc.opcode != i_gosub && q->dc.opcode != i_block; q = q->back)
+        if (q->fastcall > 0)
+            return false;
+    return true;
+}
+void MarkTailCalls(FunctionData* fd)
+{
+    if (!(cparams.prm_optimize_for_speed || cparams.prm_optimize_for_size) || !(cparams.optimizer_modules & OPT_TAILCALL) ||
+        cparams.prm_debug || cparams.prm_stackprotect || (chosenAssembler->arch->denyopts & DO_NOREGALLOC))
+        return;
+    if (functionHasAssembly || fd->setjmp_used || currentFunction->anyTry || currentFunction->xc ||
+        currentFunction->allocaUsed || currentFunction->ellipsePos || currentFunction->ispascal)
+        return;
+    if (!TailFrameEscapes())
+    {
+        TailLabels(intermed_head);
+        for (QUAD* q = intermed_head; q; q = q->fwd)
+        {
+            QUAD *parmadj, *epilogue, *ret;
+            if (q->dc.opcode == i_gosub && TailFollow(q, &parmadj, &epilogue, &ret) && TailCompatible(q, parmadj, ret))
+                q->tailcall = true;
+        }
+    }
+    tailLabels.clear();
+}
+}  // namespace Optimizer
@@ -0,0 +1,673 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ * 
+ */
+
+#include <climits>
+#include <unordered_map>
+#include <vector>
+#include "ioptimizer.h"
+#include "beinterfdefs.h"
+#include "iunroll.h"
+#include "iblock.h"
+#include "iflow.h"
+#include "iloop.h"
+#include "ilive.h"
+#include "ilocal.h"
+#include "OptUtils.h"
+#include "ioptutil.h"
+#include "memory.h"
+
+/* loop unrolling
+ *
+ * this runs on innermost loops right after the translation to SSA form, so that
+ * constant optimization gets a chance to fold the induction values in the
+ * replicated code.  We only handle loops which are a simple chain of blocks with
+ * one conditional exit at the bottom, and whose trip count can be calculated from
+ * an induction variable with a constant initial value, constant step and constant
+ * bound.
+ *
+ * the body is replicated by inserting renamed copies of it right after the phi nodes
+ * of the loop header.  The original instructions become the last copy, so the
+ * exit test and any values used after the loop keep their names; uses of the phi
+ * targets in the original instructions are redirected to the values the previous
+ * copy calculated.
+ *
+ * loops that are small enough when fully expanded lose their back edge altogether.
+ * Otherwise the body is replicated UNROLL_FACTOR times (or less if the body is large)
+ * and the iterations left over are peeled into the block that enters the loop.
+ */
+#define UNROLL_FULL_TRIPS 16    /* max trip count for complete unrolling */
+#define UNROLL_FULL_SIZE 128    /* max instructions after complete unrolling */
+#define UNROLL_PARTIAL_SIZE 64  /* max instructions in a partially unrolled body */
+#define UNROLL_FACTOR 4
+#define UNROLL_MAX_TRIPS 65536 /* don't try to simulate induction variables past this */
+
+namespace Optimizer
+{
+static bool UnrollIntSize(int size)
+{
+    if (size < 0)
+        size = -size;
+    return size >= ISZ_UCHAR && size <= ISZ_ULONGLONG;
+}
+static bool UnrollFits(long long val, std::vector<int>& sizes)
+{
+    for (auto size : sizes)
+    {
+        int bits = sizeFromISZ(size) * 8;
+        if (bits >= 64)
+        {
+            if (val < LLONG_MIN / 4 || val > LLONG_MAX / 4)
+                return false;
+        }
+        else if (size < 0)
+        {
+            if (val < -(1LL << (bits - 1)) || val >= (1LL << (bits - 1)))
+                return false;
+        }
+        else if (val < 0 || val >= (1LL << bits))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+static bool UnrollSimpleMode(IMODE* im) { return !im || (!im->offset2 && !im->offset3 && !im->retval && !im->runtimeData); }
+/* returns true if the instruction doesn't prevent unrolling, skip is set for
+ * things which don't get replicated
+ */
+static bool UnrollCopyable(QUAD* q, bool& skip)
+{
+    skip = true;
+    if (q->ignoreMe)
+        return true;
+    switch (q->dc.opcode)
+    {
+        case i_block:
+        case i_blockend:
+        case i_label:
+        case i_line:
+        case i_dbgblock:
+        case i_dbgblockend:
+        case i_varstart:
+        case i_nop:
+        case i_goto: /* only ever goes to the next block in the chain */
+            return true;
+        case i_assn:
+            break;
+        default:
+            if (q->dc.opcode >= i_add && q->dc.opcode <= i_setge)
+                break;
+            return false;
+    }
+    skip = false;
+    if (q->atomic || q->runtimeData || q->altargs || q->blockassign || q->moveBarrier)
+        return false;
+    return UnrollSimpleMode(q->ans) && UnrollSimpleMode(q->dc.left) && UnrollSimpleMode(q->dc.right);
+}
+/* the loop has to be a chain of blocks starting at the header, with exactly one way in
+ * from outside and one conditional branch out
+ */
+static bool UnrollChain(UnrollLoop& ul)
+{
+    Loop* lp = ul.lp;
+    Block* head = lp->entry;
+    Block* b = head;
+    int preds = 0;
+    ul.enter = nullptr;
+    ul.latch = nullptr;
+    for (BLOCKLIST* bl = head->pred; bl; bl = bl->next)
+    {
+        preds++;
+        if (!briggsTest(lp->blocks, bl->block->blocknum))
+        {
+            if (ul.enter)
+                return false;
+            ul.enter = bl->block;
+        }
+    }
+    if (preds != 2 || !ul.enter)
+        return false;
+    do
+    {
+        Block* next = nullptr;
+        int n = 0;
+        if (b->head->moveBarrier || ul.chain.size() >= lp->blocks->top)
+            return false;
+        ul.chain.push_back(b);
+        for (BLOCKLIST* bl = b->succ; bl; bl = bl->next, n++)
+        {
+            if (briggsTest(lp->blocks, bl->block->blocknum))
+            {
+                if (next)
+                    return false;
+                next = bl->block;
+            }
+        }
+        if (!next)
+            return false;
+        if (n == 2)
+        {
+            QUAD* tail = b->tail;
+            while (tail->ignoreMe || tail->dc.opcode == i_blockend)
+                tail = tail->back;
+            if (ul.latch || tail->dc.opcode < i_jne || tail->dc.opcode > i_jge)
+                return false;
+            ul.latch = b;
+            ul.exit = tail;
+            /* successors of a conditional branch are the fall through then the branch target */
+            ul.exitTaken = b->succ->block == next;
+        }
+        else if (n != 1)
+        {
+            return false;
+        }
+        if (next != head && next->pred->next)
+            return false;
+        b = next;
+    } while (b != head);
+    return ul.latch && ul.chain.size() == lp->blocks->top;
+}
+static bool UnrollBody(UnrollLoop& ul)
+{
+    bool afterLatch = false;
+    for (auto b : ul.chain)
+    {
+        for (QUAD* q = b->head; q != b->tail->fwd; q = q->fwd)
+        {
+            if (q->dc.opcode == i_phi)
+            {
+                PHIDATA* pd = q->dc.v.phi;
+                UnrollPhi phi = {q, pd->T0, nullptr, nullptr};
+                if (b != ul.chain.front())
+                    return false;
+                for (struct _phiblock* pb = pd->temps; pb; pb = pb->next)
+                {
+                    if (pb->block == ul.enter && !phi.init)
+                        phi.init = pb;
+                    else if (pb->block == ul.chain.back() && !phi.back)
+                        phi.back = pb;
+                    else
+                        return false;
+                }
+                if (!phi.init || !phi.back)
+                    return false;
+                /* the values of the phi targets change meaning once the loop is unrolled */
+                if (tempInfo[pd->T0]->instructionUses)
+                    for (auto use : *tempInfo[pd->T0]->instructionUses)
+                        if (!briggsTest(ul.lp->blocks, use->block->blocknum))
+                            return false;
+                ul.phis.push_back(phi);
+            }
+            else if (q != ul.exit)
+            {
+                bool skip;
+                if (!UnrollCopyable(q, skip))
+                    return false;
+                if (!skip)
+                {
+                    if (afterLatch)
+                        return false;
+                    ul.body.push_back(q);
+                }
+            }
+        }
+        if (b == ul.latch)
+            afterLatch = true;
+    }
+    return !ul.body.empty();
+}
+/* follow a chain of copies back to the original value */
+static int UnrollTrace(int tnum, std::vector<int>& sizes)
+{
+    QUAD* q;
+    while ((q = tempInfo[tnum]->instructionDefines) && q->dc.opcode == i_assn && (q->temps & TEMP_LEFT) &&
+           q->dc.left->mode == i_direct && UnrollIntSize(q->ans->size) && UnrollIntSize(q->dc.left->size))
+    {
+        sizes.push_back(q->ans->size);
+        sizes.push_back(q->dc.left->size);
+        tnum = q->dc.left->offset->sp->i;
+    }
+    return tnum;
+}
+static bool UnrollConstant(IMODE* im, long long& val, std::vector<int>& sizes)
+{
+    if (im->mode == i_immed && isintconst(im->offset))
+    {
+        val = im->offset->i;
+        return true;
+    }
+    if (im->mode == i_direct && im->offset && im->offset->type == se_tempref)
+    {
+        QUAD* q = tempInfo[UnrollTrace(im->offset->sp->i, sizes)]->instructionDefines;
+        if (q && q->dc.opcode == i_assn && q->dc.left->mode == i_immed && isintconst(q->dc.left->offset) &&
+            UnrollIntSize(q->ans->size))
+        {
+            sizes.push_back(q->ans->size);
+            val = q->dc.left->offset->i;
+            return true;
+        }
+    }
+    return false;
+}
+/* a basic induction variable is a phi target which gets a constant added to it
+ * on the way around the loop
+ */
+static bool UnrollStep(UnrollLoop& ul, UnrollPhi& phi, int& incremented, long long& step, std::vector<int>& sizes)
+{
+    incremented = UnrollTrace(phi.back->Tn, sizes);
+    QUAD* q = tempInfo[incremented]->instructionDefines;
+    // a phi defines its temp without an answer
+    if (!q || !q->ans || !briggsTest(ul.lp->blocks, q->block->blocknum) || !UnrollIntSize(q->ans->size))
+        return false;
+    IMODE *var, *c;
+    if (q->dc.opcode == i_add && q->dc.left->mode == i_immed)
+    {
+        c = q->dc.left;
+        var = q->dc.right;
+    }
+    else if (q->dc.opcode == i_add || q->dc.opcode == i_sub)
+    {
+        c = q->dc.right;
+        var = q->dc.left;
+    }
+    else
+    {
+        return false;
+    }
+    if (c->mode != i_immed || !isintconst(c->offset) || var->mode != i_direct || !var->offset ||
+        var->offset->type != se_tempref || UnrollTrace(var->offset->sp->i, sizes) != phi.T0)
+        return false;
+    sizes.push_back(q->ans->size);
+    step = q->dc.opcode == i_sub ? -c->offset->i : c->offset->i;
+    return step != 0;
+}
+static bool UnrollCompare(enum i_ops op, long long left, long long right, bool& rv)
+{
+    switch (op)
+    {
+        case i_je:
+            rv = left == right;
+            return true;
+        case i_jne:
+            rv = left != right;
+            return true;
+        case i_jl:
+            rv = left < right;
+            return true;
+        case i_jg:
+            rv = left > right;
+            return true;
+        case i_jle:
+            rv = left <= right;
+            return true;
+        case i_jge:
+            rv = left >= right;
+            return true;
+        default:
+            break;
+    }
+    if (left < 0 || right < 0)
+        return false;
+    switch (op)
+    {
+        case i_jc:
+            rv = left < right;
+            return true;
+        case i_ja:
+            rv = left > right;
+            return true;
+        case i_jnc:
+            rv = left >= right;
+            return true;
+        case i_jbe:
+            rv = left <= right;
+            return true;
+        default:
+            return false;
+    }
+}
+static bool UnrollIsInduction(Loop* lp, int tnum)
+{
+    for (INDUCTION_LIST* is = lp->inductionSets; is; is = is->next)
+        for (ILIST* vars = is->vars; vars; vars = vars->next)
+            if (vars->data == tnum)
+                return true;
+    return false;
+}
+/* figure out how many times the body runs by simulating the induction variable
+ * the exit test looks at
+ */
+bool UnrollTrips(UnrollLoop& ul)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        IMODE* ivmode = i ? ul.exit->dc.right : ul.exit->dc.left;
+        IMODE* boundmode = i ? ul.exit->dc.left : ul.exit->dc.right;
+        std::vector<int> sizes;
+        long long bound, init, step;
+        if (!boundmode || !ivmode || ivmode->mode != i_direct || !ivmode->offset || ivmode->offset->type != se_tempref ||
+            !UnrollIntSize(ivmode->size) || !UnrollConstant(boundmode, bound, sizes))
+            continue;
+        sizes.push_back(ivmode->size);
+        int tested = UnrollTrace(ivmode->offset->sp->i, sizes);
+        for (auto&& phi : ul.phis)
+        {
+            int incremented;
+            std::vector<int> ivsizes = sizes;
+            if (!UnrollStep(ul, phi, incremented, step, ivsizes))
+                continue;
+            if (tested != phi.T0 && tested != incremented)
+                continue;
+            if (!UnrollIsInduction(ul.lp, phi.T0) || !UnrollConstant(tempInfo[phi.init->Tn]->enode->sp->imvalue, init, ivsizes) ||
+                !UnrollFits(init, ivsizes))
+                return false;
+            long long val = init;
+            for (int n = 1; n <= UNROLL_MAX_TRIPS; n++)
+            {
+                long long next = val + step;
+                long long test = tested == incremented ? next : val;
+                bool cond;
+                if (!UnrollFits(next, ivsizes) || !UnrollCompare(ul.exit->dc.opcode, i ? bound : test, i ? test : bound, cond))
+                    return false;
+                if (cond == ul.exitTaken)
+                {
+                    ul.trips = n;
+                    ul.induction = &phi - &ul.phis[0];
+                    ul.step = step;
+                    ul.testsNext = tested == incremented;
+                    return true;
+                }
+                val = next;
+            }
+            return false;
+        }
+    }
+    return false;
+}
+int UnrollTemp(int tnum, Block* b)
+{
+    TempInfo* t = tempInfo[tnum];
+    IMODE* rv = InitTempOpt(t->enode->sp->imvalue->size, t->size);
+    int n = rv->offset->sp->i;
+    rv->vol = t->enode->sp->imvalue->vol;
+    rv->restricted = t->enode->sp->imvalue->restricted;
+    tempInfo[n]->blockDefines = b;
+    tempInfo[n]->enode->sp->pushedtotemp = t->enode->sp->pushedtotemp;
+    tempInfo[n]->enode->sp->loadTemp = t->enode->sp->loadTemp;
+    tempInfo[n]->enode->sp->storeTemp = t->enode->sp->storeTemp;
+    if (t->enode->sp->tp)
+        tempInfo[n]->enode->sp->tp = t->enode->sp->tp;
+    return n;
+}
+static int UnrollValue(UnrollNames& names, int tnum)
+{
+    auto it = names.find(tnum);
+    return it == names.end() ? tnum : it->second;
+}
+IMODE* UnrollName(IMODE* im, UnrollNames& names)
+{
+    if (!im || (im->mode != i_direct && im->mode != i_ind) || !im->offset || im->offset->type != se_tempref)
+        return im;
+    auto it = names.find(im->offset->sp->i);
+    if (it == names.end())
+        return im;
+    SimpleExpression* enode = tempInfo[it->second]->enode;
+    if (im->mode == i_direct)
+        return enode->sp->imvalue;
+    if (!im->bits)
+        for (IMODELIST* iml = enode->sp->imind; iml; iml = iml->next)
+            if (iml->im->size == im->size)
+                return iml->im;
+    IMODE* rv = Allocate<IMODE>();
+    *rv = *im;
+    rv->offset = enode;
+    if (!im->bits)
+    {
+        IMODELIST* iml = Allocate<IMODELIST>();
+        iml->im = rv;
+        iml->next = enode->sp->imind;
+        enode->sp->imind = iml;
+    }
+    return rv;
+}
+QUAD* UnrollCopy(QUAD* ins, QUAD* at, UnrollNames& names, std::vector<QUAD*>& copies)
+{
+    QUAD* q = Allocate<QUAD>();
+    *q = *ins;
+    q->fwd = q->back = nullptr;
+    q->uses = q->transparent = q->dsafe = q->earliest = q->delay = q->latest = q->isolated = q->OCP = q->RO = nullptr;
+    q->dc.left = UnrollName(ins->dc.left, names);
+    q->dc.right = UnrollName(ins->dc.right, names);
+    if ((ins->temps & TEMP_ANS) && ins->ans->mode == i_direct)
+    {
+        int tnum = ins->ans->offset->sp->i;
+        int n = UnrollTemp(tnum, at->block);
+        names[tnum] = n;
+        q->ans = tempInfo[n]->enode->sp->imvalue;
+    }
+    else
+    {
+        q->ans = UnrollName(ins->ans, names);
+    }
+    InsertInstruction(at, q);
+    copies.push_back(q);
+    return q;
+}
+/* lay down count copies of the body after 'at', the phi targets start out with the
+ * values in 'names' and on return 'names' holds their values after the last copy
+ */
+static void UnrollReplicate(UnrollLoop& ul, QUAD* at, UnrollNames& names, int count, std::vector<QUAD*>& copies)
+{
+    for (int i = 0; i < count; i++)
+    {
+        UnrollNames next;
+        for (auto ins : ul.body)
+            at = UnrollCopy(ins, at, names, copies);
+        for (auto&& phi : ul.phis)
+            next[phi.T0] = UnrollValue(names, phi.back->Tn);
+        names = next;
+    }
+}
+static void UnrollPhiArg(UnrollPhi& phi, struct _phiblock* pb, int tnum)
+{
+    if (pb->Tn != tnum)
+    {
+        RemoveFromUses(phi.ins, pb->Tn);
+        pb->Tn = tnum;
+        for (struct _phiblock* pb1 = phi.ins->dc.v.phi->temps; pb1; pb1 = pb1->next)
+            InsertUses(phi.ins, pb1->Tn);
+    }
+}
+static void UnrollRedirect(QUAD* ins, UnrollNames& names)
+{
+    IMODE** modes[] = {&ins->dc.left, &ins->dc.right, &ins->ans};
+    for (auto m : modes)
+    {
+        if (*m && (m != &ins->ans || (*m)->mode == i_ind))
+        {
+            IMODE* im = UnrollName(*m, names);
+            if (im != *m)
+            {
+                RemoveFromUses(ins, (*m)->offset->sp->i);
+                InsertUses(ins, im->offset->sp->i);
+                *m = im;
+            }
+        }
+    }
+}
+/* the leftover iterations go at the end of the block that enters the loop */
+void UnrollPeel(UnrollLoop& ul, int count, std::vector<QUAD*>& copies)
+{
+    QUAD* at = beforeJmp(ul.enter->tail, true);
+    if (at->dc.opcode == i_blockend)
+        at = at->back;
+    UnrollNames names;
+    for (auto&& phi : ul.phis)
+        names[phi.T0] = phi.init->Tn;
+    UnrollReplicate(ul, at, names, count, copies);
+    for (auto&& phi : ul.phis)
+        UnrollPhiArg(phi, phi.init, names[phi.T0]);
+}
+/* the copies go after the phi nodes, and the original instructions now see
+ * the values from the last copy instead of the phi targets
+ */
+static void UnrollExpand(UnrollLoop& ul, int count, std::vector<QUAD*>& copies)
+{
+    Block* head = ul.chain.front();
+    QUAD* at = head->head;
+    while (at != head->tail && (at->fwd->dc.opcode == i_label || at->fwd->ignoreMe || at->fwd->dc.opcode == i_phi))
+        at = at->fwd;
+    UnrollNames names;
+    for (auto&& phi : ul.phis)
+        names[phi.T0] = phi.T0;
+    UnrollReplicate(ul, at, names, count, copies);
+    for (auto ins : ul.body)
+        UnrollRedirect(ins, names);
+    UnrollRedirect(ul.exit, names);
+    for (auto&& phi : ul.phis)
+        UnrollPhiArg(phi, phi.back, UnrollValue(names, phi.back->Tn));
+}
+/* when the loop is fully unrolled the exit test always leaves */
+static void UnrollRemoveBackEdge(UnrollLoop& ul)
+{
+    QUAD* q = ul.exit;
+    Block* out = ul.exitTaken ? ul.latch->succ->next->block : ul.latch->succ->block;
+    if (ul.exitTaken)
+    {
+        if (q->temps & TEMP_LEFT)
+            RemoveFromUses(q, q->dc.left->offset->sp->i);
+        if (q->temps & TEMP_RIGHT)
+            RemoveFromUses(q, q->dc.right->offset->sp->i);
+        q->dc.opcode = i_goto;
+        q->dc.left = q->dc.right = nullptr;
+        q->temps = 0;
+    }
+    else
+    {
+        RemoveInstruction(q);
+    }
+    reflowConditional(ul.latch, out);
+    for (auto&& phi : ul.phis)
+    {
+        RemoveFromUses(phi.ins, phi.back->Tn);
+        for (struct _phiblock* pb = phi.ins->dc.v.phi->temps; pb; pb = pb->next)
+            InsertUses(phi.ins, pb->Tn);
+    }
+}
+/* get rid of copies of things only the exit test needed */
+void UnrollRemoveDead(std::vector<QUAD*>& list)
+{
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto&& q : list)
+        {
+            if (q && (q->temps & TEMP_ANS) && q->ans->mode == i_direct && !q->ans->vol &&
+                !(q->dc.left && q->dc.left->vol) && !(q->dc.right && q->dc.right->vol))
+            {
+                auto uses = tempInfo[q->ans->offset->sp->i]->instructionUses;
+                if (!uses || uses->empty())
+                {
+                    RemoveInstruction(q);
+                    q = nullptr;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+bool UnrollShape(Loop* lp, UnrollLoop& ul)
+{
+    ul.lp = lp;
+    return UnrollChain(ul) && UnrollBody(ul);
+}
+bool UnrollAnalyze(Loop* lp, UnrollLoop& ul) { return UnrollShape(lp, ul) && UnrollTrips(ul); }
+bool UnrollCanPeel(UnrollLoop& ul) { return ul.enter != blockArray[0] && !ul.enter->succ->next && !ul.enter->head->moveBarrier; }
+bool UnrollInnermost(Loop* lp)
+{
+    if (lp->type != LT_SINGLE)
+        return false;
+    for (LIST* l = lp->contains; l; l = l->next)
+        if (((Loop*)l->data)->type != LT_BLOCK)
+            return false;
+    return true;
+}
+/* strength reduction calculates its own induction information later */
+void UnrollResetInduction(bool changed)
+{
+    for (int i = 0; i < loopCount; i++)
+        if (loopArray[i])
+            loopArray[i]->inductionSets = nullptr;
+    for (int i = 0; i < tempCount; i++)
+        tempInfo[i]->inductionLoop = 0;
+    if (changed)
+        doms_only(false);
+}
+static bool UnrollOne(Loop* lp)
+{
+    UnrollLoop ul;
+    if (!UnrollAnalyze(lp, ul))
+        return false;
+    int size = ul.body.size();
+    int count, peel = 0;
+    bool full = ul.trips <= UNROLL_FULL_TRIPS && ul.trips * size <= UNROLL_FULL_SIZE;
+    if (full)
+    {
+        count = ul.trips - 1;
+    }
+    else
+    {
+        int factor = UNROLL_FACTOR;
+        while (factor > 1 && (factor * size > UNROLL_PARTIAL_SIZE || factor * 2 > ul.trips))
+            factor /= 2;
+        if (factor < 2)
+            return false;
+        peel = ul.trips % factor;
+        if (peel && !UnrollCanPeel(ul))
+            return false;
+        count = factor - 1;
+    }
+    std::vector<QUAD*> copies;
+    if (peel)
+        UnrollPeel(ul, peel, copies);
+    UnrollExpand(ul, count, copies);
+    if (full)
+        UnrollRemoveBackEdge(ul);
+    for (auto ins : ul.body)
+        copies.push_back(ins);
+    UnrollRemoveDead(copies);
+    return true;
+}
+void UnrollLoops(void)
+{
+    bool changed = false;
+    CalculateInduction();
+    for (int i = 0; i < loopCount; i++)
+        if (loopArray[i] && UnrollInnermost(loopArray[i]) && UnrollOne(loopArray[i]))
+            changed = true;
+    UnrollResetInduction(changed);
+}
+}  // namespace Optimizer
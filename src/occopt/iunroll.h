@@ -0,0 +1,68 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ */
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+namespace Optimizer
+{
+typedef std::unordered_map<int, int> UnrollNames;
+
+struct UnrollPhi
+{
+    QUAD* ins;
+    int T0;
+    struct _phiblock* init; /* value coming from outside the loop */
+    struct _phiblock* back; /* value coming around the back edge */
+};
+struct UnrollLoop
+{
+    Loop* lp;
+    std::vector<Block*> chain;
+    std::vector<UnrollPhi> phis;
+    std::vector<QUAD*> body; /* instructions that get replicated */
+    Block* enter;            /* the block outside the loop that enters it */
+    Block* latch;
+    QUAD* exit;     /* the conditional branch that leaves the loop */
+    bool exitTaken; /* true if taking the branch leaves the loop */
+    int trips;
+    int induction;  /* index of the phi the exit test depends on */
+    long long step; /* amount added to it each time around */
+    bool testsNext; /* true if the exit test uses the incremented value */
+};
+
+bool UnrollShape(Loop* lp, UnrollLoop& ul);
+bool UnrollTrips(UnrollLoop& ul);
+bool UnrollAnalyze(Loop* lp, UnrollLoop& ul);
+bool UnrollCanPeel(UnrollLoop& ul);
+bool UnrollInnermost(Loop* lp);
+int UnrollTemp(int tnum, Block* b);
+IMODE* UnrollName(IMODE* im, UnrollNames& names);
+QUAD* UnrollCopy(QUAD* ins, QUAD* at, UnrollNames& names, std::vector<QUAD*>& copies);
+void UnrollPeel(UnrollLoop& ul, int count, std::vector<QUAD*>& copies);
+void UnrollRemoveDead(std::vector<QUAD*>& list);
+void UnrollResetInduction(bool changed);
+void UnrollLoops(void);
+}  // namespace Optimizer
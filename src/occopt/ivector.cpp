@@ -0,0 +1,642 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ * 
+ */
+
+#include <set>
+#include <vector>
+#include "ioptimizer.h"
+#include "beinterfdefs.h"
+#include "ivector.h"
+#include "iunroll.h"
+#include "iblock.h"
+#include "iflow.h"
+#include "iloop.h"
+#include "OptUtils.h"
+#include "ioptutil.h"
+#include "ilive.h"
+#include "memory.h"
+
+/* loop vectorization
+ *
+ * this finds innermost loops whose body is a single statement of the form
+ *
+ *     a[i] = b[i] op c[i]
+ *
+ * where the elements are 32 bit integers, floats or doubles, and either operand may
+ * also be loop invariant.  The statement is replaced with one of the packed
+ * operations, which works on 16 bytes of memory at a time, and the induction
+ * variable is stepped by the number of elements processed.  The backend lowers
+ * the packed operations to SSE2 instructions.
+ *
+ * the loop shape and the trip count come from the unroll analysis.  With a constant
+ * trip count, iterations that don't make up a full vector are peeled off into the
+ * block that enters the loop.  Otherwise the loop has to run while the induction
+ * variable is less than something loop invariant; a vector version of the loop is
+ * built in front of it, and the original loop is left to run whatever iterations
+ * remain:
+ *
+ *         if (bound < width) goto scalar
+ *         limit = bound - (width - 1)
+ *         if (init >= limit) goto scalar
+ *     vector:
+ *         ...one vector...
+ *         if (i < limit) goto vector
+ *         if (i >= bound) goto exit
+ *     scalar:
+ *         ...the original loop...
+ *
+ * the arrays written to may not overlap the arrays read from unless it is
+ * the same element; this is only known when the arrays are distinct variables
+ * or when one of the pointers involved is restrict-qualified.
+ */
+#define VECTOR_BYTES 16 /* size of an SSE register */
+
+namespace Optimizer
+{
+struct VectorAccess
+{
+    SimpleSymbol* sym; /* the variable, if the array is addressed directly */
+    int root;          /* otherwise the temp holding the pointer */
+    bool restricted;
+};
+
+static bool VectorInLoop(UnrollLoop& ul, QUAD* q) { return q && briggsTest(ul.lp->blocks, q->block->blocknum); }
+static bool VectorTemp(IMODE* im)
+{
+    return im && im->mode == i_direct && im->offset && im->offset->type == se_tempref && !im->vol && !im->bits &&
+           !im->offset2 && !im->retval;
+}
+/* follow a chain of copies back to the original value */
+static int VectorTrace(int tnum, std::vector<QUAD*>* path)
+{
+    QUAD* q;
+    while ((q = tempInfo[tnum]->instructionDefines) && q->dc.opcode == i_assn && VectorTemp(q->dc.left) &&
+           q->dc.left->size == q->ans->size)
+    {
+        if (path)
+            path->push_back(q);
+        tnum = q->dc.left->offset->sp->i;
+    }
+    return tnum;
+}
+static bool VectorIntSize(int size)
+{
+    return size > -ISZ_FLOAT && size < ISZ_FLOAT && sizeFromISZ(size) == 4 && abs(size) != ISZ_ADDR;
+}
+static bool VectorSameType(int size, int elem)
+{
+    if (VectorIntSize(elem))
+        return VectorIntSize(size);
+    return size == elem;
+}
+static enum i_ops VectorOp(enum i_ops op, int elem)
+{
+    switch (op)
+    {
+        case i_add:
+            return i_vadd;
+        case i_sub:
+            return i_vsub;
+        case i_mul:
+            /* there is no packed 32 bit multiply in SSE2 */
+            return VectorIntSize(elem) ? i_nop : i_vmul;
+        case i_and:
+            return VectorIntSize(elem) ? i_vand : i_nop;
+        case i_or:
+            return VectorIntSize(elem) ? i_vor : i_nop;
+        case i_eor:
+            return VectorIntSize(elem) ? i_veor : i_nop;
+        default:
+            return i_nop;
+    }
+}
+/* a value the same for every iteration, which will be broadcast to each element */
+static IMODE* VectorInvariant(UnrollLoop& ul, IMODE* im, int elem, std::vector<QUAD*>& statement)
+{
+    if (im->mode == i_immed)
+    {
+        if (isintconst(im->offset) || (!VectorIntSize(elem) && isfloatconst(im->offset)))
+            return im;
+        return nullptr;
+    }
+    if (!VectorTemp(im) || !VectorSameType(im->size, elem))
+        return nullptr;
+    std::vector<QUAD*> path;
+    int root = VectorTrace(im->offset->sp->i, &path);
+    QUAD* q = tempInfo[root]->instructionDefines;
+    if (!VectorInLoop(ul, q))
+    {
+        statement.insert(statement.end(), path.begin(), path.end());
+        return tempInfo[root]->enode->sp->imvalue;
+    }
+    if (q->dc.opcode == i_assn && q->dc.left->mode == i_immed && q->ans->size == im->size &&
+        VectorInvariant(ul, q->dc.left, elem, statement))
+    {
+        statement.insert(statement.end(), path.begin(), path.end());
+        statement.push_back(q);
+        return q->dc.left;
+    }
+    return nullptr;
+}
+/* the address must be the start of an array plus the induction variable scaled by the element size */
+static bool VectorIndex(UnrollLoop& ul, IMODE* im, int bytes)
+{
+    if (!VectorTemp(im))
+        return false;
+    QUAD* q = tempInfo[VectorTrace(im->offset->sp->i, nullptr)]->instructionDefines;
+    if (!VectorInLoop(ul, q) || !VectorTemp(q->dc.left) || !q->dc.right || q->dc.right->mode != i_immed ||
+        !isintconst(q->dc.right->offset))
+        return false;
+    if (!(q->dc.opcode == i_lsl && q->dc.right->offset->i < 8 && (1 << q->dc.right->offset->i) == bytes) &&
+        !(q->dc.opcode == i_mul && q->dc.right->offset->i == bytes))
+        return false;
+    return VectorTrace(q->dc.left->offset->sp->i, nullptr) == ul.phis[ul.induction].T0;
+}
+static bool VectorBase(UnrollLoop& ul, IMODE* im, VectorAccess& access)
+{
+    if (im->mode == i_immed)
+    {
+        if (im->offset->type != se_global && im->offset->type != se_auto)
+            return false;
+        access.sym = im->offset->sp;
+        return true;
+    }
+    if (!VectorTemp(im))
+        return false;
+    access.root = VectorTrace(im->offset->sp->i, nullptr);
+    if (VectorInLoop(ul, tempInfo[access.root]->instructionDefines))
+        return false;
+    /* a pointer loaded from a restrict-qualified variable */
+    QUAD* q = tempInfo[access.root]->instructionDefines;
+    access.restricted = tempInfo[access.root]->enode->sp->imvalue->restricted ||
+                        (q && q->dc.opcode == i_assn && q->dc.left->mode == i_direct &&
+                         (q->dc.left->offset->type == se_auto || q->dc.left->offset->type == se_global) &&
+                         q->dc.left->offset->sp->tp && q->dc.left->offset->sp->tp->isrestrict);
+    return true;
+}
+static bool VectorAddress(UnrollLoop& ul, IMODE* im, int elem, VectorAccess& access)
+{
+    if (im->mode != i_ind || !im->offset || im->offset->type != se_tempref || im->offset2 || im->offset3 || im->bits ||
+        im->vol || im->retval || !VectorSameType(im->size, elem))
+        return false;
+    QUAD* q = tempInfo[VectorTrace(im->offset->sp->i, nullptr)]->instructionDefines;
+    if (!VectorInLoop(ul, q) || q->dc.opcode != i_add)
+        return false;
+    int bytes = sizeFromISZ(elem);
+    access = {nullptr, -1, false};
+    if (VectorIndex(ul, q->dc.right, bytes))
+        return VectorBase(ul, q->dc.left, access);
+    if (VectorIndex(ul, q->dc.left, bytes))
+        return VectorBase(ul, q->dc.right, access);
+    return false;
+}
+/* one side of the operation is either a load from an array or something invariant */
+static IMODE* VectorOperand(UnrollLoop& ul, IMODE* im, int elem, std::vector<QUAD*>& statement, std::vector<VectorAccess>& loads)
+{
+    if (VectorTemp(im))
+    {
+        std::vector<QUAD*> path;
+        QUAD* q = tempInfo[VectorTrace(im->offset->sp->i, &path)]->instructionDefines;
+        if (VectorInLoop(ul, q) && q->dc.opcode == i_assn && q->dc.left->mode == i_ind)
+        {
+            VectorAccess access;
+            if (!VectorSameType(q->ans->size, elem) || !VectorAddress(ul, q->dc.left, elem, access))
+                return nullptr;
+            loads.push_back(access);
+            statement.insert(statement.end(), path.begin(), path.end());
+            statement.push_back(q);
+            return q->dc.left;
+        }
+    }
+    return VectorInvariant(ul, im, elem, statement);
+}
+static bool VectorDisjoint(VectorAccess& store, VectorAccess& load)
+{
+    if (store.sym || load.sym)
+    {
+        if (store.sym && load.sym)
+            return true; /* the same variable gives the same element */
+        return store.restricted || load.restricted;
+    }
+    return store.root == load.root || store.restricted || load.restricted;
+}
+static QUAD* VectorStore(UnrollLoop& ul)
+{
+    QUAD* store = nullptr;
+    for (auto q : ul.body)
+    {
+        if (q->ans && q->ans->mode == i_ind)
+        {
+            if (store)
+                return nullptr;
+            store = q;
+        }
+    }
+    return store && store->dc.opcode == i_assn ? store : nullptr;
+}
+/* the induction variable has to step by one and be the only thing carried around the loop */
+static QUAD* VectorIncrement(UnrollLoop& ul, std::set<int>& chain)
+{
+    if (ul.phis.size() != 1 || ul.step != 1 || !ul.testsNext)
+        return nullptr;
+    std::vector<QUAD*> path;
+    int incremented = VectorTrace(ul.phis[0].back->Tn, &path);
+    QUAD* q = tempInfo[incremented]->instructionDefines;
+    for (auto p : path)
+        chain.insert(p->ans->offset->sp->i);
+    chain.insert(incremented);
+    if (!VectorInLoop(ul, q) || q->dc.opcode != i_add)
+        return nullptr;
+    return q;
+}
+/* with no trip count, the loop has to stop when the induction variable, stepped by one,
+ * reaches a loop invariant bound
+ */
+static IMODE* VectorBound(UnrollLoop& ul, bool& isSigned)
+{
+    if (ul.phis.size() != 1)
+        return nullptr;
+    UnrollPhi& phi = ul.phis[0];
+    int incremented = VectorTrace(phi.back->Tn, nullptr);
+    QUAD* q = tempInfo[incremented]->instructionDefines;
+    if (!VectorInLoop(ul, q) || q->dc.opcode != i_add || !VectorIntSize(q->ans->size))
+        return nullptr;
+    IMODE* one = q->dc.left->mode == i_immed ? q->dc.left : q->dc.right;
+    IMODE* var = one == q->dc.left ? q->dc.right : q->dc.left;
+    if (one->mode != i_immed || !isintconst(one->offset) || one->offset->i != 1 || !VectorTemp(var) ||
+        VectorTrace(var->offset->sp->i, nullptr) != phi.T0)
+        return nullptr;
+    for (int i = 0; i < 2; i++)
+    {
+        IMODE* iv = i ? ul.exit->dc.right : ul.exit->dc.left;
+        IMODE* bound = i ? ul.exit->dc.left : ul.exit->dc.right;
+        if (!VectorTemp(iv) || !VectorIntSize(iv->size) || VectorTrace(iv->offset->sp->i, nullptr) != incremented)
+            continue;
+        /* the loop keeps going while iv < bound */
+        enum i_ops op = ul.exit->dc.opcode;
+        if (ul.exitTaken ? (i ? op != i_jle && op != i_jbe : op != i_jge && op != i_jnc)
+                         : (i ? op != i_jg && op != i_ja : op != i_jl && op != i_jc))
+            return nullptr;
+        if (bound->mode == i_immed)
+        {
+            if (!isintconst(bound->offset))
+                return nullptr;
+        }
+        else
+        {
+            if (!VectorTemp(bound) || bound->size != iv->size)
+                return nullptr;
+            int root = VectorTrace(bound->offset->sp->i, nullptr);
+            if (VectorInLoop(ul, tempInfo[root]->instructionDefines))
+                return nullptr;
+            bound = tempInfo[root]->enode->sp->imvalue;
+        }
+        isSigned = op == i_jl || op == i_jge || op == i_jg || op == i_jle;
+        ul.trips = 0;
+        ul.induction = 0;
+        ul.step = 1;
+        ul.testsNext = true;
+        return bound;
+    }
+    return nullptr;
+}
+/* the block the loop goes to when it is done, and the one after it if that is just an edge */
+static Block* VectorOut(UnrollLoop& ul) { return ul.exitTaken ? ul.latch->succ->next->block : ul.latch->succ->block; }
+static Block* VectorExit(UnrollLoop& ul)
+{
+    Block* out = VectorOut(ul);
+    return out->critical ? out->succ->block : out;
+}
+/* a new block goes right in front of 'before' */
+static Block* VectorBlock(Block* before)
+{
+    Block* b = newBlock()->block;
+    QUAD* head = Allocate<QUAD>();
+    head->dc.opcode = i_block;
+    head->dc.v.label = b->blocknum;
+    head->block = b;
+    head->back = before->head->back;
+    head->fwd = before->head;
+    head->back->fwd = head;
+    before->head->back = head;
+    b->head = b->tail = head;
+    QUAD* lbl = Allocate<QUAD>();
+    lbl->dc.opcode = i_label;
+    lbl->dc.v.label = nextLabel++;
+    InsertInstruction(head, lbl);
+    return b;
+}
+static int VectorLabel(Block* b)
+{
+    for (QUAD* q = b->head; q != b->tail->fwd && (q == b->head || q->ignoreMe || q->dc.opcode == i_label); q = q->fwd)
+        if (q->dc.opcode == i_label)
+            return q->dc.v.label;
+    QUAD* lbl = Allocate<QUAD>();
+    lbl->dc.opcode = i_label;
+    lbl->dc.v.label = nextLabel++;
+    InsertInstruction(b->head, lbl);
+    return lbl->dc.v.label;
+}
+/* successors are listed with the fall through first, and the order of the predecessors
+ * is the order of the values in the phi nodes
+ */
+static void VectorList(BLOCKLIST** bl, Block* b)
+{
+    while (*bl)
+        bl = &(*bl)->next;
+    *bl = oAllocate<BLOCKLIST>();
+    (*bl)->block = b;
+}
+static void VectorEdge(Block* from, Block* to)
+{
+    VectorList(&from->succ, to);
+    VectorList(&to->pred, from);
+}
+static void VectorPhiArg(QUAD* q, Block* b, int tnum)
+{
+    struct _phiblock** pb = &q->dc.v.phi->temps;
+    while (*pb)
+        pb = &(*pb)->next;
+    *pb = Allocate<_phiblock>();
+    (*pb)->block = b;
+    (*pb)->Tn = tnum;
+    q->dc.v.phi->nblocks++;
+    if (q->block)
+        InsertUses(q, tnum);
+}
+static QUAD* VectorBranch(Block* b, enum i_ops op, IMODE* left, IMODE* right, int label)
+{
+    QUAD* q = Allocate<QUAD>();
+    q->dc.opcode = op;
+    q->dc.left = left;
+    q->dc.right = right;
+    q->dc.v.label = label;
+    InsertInstruction(b->tail, q);
+    return q;
+}
+/* build the vector loop in front of the original one, which then handles the iterations
+ * that are left over
+ */
+static void VectorRuntime(UnrollLoop& ul, IMODE* bound, bool isSigned, QUAD* vector, QUAD* store, QUAD* increment,
+                          std::set<int>& chain, int width)
+{
+    UnrollPhi& phi = ul.phis[0];
+    Block* head = ul.chain.front();
+    Block* out = VectorOut(ul);
+    Block* exit = VectorExit(ul);
+    int headLabel = VectorLabel(head);
+    int exitLabel = VectorLabel(exit);
+    int size = tempInfo[phi.T0]->enode->sp->imvalue->size;
+    IMODE* init = tempInfo[phi.init->Tn]->enode->sp->imvalue;
+    IMODE* limit;
+
+    Block* guard = bound->mode == i_immed ? nullptr : VectorBlock(head);
+    Block* start = VectorBlock(head);
+    Block* loop = VectorBlock(head);
+    Block* after = VectorBlock(head);
+    Block* first = guard ? guard : start;
+
+    /* whatever went to the original loop goes to the guards now */
+    Block* enter = ul.enter->critical ? ul.enter->pred->block : ul.enter;
+    QUAD* jmp = beforeJmp(enter->tail, false);
+    if ((jmp->dc.opcode == i_goto || (jmp->dc.opcode >= i_jne && jmp->dc.opcode <= i_jge)) && jmp->dc.v.label == headLabel)
+        jmp->dc.v.label = VectorLabel(first);
+    for (BLOCKLIST* bl = ul.enter->succ; bl; bl = bl->next)
+        if (bl->block == head)
+            bl->block = first;
+    /* and the edge that came into the loop from outside is now the one from the first guard */
+    for (BLOCKLIST* bl = head->pred; bl; bl = bl->next)
+        if (bl->block == ul.enter)
+            bl->block = first;
+    VectorList(&first->pred, ul.enter);
+
+    if (guard)
+    {
+        VectorBranch(guard, isSigned ? i_jl : i_jc, bound, make_immed(size, width), headLabel);
+        VectorEdge(guard, start);
+        VectorList(&guard->succ, head);
+        limit = tempInfo[UnrollTemp(phi.T0, start)]->enode->sp->imvalue;
+        QUAD* q = Allocate<QUAD>();
+        q->dc.opcode = i_sub;
+        q->ans = limit;
+        q->dc.left = bound;
+        q->dc.right = make_immed(size, width - 1);
+        InsertInstruction(start->tail, q);
+    }
+    else
+    {
+        limit = make_immed(size, bound->offset->i - (width - 1));
+    }
+    VectorBranch(start, isSigned ? i_jge : i_jnc, init, limit, headLabel);
+    VectorEdge(start, loop);
+    if (guard)
+    {
+        VectorEdge(start, head);
+        VectorPhiArg(phi.ins, start, phi.init->Tn);
+    }
+    else
+    {
+        VectorList(&start->succ, head);
+    }
+
+    /* the vector loop is a copy of the body with the vector operation in place of the statement */
+    UnrollNames names;
+    std::vector<QUAD*> copies;
+    int vi = UnrollTemp(phi.T0, loop);
+    names[phi.T0] = vi;
+    QUAD* at = loop->tail;
+    for (auto ins : ul.body)
+        at = UnrollCopy(ins, at, names, copies);
+    int vnext = names[phi.back->Tn];
+    IMODE* next = tempInfo[vnext]->enode->sp->imvalue;
+    QUAD* q = Allocate<QUAD>();
+    q->dc.opcode = i_phi;
+    q->dc.v.phi = Allocate<PHIDATA>();
+    q->dc.v.phi->T0 = vi;
+    VectorPhiArg(q, start, phi.init->Tn);
+    VectorPhiArg(q, loop, vnext);
+    InsertInstruction(loop->head->fwd, q);
+    for (int i = 0; i < copies.size(); i++)
+    {
+        if (ul.body[i] == increment)
+        {
+            if (copies[i]->dc.right->mode == i_immed)
+                copies[i]->dc.right = make_immed(copies[i]->dc.right->size, width);
+            else
+                copies[i]->dc.left = make_immed(copies[i]->dc.left->size, width);
+        }
+        else if (ul.body[i] == store)
+        {
+            vector->ans = UnrollName(vector->ans, names);
+            vector->dc.left = UnrollName(vector->dc.left, names);
+            vector->dc.right = UnrollName(vector->dc.right, names);
+            InsertInstruction(copies[i], vector);
+            RemoveInstruction(copies[i]);
+            copies[i] = nullptr;
+        }
+    }
+    UnrollRemoveDead(copies);
+    VectorBranch(loop, isSigned ? i_jl : i_jc, next, limit, VectorLabel(loop));
+    VectorEdge(loop, after);
+    VectorEdge(loop, loop);
+
+    /* the original loop runs at least once, so it gets skipped if nothing is left */
+    VectorBranch(after, isSigned ? i_jge : i_jnc, next, bound, exitLabel);
+    VectorEdge(after, head);
+    VectorEdge(after, exit);
+    VectorPhiArg(phi.ins, after, vnext);
+    int which = 0;
+    for (BLOCKLIST* bl = exit->pred; bl->block != (out == exit ? ul.latch : out); bl = bl->next)
+        which++;
+    for (QUAD* p = exit->head; p != exit->tail->fwd; p = p->fwd)
+    {
+        if (p->dc.opcode == i_phi)
+        {
+            struct _phiblock* pb = p->dc.v.phi->temps;
+            for (int i = 0; i < which; i++)
+                pb = pb->next;
+            VectorPhiArg(p, after, chain.count(pb->Tn) ? vnext : pb->Tn);
+        }
+    }
+}
+static bool VectorOne(Loop* lp)
+{
+    UnrollLoop ul;
+    IMODE* bound = nullptr;
+    bool isSigned;
+    if (!UnrollShape(lp, ul) || (!UnrollTrips(ul) && !(bound = VectorBound(ul, isSigned))))
+        return false;
+    std::set<int> chain;
+    QUAD* increment = VectorIncrement(ul, chain);
+    QUAD* store = VectorStore(ul);
+    if (!increment || !store)
+        return false;
+    int elem = store->ans->size;
+    if (!VectorIntSize(elem) && elem != ISZ_FLOAT && elem != ISZ_DOUBLE)
+        return false;
+
+    std::vector<QUAD*> statement;
+    std::vector<VectorAccess> loads;
+    VectorAccess dest;
+    IMODE *left, *right = nullptr;
+    enum i_ops op = i_vassn;
+    statement.push_back(store);
+    if (!VectorAddress(ul, store->ans, elem, dest))
+        return false;
+    left = VectorOperand(ul, store->dc.left, elem, statement, loads);
+    if (!left)
+    {
+        std::vector<QUAD*> path;
+        if (!VectorTemp(store->dc.left))
+            return false;
+        QUAD* q = tempInfo[VectorTrace(store->dc.left->offset->sp->i, &path)]->instructionDefines;
+        if (!VectorInLoop(ul, q) || !VectorSameType(q->ans->size, elem) || (op = VectorOp(q->dc.opcode, elem)) == i_nop)
+            return false;
+        statement.insert(statement.end(), path.begin(), path.end());
+        statement.push_back(q);
+        left = VectorOperand(ul, q->dc.left, elem, statement, loads);
+        right = VectorOperand(ul, q->dc.right, elem, statement, loads);
+        if (!left || !right || (left->mode != i_ind && right->mode != i_ind))
+            return false;
+    }
+    for (auto&& load : loads)
+        if (!VectorDisjoint(dest, load))
+            return false;
+
+    /* the scalar parts of the statement go away, so nothing else may use them */
+    std::set<QUAD*> members(statement.begin(), statement.end());
+    for (auto q : statement)
+        if (q != store && tempInfo[q->ans->offset->sp->i]->instructionUses)
+            for (auto use : *tempInfo[q->ans->offset->sp->i]->instructionUses)
+                if (!members.count(use))
+                    return false;
+    /* whatever is left is address arithmetic and the induction variable, and only the
+     * induction variable may be used after the loop since the other values are only
+     * calculated for the first element of each vector
+     */
+    for (auto q : ul.body)
+    {
+        if (members.count(q))
+            continue;
+        if ((q->dc.left && (q->dc.left->mode == i_ind || q->dc.left->vol)) ||
+            (q->dc.right && (q->dc.right->mode == i_ind || q->dc.right->vol)))
+            return false;
+        if (q->ans && q->ans->mode == i_direct && q->ans->offset->type == se_tempref && !chain.count(q->ans->offset->sp->i) &&
+            tempInfo[q->ans->offset->sp->i]->instructionUses)
+            for (auto use : *tempInfo[q->ans->offset->sp->i]->instructionUses)
+                if (!VectorInLoop(ul, use))
+                    return false;
+    }
+
+    int width = VECTOR_BYTES / sizeFromISZ(elem);
+    int peel = ul.trips % width;
+    if (bound)
+    {
+        /* the value after the loop can come from the vector loop too, but only through a phi node */
+        for (auto t : chain)
+            if (tempInfo[t]->instructionUses)
+                for (auto use : *tempInfo[t]->instructionUses)
+                    if (!VectorInLoop(ul, use) && (use->dc.opcode != i_phi || use->block != VectorExit(ul)))
+                        return false;
+        if (!UnrollCanPeel(ul) || (bound->mode == i_immed && bound->offset->i < width))
+            return false;
+    }
+    else if (ul.trips / width < 2 || (peel && !UnrollCanPeel(ul)))
+    {
+        return false;
+    }
+
+    QUAD* vector = Allocate<QUAD>();
+    vector->dc.opcode = op;
+    vector->ans = store->ans;
+    vector->dc.left = left;
+    vector->dc.right = right;
+    if (bound)
+    {
+        VectorRuntime(ul, bound, isSigned, vector, store, increment, chain, width);
+        return true;
+    }
+    std::vector<QUAD*> copies;
+    if (peel)
+        UnrollPeel(ul, peel, copies);
+    InsertInstruction(store, vector);
+    if (increment->dc.right->mode == i_immed)
+        increment->dc.right = make_immed(increment->dc.right->size, width);
+    else
+        increment->dc.left = make_immed(increment->dc.left->size, width);
+    UnrollRemoveDead(copies);
+    RemoveInstruction(store);
+    UnrollRemoveDead(statement);
+    return true;
+}
+void VectorizeLoops(void)
+{
+    bool changed = false;
+    CalculateInduction();
+    for (int i = 0; i < loopCount; i++)
+        if (loopArray[i] && UnrollInnermost(loopArray[i]) && VectorOne(loopArray[i]))
+            changed = true;
+    UnrollResetInduction(changed);
+}
+}  // namespace Optimizer
@@ -26,9 +26,15 @@
 #include "ctypes.h"
 #include "Utils.h"
 #include <map>
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
 #include "memory.h"
 #ifdef TARGET_OS_WINDOWS
 #    include <Windows.h>
+#elif defined(HAVE_UNISTD_H)
+#    include <sys/mman.h>
 #endif
 
 namespace Parser
@@ -67,6 +73,7 @@ void mem_summary(void)
     printf("\tAlias peak %dK\n", (aliasPeak + 1023) / 1024);
     printf("\tLive peak %dK\n", (livePeak + 1023) / 1024);
     printf("\tConflict peak %dK\n", (conflictPeak + 1023) / 1024);
+    slabSummary();
     globalPeak = localPeak = optPeak = tempsPeak = aliasPeak = livePeak = conflictPeak = 0;
 }
 static MEMBLK* galloc(MEMORY* arena, int size)
@@ -182,4 +189,291 @@ LCHAR* wlitlate(const LCHAR* name)
         rv[count++] = *p++;
     rv[count] = 0;
     return rv;
-}
\ No newline at end of file
+}
+
+/* small blocks for the global operator new of the compiler programs
+ *
+ * there are a lot of small temporary containers, so blocks up to SLAB_MAX bytes are
+ * carved out of SLAB_PAGE sized pages with one size class per page, and freed blocks
+ * are kept for reuse.  Each thread has its own free lists and its own page to carve
+ * from, so new and delete don't take a lock.  slabFlush() gives a thread's free blocks
+ * to a shared depot, where any thread which runs dry can pick them up; a thread should
+ * call it before it goes away.
+ *
+ * Blocks carry the same header the occ runtime library uses, larger blocks and
+ * blocks allocated by LSCRTL.DLL go through malloc and free the way they always have.
+ * Slab blocks are told apart by SLAB_TAG in the size.
+ *
+ * slabTrim() gives pages with nothing in use back to the system, it is meant for
+ * the points between files or functions when only one thread is running.
+ */
+#define SLAB_PAGE (64 * 1024)
+#define SLAB_MAX 1024
+#define SLAB_TAG 0x80000000
+#define SLAB_BATCH 32
+#define SLAB_ALIGN ((int)sizeof(SLABHDR))
+#define SLAB_CLASSES (SLAB_MAX / SLAB_ALIGN + 1)
+#define SLAB_FIRST ((sizeof(SLABPAGE) + SLAB_ALIGN - 1) & -SLAB_ALIGN)
+
+struct SLABHDR
+{
+    unsigned size;
+    SLABHDR* link;
+};
+struct SLABPAGE
+{
+    SLABPAGE* next;
+    SLABPAGE* prev;
+    unsigned blockSize;
+    int carved;   /* blocks handed out from the page so far */
+    int free;     /* used while trimming */
+    bool current; /* some thread is still carving from it */
+};
+struct SLABCACHE
+{
+    SLABHDR* list[SLAB_CLASSES];
+    SLABPAGE* page[SLAB_CLASSES];
+    long long allocs, frees, large;
+};
+static thread_local SLABCACHE slabCache;
+
+static std::mutex slabLock;
+static SLABHDR* slabDepot[SLAB_CLASSES];
+static std::atomic<bool> slabDepotUsed; /* so refills don't lock while nothing was ever flushed */
+static SLABPAGE* slabPages;
+static int slabPageCount, slabPagePeak, slabPagesReleased;
+
+static SLABPAGE* slabPage(SLABHDR* block) { return (SLABPAGE*)((uintptr_t)block & ~(uintptr_t)(SLAB_PAGE - 1)); }
+static void* slabMalloc(size_t size)
+{
+    void* rv;
+    while ((rv = ::malloc(size)) == nullptr)
+    {
+        // If malloc fails and there is a new_handler,
+        // call it to try free up memory.
+#if !defined(__GNUC__) || __GNUC__ > 4
+        std::new_handler nh = std::get_new_handler();
+        if (nh)
+            nh();
+        else
+#endif
+            throw std::bad_alloc();
+    }
+    return rv;
+}
+static SLABPAGE* slabNewPage(unsigned blockSize)
+{
+    void* mem;
+#ifdef TARGET_OS_WINDOWS
+    // allocations are aligned on 64K boundaries
+    mem = VirtualAlloc(nullptr, SLAB_PAGE, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#elif defined(HAVE_UNISTD_H)
+    // map twice the size and unmap what is outside the aligned page, aligned blocks from
+    // the heap leave holes behind them
+    mem = mmap(nullptr, SLAB_PAGE * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED)
+    {
+        mem = nullptr;
+    }
+    else
+    {
+        char* base = (char*)mem;
+        char* aligned = (char*)(((uintptr_t)base + SLAB_PAGE - 1) & ~(uintptr_t)(SLAB_PAGE - 1));
+        if (aligned != base)
+            munmap(base, aligned - base);
+        munmap(aligned + SLAB_PAGE, base + SLAB_PAGE - aligned);
+        mem = aligned;
+    }
+#else
+    if (posix_memalign(&mem, SLAB_PAGE, SLAB_PAGE))
+        mem = nullptr;
+#endif
+    if (!mem)
+        throw std::bad_alloc();
+    SLABPAGE* page = (SLABPAGE*)mem;
+    page->blockSize = blockSize;
+    page->carved = 0;
+    page->free = 0;
+    page->current = true;
+    page->prev = nullptr;
+    std::lock_guard<std::mutex> lock(slabLock);
+    page->next = slabPages;
+    if (slabPages)
+        slabPages->prev = page;
+    slabPages = page;
+    if (++slabPageCount > slabPagePeak)
+        slabPagePeak = slabPageCount;
+    return page;
+}
+static void slabRelease(SLABPAGE* page)
+{
+    if (page->prev)
+        page->prev->next = page->next;
+    else
+        slabPages = page->next;
+    if (page->next)
+        page->next->prev = page->prev;
+    slabPageCount--;
+    slabPagesReleased++;
+#ifdef TARGET_OS_WINDOWS
+    VirtualFree(page, 0, MEM_RELEASE);
+#elif defined(HAVE_UNISTD_H)
+    munmap(page, SLAB_PAGE);
+#else
+    free(page);
+#endif
+}
+static SLABHDR* slabRefill(int cls)
+{
+    SLABCACHE& cache = slabCache;
+    if (slabDepotUsed.load(std::memory_order_relaxed))
+    {
+        // take whatever was flushed to the depot
+        std::lock_guard<std::mutex> lock(slabLock);
+        if (slabDepot[cls])
+        {
+            SLABHDR* rv = slabDepot[cls];
+            slabDepot[cls] = nullptr;
+            cache.list[cls] = rv->link;
+            return rv;
+        }
+    }
+    // else carve a few more blocks out of this thread's page
+    unsigned blockSize = cls * SLAB_ALIGN + sizeof(SLABHDR);
+    int blocks = (SLAB_PAGE - SLAB_FIRST) / blockSize;
+    SLABPAGE* page = cache.page[cls];
+    if (!page || page->carved == blocks)
+    {
+        if (page)
+            page->current = false;
+        page = cache.page[cls] = slabNewPage(blockSize);
+    }
+    int n = blocks - page->carved;
+    if (n > SLAB_BATCH)
+        n = SLAB_BATCH;
+    SLABHDR* rv = (SLABHDR*)((char*)page + SLAB_FIRST + page->carved * blockSize);
+    page->carved += n;
+    SLABHDR* item = rv;
+    for (int i = 1; i < n; i++)
+    {
+        SLABHDR* next = (SLABHDR*)((char*)item + blockSize);
+        item->link = next;
+        item = next;
+    }
+    item->link = nullptr;
+    cache.list[cls] = rv->link;
+    return rv;
+}
+void* slabAlloc(size_t size)
+{
+    SLABCACHE& cache = slabCache;
+    if (!size)
+        size++;
+    if (size <= SLAB_MAX)
+    {
+        int cls = (size + SLAB_ALIGN - 1) / SLAB_ALIGN;
+        SLABHDR* rv = cache.list[cls];
+        if (rv)
+            cache.list[cls] = rv->link;
+        else
+        {
+            rv = slabRefill(cls);
+        }
+        cache.allocs++;
+        rv->size = SLAB_TAG | cls;
+        return (void*)(rv + 1);
+    }
+    SLABHDR* rv = (SLABHDR*)slabMalloc(size + sizeof(SLABHDR));
+    cache.large++;
+    rv->size = size;
+    rv->link = nullptr;
+    return (void*)(rv + 1);
+}
+void slabFree(void* p)
+{
+    if (!p)
+        return;
+    SLABHDR* item = ((SLABHDR*)p) - 1;
+    if (!(item->size & SLAB_TAG))
+    {
+        // this would be buggy if we used aligned allocations and LSCRTL.DLL at the same time
+        // because of the way aligned allocations are handled...
+        free(item);
+        return;
+    }
+    SLABCACHE& cache = slabCache;
+    int cls = item->size & ~SLAB_TAG;
+    item->link = cache.list[cls];
+    cache.list[cls] = item;
+    cache.frees++;
+}
+static void slabFlushLocked(void)
+{
+    SLABCACHE& cache = slabCache;
+    for (int cls = 0; cls < SLAB_CLASSES; cls++)
+    {
+        if (cache.list[cls])
+        {
+            SLABHDR* last = cache.list[cls];
+            while (last->link)
+                last = last->link;
+            last->link = slabDepot[cls];
+            slabDepot[cls] = cache.list[cls];
+            cache.list[cls] = nullptr;
+            slabDepotUsed = true;
+        }
+        if (cache.page[cls])
+        {
+            cache.page[cls]->current = false;
+            cache.page[cls] = nullptr;
+        }
+    }
+}
+void slabFlush(void)
+{
+    std::lock_guard<std::mutex> lock(slabLock);
+    slabFlushLocked();
+}
+void slabTrim(void)
+{
+    std::lock_guard<std::mutex> lock(slabLock);
+    slabFlushLocked();
+    for (SLABPAGE* page = slabPages; page; page = page->next)
+        page->free = 0;
+    for (int cls = 0; cls < SLAB_CLASSES; cls++)
+        for (SLABHDR* item = slabDepot[cls]; item; item = item->link)
+            slabPage(item)->free++;
+    // drop the blocks of pages which are completely free from the depot, then the pages
+    for (int cls = 0; cls < SLAB_CLASSES; cls++)
+    {
+        SLABHDR** item = &slabDepot[cls];
+        while (*item)
+        {
+            SLABPAGE* page = slabPage(*item);
+            if (!page->current && page->free == page->carved)
+            {
+                *item = (*item)->link;
+            }
+            else
+            {
+                item = &(*item)->link;
+            }
+        }
+    }
+    for (SLABPAGE *page = slabPages, *next; page; page = next)
+    {
+        next = page->next;
+        if (!page->current && page->free == page->carved)
+            slabRelease(page);
+    }
+}
+void slabSummary(void)
+{
+    SLABCACHE& cache = slabCache;
+    std::lock_guard<std::mutex> lock(slabLock);
+    printf("Small block allocator:\n");
+    printf("\tAllocations %lld, frees %lld, large %lld\n", cache.allocs, cache.frees, cache.large);
+    printf("\tPages %d, peak %d (%dK), released %d\n", slabPageCount, slabPagePeak, slabPagePeak * (SLAB_PAGE / 1024),
+           slabPagesReleased);
+    cache.allocs = cache.frees = cache.large = 0;
+}
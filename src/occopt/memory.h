@@ -24,6 +24,7 @@
 #pragma once
 
 #include "ctypes.h"
+#include <cstddef>
 #if defined(BORLAND) || defined(__clang__) || defined(__GNUC__)
 // hack for buggy embarcadero compiler
 #    define beLocalAlloc(x) Alloc(x)
@@ -38,6 +39,11 @@ typedef struct _memblk_
     char m[1]; /* memory area */
 } MEMBLK;
 void mem_summary(void);
+void* slabAlloc(size_t size);
+void slabFree(void* p);
+void slabFlush(void);
+void slabTrim(void);
+void slabSummary(void);
 void* globalAlloc(int size);
 void globalFree(void);
 void* localAlloc(int size);
@@ -59,6 +59,9 @@
 #include "ilazy.h"
 #include "iloop.h"
 #include "localprotect.h"
+#include "ilprofile.h"
+#include "iprofile.h"
+#include "itail.h"
 
 //#define x64_compiler
 #ifndef x64_compiler
@@ -68,62 +71,9 @@
 // and this keeps from having the full impact of new/delete any
 // time they are used
 // resulted in about a 20% speedup of the compiler on the worst files
-#define HASHBLKSIZE 128
-
-struct __preheader
-{
-    int size;
-    __preheader* link;
-};
-__preheader* dictionary[HASHBLKSIZE];
-void* operator new(size_t aa)
-{
-    if (!aa)
-        aa++;
-    int bb = (aa + 7) / 8;
-    if (bb < HASHBLKSIZE)
-    {
-        __preheader** x = dictionary + bb;
-        if (*x)
-        {
-            __preheader* rv = *x;
-            *x = rv->link;
-            return (void*)(rv + 1);
-        }
-    }
-    __preheader* rv;
-    while ((rv = (__preheader*)::malloc(bb * 8 + sizeof(__preheader))) == 0)
-    {
-        // If malloc fails and there is a new_handler,
-        // call it to try free up memory.
-#if __GNUC__ > 4
-        std::new_handler nh = std::get_new_handler();
-        if (nh)
-            nh();
-        else
-#endif
-            throw std::bad_alloc();
-    }
-    rv->size = bb;
-    rv->link = nullptr;
-    return (void *)(rv + 1);
-}
-void operator delete(void* p)
-{
-    if (!p)
-        return;
-    __preheader* item = ((__preheader *)p)-1;
-    if (item->size < HASHBLKSIZE)
-    {
-        __preheader** x = dictionary + item->size;
-        item->link = *x;
-        *x = item;
-    }
-    else
-    {
-        free(item);
-    }
-}
+// See slabAlloc in memory.cpp
+void* operator new(size_t aa) { return slabAlloc(aa); }
+void operator delete(void* p) { slabFree(p); }
 
 #endif
 
@@ -300,6 +250,7 @@ void Optimize(SimpleSymbol* funcsp)
     /* Global opts */
 
     flows_and_doms();
+    ProfileFunction();
     gatherLocalInfo(functionVariables);
 
     RunOptimizerModules();
@@ -354,6 +305,7 @@ void Optimize(SimpleSymbol* funcsp)
     {
         RewriteForPinning();
     }
+    ProfileLayout();
     peep_icode(true); /* we do branche opts last to not interfere with other opts */
 }
 
@@ -377,6 +329,7 @@ void ProcessFunction(FunctionData* fd)
     // order is important on these next two, to get the stack initialized properly
     CreateBufferOverflowStubs(intermed_head, intermed_tail);
     CreateUninitializedVariableStubs(intermed_head, intermed_tail);
+    MarkTailCalls(fd);
     tFree();
     oFree();
 }
@@ -412,6 +365,7 @@ void ProcessFunctions()
             v->funcData->fltexp = fltexp;
         }
     }
+    ProfileData();
 }
 bool LoadFile(SharedMemory* parserMem)
 {
@@ -445,6 +399,7 @@ void SaveFile(std::string& name, SharedMemory* optimizerMem)
     InitIntermediate();
     localFree();
     globalFree();
+    slabTrim();
 }
 void ParseParams(CmdFiles& files)
 {
@@ -535,8 +490,9 @@ int main(int argc, char* argv[])
     }
     regInit();
     alloc_init();
-    ProcessFunctions();
     std::string aa = inputFiles.size() ? inputFiles.front() : "";
+    ProfileModule(aa.c_str());
+    ProcessFunctions();
     SaveFile(aa, optimizerMem);
     if (architecture != ARCHITECTURE_MSIL || (cparams.prm_compileonly && !cparams.prm_asmfile))
     {
@@ -548,6 +504,7 @@ int main(int argc, char* argv[])
             {
                 if (!LoadFile(parserMem))
                     Utils::Fatal("internal error: could not load intermediate file");
+                ProfileModule(p.c_str());
                 ProcessFunctions();
                 SaveFile(p, optimizerMem);
             }
@@ -562,6 +519,7 @@ int main(int argc, char* argv[])
         Optimizer::WriteMappingFile(optimizerMem, fil);
         fclose(fil);
     }
+    ProfileStats();
     delete parserMem;
     delete optimizerMem;
     if (Optimizer::cparams.prm_displaytiming || displayTiming.GetValue())
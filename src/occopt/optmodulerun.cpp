@@ -36,6 +36,8 @@
 #include "iflow.h"
 #include "istren.h"
 #include "iinvar.h"
+#include "iunroll.h"
+#include "ivector.h"
 #include "iblock.h"
 #include "ilocal.h"
 #include "irc.h"
@@ -110,6 +112,8 @@ OptimizerModule Modules[]{
     {OptimizePrecolor, nullptr, ~0, 0, false, false},  // Precolor(true);
     {RearrangePrecolors, nullptr, ~0, 0, false, false},
     {SSAIn, nullptr, ~0, 0, false, false},
+    {VectorizeLoops, "Loop vectorization", OPT_VECTORIZE, DO_NOVECTOR, true, false},
+    {UnrollLoops, "Loop unrolling", OPT_UNROLL, DO_NOGCSE, true, false},
     {ConstantFlow, "Constant Optimization", OPT_CONSTANT, DO_NOCONST, false, false},
     {RemoveInfiniteThunks, nullptr, OPT_CONSTANT, 0, false, false},
     ////    { RemoveCriticalThunks, nullptr, OPT_CONSTANT, 0, false, false },
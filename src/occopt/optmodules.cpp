@@ -37,7 +37,8 @@ struct OptimizerParam
 };
 std::vector<OptimizerParam> Params{
     {"reshape", OPT_RESHAPE},           {"constant", OPT_CONSTANT}, {"loop-strength", OPT_LSTRENGTH},
-    {"move-invariants", OPT_INVARIANT}, {"gcse", OPT_GCSE},
+    {"move-invariants", OPT_INVARIANT}, {"gcse", OPT_GCSE},         {"unroll", OPT_UNROLL},
+    {"vectorize", OPT_VECTORIZE},       {"tail-calls", OPT_TAILCALL},
 };
 
 std::vector<OptimizerParam> IcdParams{
@@ -89,6 +90,17 @@ std::string ParseOptimizerParams(std::string in)
     {
         bool working = false;
         bool icd = false;
+        if (a.substr(0, 16) == "profile-generate" || a.substr(0, 11) == "profile-use")
+        {
+            auto n = a.find('=');
+            if (n != std::string::npos)
+                Optimizer::prm_profileFile = a.substr(n + 1);
+            if (a[8] == 'g')
+                Optimizer::cparams.prm_profilegen = true;
+            else
+                Optimizer::cparams.prm_profileuse = true;
+            continue;
+        }
         if (a.substr(0, 4) == "opt-")
             working = true;
         else if (a.substr(0, 4) == "icd-")
@@ -30,6 +30,9 @@
 #define OPT_GCSE 4
 #define OPT_CONSTANT 8
 #define OPT_INVARIANT 0x10
+#define OPT_UNROLL 0x20
+#define OPT_VECTORIZE 0x40
+#define OPT_TAILCALL 0x80
 
 #define ICD_QUITEARLY 0x80000000
 #define ICD_OCP (1 | ICD_QUITEARLY)
@@ -46,7 +49,12 @@
     "  -fopt-{no}constant             turn on or off constant optimizations\n"          \
     "  -fopt-{no}loop-strength        turn on or off loop strength optimization\n"      \
     "  -fopt-{no}move-invariants      turn on or off loop invariant code motion\n"      \
+    "  -fopt-{no}unroll               turn on or off loop unrolling\n"                  \
+    "  -fopt-{no}vectorize            turn on or off loop vectorization\n"              \
+    "  -fopt-{no}tail-calls           turn on or off tail call optimization\n"         \
     "  -fopt-{no}gcse                 turn on or off global subexpression evaluation\n" \
+    "  -fprofile-generate{=file}      count block executions into a profile\n"          \
+    "  -fprofile-use{=file}           optimize using the counts in a profile\n"         \
     "  -ficd-{no}gcse                 turn on or off gcse diagnostics in the icd file\n"
 
 #define OPTIMIZATION_DESCRIPTION                               \
@@ -101,6 +101,8 @@ public:
     SymbolTable<T>* ReleaseNext() { SymbolTable<T>* rv = next_; if (next_) next_ = next_->next_; return rv; }
     int Block() const { return blockLevel_; }
     void Block(int level) { blockLevel_ = level; }
+    // changes whenever a symbol is added or removed, for validating cached lookups
+    unsigned Generation() const { return generation_; }
 
     inline void Add(T* sym);
     inline T* AddOverloadName(T* sym);
@@ -112,6 +114,7 @@ private:
     std::list<T*> inOrder_;
     std::unordered_map<std::string, T*, StringHash> lookupTable_;
     int blockLevel_;
+    unsigned generation_ = 0;
     SymbolTable<T>* next_ = nullptr;
     SymbolTable<T>* chain_ = nullptr;
 };
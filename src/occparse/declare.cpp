@@ -1039,6 +1039,8 @@ static LexList* structbody(LexList* lex, SYMBOL* funcsp, SYMBOL* sp, AccessLevel
             }
             warnCPPWarnings(sp, funcsp != nullptr);
         }
+        libcxx_class_complete();
+        overload_class_complete();
     }
     else
     {
@@ -50,6 +50,8 @@
 #include "symtab.h"
 #include "types.h"
 #include "constopt.h"
+#include "ilprofile.h"
+#include <unordered_map>
 #include <unordered_set>
 
 namespace Parser
@@ -60,10 +62,21 @@ std::vector<EXPRESSION*> inlineSymThisPtr;
 #undef MAX_INLINE_NESTING
 #define MAX_INLINE_NESTING 3
 
+/* the inliner measures functions in expression nodes, roughly one per instruction */
+#define INLINE_CALL_COST 5        /* size of a call, which inlining saves */
+#define INLINE_COST_LIMIT 30      /* size of the biggest function inlined at the top level */
+#define INLINE_CONST_BONUS 4      /* discount for each constant argument */
+#define INLINE_ACCESSOR_COST 8    /* member functions this small are always worth it */
+#define INLINE_GROWTH_BASE 150    /* growth allowed in each function, plus half its size */
+#define INLINE_NEVER 1000000      /* size of things that are never inlined */
+
 static std::unordered_set<SYMBOL*> inlineSymList;
 static int inlineNesting;
 static std::unordered_set<Optimizer::SimpleSymbol*> argTable;
 static Optimizer::SimpleSymbol* argCurrentFunction;
+static std::unordered_map<SYMBOL*, int> inlineCosts;
+static Optimizer::SimpleSymbol* growthFunction;
+static int inlineGrowth, inlineBudget;
 
 void iinlineInit(void)
 {
@@ -73,6 +86,8 @@ void iinlineInit(void)
     inlineSymStructPtr.clear();
     inlineSymThisPtr.clear();
     argTable.clear();
+    inlineCosts.clear();
+    growthFunction = nullptr;
 }
 static bool hasRelativeThis(EXPRESSION* thisPtr)
 {
@@ -463,7 +478,149 @@ static void inlineCopySyms(SymbolTable<SYMBOL>* src)
         src = src->Next();
     }
 }
-static bool inlineTooComplex(CallSite* f) { return f->sp->sb->endLine - f->sp->sb->startLine > 15 / (inlineNesting * 2 + 1); }
+static int inlineCost(std::list<Statement*>* stmts);
+static int inlineCost(EXPRESSION* exp)
+{
+    if (!exp)
+        return 0;
+    switch (exp->type)
+    {
+        case ExpressionNode::callsite_: {
+            CallSite* f = exp->v.func;
+            int rv = INLINE_CALL_COST + inlineCost(f->thisptr);
+            if (f->arguments)
+                for (auto arg : *f->arguments)
+                    rv += 1 + inlineCost(arg->exp);
+            return rv;
+        }
+        case ExpressionNode::stmt_:
+            return inlineCost(exp->v.stmt);
+        case ExpressionNode::div_:
+        case ExpressionNode::udiv_:
+        case ExpressionNode::mod_:
+        case ExpressionNode::umod_:
+            return 3 + inlineCost(exp->left) + inlineCost(exp->right);
+        default:
+            if (!exp->left && !exp->right)
+                return 0;
+            return 1 + inlineCost(exp->left) + inlineCost(exp->right);
+    }
+}
+static int inlineCost(std::list<Statement*>* stmts)
+{
+    int rv = 0;
+    if (stmts)
+    {
+        for (auto st : *stmts)
+        {
+            switch (st->type)
+            {
+                case StatementNode::expr_:
+                case StatementNode::return_:
+                    rv += inlineCost(st->select) + inlineCost(st->destexp);
+                    break;
+                case StatementNode::select_:
+                case StatementNode::notselect_:
+                    rv += 1 + inlineCost(st->select);
+                    break;
+                case StatementNode::goto_:
+                case StatementNode::loopgoto_:
+                    rv++;
+                    break;
+                case StatementNode::switch_:
+                    rv += 2 + inlineCost(st->select) + (st->cases ? st->cases->size() : 0);
+                    break;
+                case StatementNode::block_:
+                    rv += inlineCost(st->lower) + inlineCost(st->blockTail);
+                    break;
+                case StatementNode::indgoto_:
+                case StatementNode::asmgoto_:
+                case StatementNode::asmcond_:
+                case StatementNode::genword_:
+                case StatementNode::passthrough_:
+                case StatementNode::datapassthrough_:
+                case StatementNode::throw_:
+                case StatementNode::try_:
+                case StatementNode::catch_:
+                case StatementNode::seh_try_:
+                case StatementNode::seh_catch_:
+                case StatementNode::seh_finally_:
+                case StatementNode::seh_fault_:
+                    return INLINE_NEVER;
+                default:
+                    break;
+            }
+            if (rv >= INLINE_NEVER)
+                return INLINE_NEVER;
+        }
+    }
+    return rv;
+}
+static int inlineFunctionCost(SYMBOL* sym)
+{
+    auto it = inlineCosts.find(sym);
+    if (it != inlineCosts.end())
+        return it->second;
+    return inlineCosts[sym] = inlineCost(sym->sb->inlineFunc.stmt);
+}
+/* each function may grow by a fixed amount plus half its own size */
+static void inlineStartGrowth(SYMBOL* funcsp)
+{
+    if (currentFunction != growthFunction)
+    {
+        growthFunction = currentFunction;
+        inlineGrowth = 0;
+        inlineBudget = INLINE_GROWTH_BASE;
+        if (funcsp->sb->inlineFunc.stmt)
+        {
+            int cost = inlineFunctionCost(funcsp);
+            if (cost < INLINE_NEVER)
+                inlineBudget += cost / 2;
+        }
+    }
+}
+/* decide whether a call is worth inlining: the size of the function less what the
+ * call itself would cost has to fit both under a limit for the function and in what
+ * is left of the caller's budget.  Constant arguments which will fold away and
+ * accessor functions get a better deal, and with a
+ * profile functions which never ran aren't inlined and hot ones may be bigger.
+ */
+static bool inlineTooComplex(CallSite* f, int& growth)
+{
+    int cost = inlineFunctionCost(f->sp);
+    int limit = INLINE_COST_LIMIT;
+    const char* reason = nullptr;
+    if (f->arguments)
+        for (auto arg : *f->arguments)
+            if (arg->exp && (isarithmeticconst(arg->exp) || isconstaddress(arg->exp)))
+                cost -= INLINE_CONST_BONUS;
+    if (f->thisptr && cost <= INLINE_ACCESSOR_COST)
+        cost = 0;
+    switch (Optimizer::ProfileHeat(f->sp->sb->decoratedName, f->sp->sb->storage_class == StorageClass::static_))
+    {
+        case Optimizer::heat_cold:
+            reason = "never called in the profile";
+            break;
+        case Optimizer::heat_hot:
+            limit *= 4;
+            break;
+        default:
+            break;
+    }
+    limit /= inlineNesting * 2 + 1;
+    growth = cost > INLINE_CALL_COST ? cost - INLINE_CALL_COST : 0;
+    if (!reason)
+    {
+        if (cost > limit)
+            reason = "too big";
+        else if (inlineGrowth + growth > inlineBudget)
+            reason = "caller has grown too much";
+    }
+    if (Optimizer::cparams.verbosity >= 3)
+        printf("Inline %s in %s: cost %d limit %d growth %d of %d: %s\n", f->sp->sb->decoratedName,
+               currentFunction->name, cost, limit, inlineGrowth + growth, inlineBudget, reason ? reason : "ok");
+    return reason != nullptr;
+}
 static bool hasaincdec(EXPRESSION* exp)
 {
     if (exp)
@@ -505,11 +662,6 @@ Optimizer::IMODE* gen_inline(SYMBOL* funcsp, EXPRESSION* node, int flags)
     {
         return nullptr;
     }
-    /* measure of complexity */
-    if (!f->sp->sb->simpleFunc && (inlineTooComplex(f) || (funcsp->sb->endLine - funcsp->sb->startLine > 400)))
-    {
-        return nullptr;
-    }
     if (f->fcall->type != ExpressionNode::pc_)
     {
         return nullptr;
@@ -554,6 +706,13 @@ Optimizer::IMODE* gen_inline(SYMBOL* funcsp, EXPRESSION* node, int flags)
     {
         return nullptr;
     }
+    /* measure of complexity */
+    int growth = 0;
+    inlineStartGrowth(funcsp);
+    if (!f->sp->sb->simpleFunc && inlineTooComplex(f, growth))
+    {
+        return nullptr;
+    }
     if (f->thisptr)
     {
         if (f->thisptr->type == ExpressionNode::auto_ && f->thisptr->v.sp->sb->stackblock)
@@ -616,6 +775,7 @@ Optimizer::IMODE* gen_inline(SYMBOL* funcsp, EXPRESSION* node, int flags)
     {
         return nullptr;
     }
+    inlineGrowth += growth;
     if (currentFunction != argCurrentFunction)
     {
         argTable.clear();
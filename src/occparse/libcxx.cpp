@@ -51,6 +51,7 @@
 namespace Parser
 {
 int inNoExceptHandler;
+int traitCacheHits;
 
 
 typedef bool INTRINS_FUNC(EXPRESSION* exp);
@@ -114,11 +115,21 @@ static std::unordered_map<std::string, INTRINS_FUNC*> intrinsicHash {
     {"__is_union", is_union},
 };
 static std::unordered_map<std::string, std::unordered_map<unsigned, SYMBOL*>, StringHash> integerSequences;
+// results of the intrinsics above, keyed by intrinsic name and the argument types
+static std::unordered_map<std::string, bool> traitCache;
 
 void libcxx_init(void)
 {
     int i;
     integerSequences.clear();
+    traitCache.clear();
+    traitCacheHits = 0;
+}
+void libcxx_class_complete(void)
+{
+    // a trait on some other type may depend on this class through a conversion or a base,
+    // so anything cached so far may be stale
+    traitCache.clear();
 }
 void libcxx_builtins(void)
 {
@@ -334,7 +345,32 @@ void EvaluateLibcxxConstant(EXPRESSION** exp)
     auto it = intrinsicHash.find((*exp)->v.cppintrinsicName);
     if (it != intrinsicHash.end())
     {
+        std::list<Argument*>* arguments = nullptr;
+        GetTypeList(*exp, &arguments);
+        std::string key = it->first;
+        bool cacheable = true;
+        for (auto arg : *arguments)
+        {
+            if (!arg->tp->CanonicalKey(key))
+            {
+                cacheable = false;
+                break;
+            }
+        }
+        if (cacheable)
+        {
+            auto itc = traitCache.find(key);
+            if (itc != traitCache.end())
+            {
+                traitCacheHits++;
+                (**exp).type = ExpressionNode::c_i_;
+                (**exp).v.i = itc->second;
+                return;
+            }
+        }
         auto rv = (it->second)(*exp);
+        if (cacheable)
+            traitCache[key] = rv;
         (**exp).type = ExpressionNode::c_i_;
         (**exp).v.i = rv;
 //        *exp = MakeIntExpression(ExpressionNode::c_i_, rv);
@@ -26,7 +26,9 @@
 namespace Parser
 {
 extern int inNoExceptHandler;
+extern int traitCacheHits;
 void libcxx_init(void);
+void libcxx_class_complete(void);
 void libcxx_builtins(void);
 bool parseBuiltInTypelistFunc(LexList** lex, SYMBOL* funcsp, SYMBOL* sym, Type** tp, EXPRESSION** exp);
 void EvaluateLibcxxConstant(EXPRESSION** exp);
@@ -24,6 +24,7 @@
  */
 
 #include <unordered_set>
+#include <algorithm>
 #include "compiler.h"
 #include <stack>
 #include "ccerr.h"
@@ -64,6 +65,40 @@ namespace Parser
     SymbolTable<SYMBOL>* labelSyms;
     std::list<NAMESPACEVALUEDATA*>* globalNameSpace, * localNameSpace, * rootNameSpace;
 
+// what a namespace search depended on, gathered while the search runs
+struct NamespaceLookupTrace
+{
+    std::vector<NAMESPACEVALUEDATA*> namespaces;
+    // visited flags read before the search itself set them, and the final value of every flag it set
+    std::vector<std::pair<SYMBOL*, bool>> reads;
+    std::vector<std::pair<SYMBOL*, bool>> writes;
+};
+struct NamespaceLookupDependency
+{
+    NAMESPACEVALUEDATA* ns;
+    SymbolTable<SYMBOL>* syms;
+    SymbolTable<SYMBOL>* tags;
+    unsigned symsGeneration;
+    unsigned tagsGeneration;
+    std::list<SYMBOL*>* usingDirectives;
+    std::list<SYMBOL*>* inlineDirectives;
+    size_t usingCount;
+    size_t inlineCount;
+};
+struct NamespaceLookup
+{
+    // false until the lookup has been seen twice without anything it depends on changing; tracing a
+    // search costs more than the search itself, so one-off lookups are only remembered by key
+    bool traced = false;
+    unsigned hits = 0;
+    std::vector<NamespaceLookupDependency> dependencies;
+    std::vector<std::pair<SYMBOL*, bool>> reads;
+    std::vector<std::pair<SYMBOL*, bool>> writes;
+    std::vector<SYMBOL*> result;
+};
+static NamespaceLookupTrace* lookupTrace;
+static std::unordered_map<std::string, NamespaceLookup> lookupCache;
+
 
 void namespaceinit()
 {
@@ -80,14 +115,48 @@ void namespaceinit()
     localNameSpace->push_front(Allocate<NAMESPACEVALUEDATA>());
 
     matchOverloadLevel = 0;
+    lookupCache.clear();
+}
+static void TraceNamespace(NAMESPACEVALUEDATA* ns)
+{
+    if (lookupTrace)
+        lookupTrace->namespaces.push_back(ns);
+}
+static bool IsVisited(SYMBOL* sym)
+{
+    if (lookupTrace)
+    {
+        auto match = [sym](const std::pair<SYMBOL*, bool>& a) { return a.first == sym; };
+        if (std::find_if(lookupTrace->writes.begin(), lookupTrace->writes.end(), match) == lookupTrace->writes.end() &&
+            std::find_if(lookupTrace->reads.begin(), lookupTrace->reads.end(), match) == lookupTrace->reads.end())
+            lookupTrace->reads.push_back(std::pair<SYMBOL*, bool>(sym, !!sym->sb->visited));
+    }
+    return sym->sb->visited;
+}
+static void SetVisited(SYMBOL* sym, bool visited)
+{
+    sym->sb->visited = visited;
+    if (lookupTrace)
+    {
+        for (auto&& a : lookupTrace->writes)
+        {
+            if (a.first == sym)
+            {
+                a.second = visited;
+                return;
+            }
+        }
+        lookupTrace->writes.push_back(std::pair<SYMBOL*, bool>(sym, visited));
+    }
 }
 void unvisitUsingDirectives(NAMESPACEVALUEDATA* v)
 {
+    TraceNamespace(v);
     if (v->usingDirectives)
     {
         for (auto sym : *v->usingDirectives)
         {
-            sym->sb->visited = false;
+            SetVisited(sym, false);
             unvisitUsingDirectives(sym->sb->nameSpaceValues->front());
         }
     }
@@ -95,7 +164,7 @@ void unvisitUsingDirectives(NAMESPACEVALUEDATA* v)
     {
         for (auto sym : *v->inlineDirectives)
         {
-            sym->sb->visited = false;
+            SetVisited(sym, false);
             unvisitUsingDirectives(sym->sb->nameSpaceValues->front());
         }
     }
@@ -120,6 +189,7 @@ std::list<SYMBOL*> tablesearchinline(const char* name, NAMESPACEVALUEDATA* ns, b
 {
     // main namespace
     std::list<SYMBOL*> rv;
+    TraceNamespace(ns);
     SYMBOL* find = tablesearchone(name, ns, tagsOnly);
     if (find)
         rv.insert(rv.begin(), find);
@@ -128,9 +198,9 @@ std::list<SYMBOL*> tablesearchinline(const char* name, NAMESPACEVALUEDATA* ns, b
     {
         for (auto x : *ns->inlineDirectives)
         {
-            if (!x->sb->visited)
+            if (!IsVisited(x))
             {
-                x->sb->visited = true;
+                SetVisited(x, true);
                 auto rv1 = tablesearchinline(name, x->sb->nameSpaceValues->front(), tagsOnly, allowUsing);
                 if (rv1.size())
                 {
@@ -144,18 +214,17 @@ std::list<SYMBOL*> tablesearchinline(const char* name, NAMESPACEVALUEDATA* ns, b
     {
         for (auto x : *ns->usingDirectives)
         {
-            if (!x->sb->visited)
+            if (!IsVisited(x))
             {
-                x->sb->visited = true;
+                SetVisited(x, true);
                 namespacesearchone(name, x->sb->nameSpaceValues->front(), rv, tagsOnly, allowUsing);
             }
         }
     }
     // enclosing ns if this one is inline
-    if (ns->name && !ns->name->sb->visited &&
-        ns->name->sb->attribs.inheritable.linkage == Linkage::inline_)
+    if (ns->name && ns->name->sb->attribs.inheritable.linkage == Linkage::inline_ && !IsVisited(ns->name))
     {
-        ns->name->sb->visited = true;
+        SetVisited(ns->name, true);
         auto rv1 = tablesearchinline(name, ns->name->sb->nameSpaceValues->front(), tagsOnly, allowUsing);
         if (rv1.size())
         {
@@ -167,6 +236,7 @@ std::list<SYMBOL*> tablesearchinline(const char* name, NAMESPACEVALUEDATA* ns, b
 static void namespacesearchone(const char* name, NAMESPACEVALUEDATA* ns, std::list<SYMBOL*>& gather, bool tagsOnly,
                                            bool allowUsing)
 {
+    TraceNamespace(ns);
     auto rv = tablesearchinline(name, ns, tagsOnly, allowUsing);
     if (rv.size())
     {
@@ -180,18 +250,85 @@ static void namespacesearchone(const char* name, NAMESPACEVALUEDATA* ns, std::li
     {
         for (auto x : *ns->usingDirectives)
         {
-            if (!x->sb->visited)
+            if (!IsVisited(x))
             {
-                x->sb->visited = true;
+                SetVisited(x, true);
                 namespacesearchone(name, x->sb->nameSpaceValues->front(), rv, tagsOnly, allowUsing);
             }
         }
     }
     gather = rv;
 }
-static std::list<SYMBOL*> namespacesearchInternal(const char* name, std::list<NAMESPACEVALUEDATA*>* ns, bool qualified, bool tagsOnly,
-                                                bool allowUsing)
+static bool ValidLookup(const NamespaceLookup& lookup)
 {
+    for (auto&& d : lookup.dependencies)
+    {
+        if (d.ns->syms != d.syms || d.ns->tags != d.tags || d.ns->usingDirectives != d.usingDirectives ||
+            d.ns->inlineDirectives != d.inlineDirectives)
+            return false;
+        if ((d.syms && d.syms->Generation() != d.symsGeneration) || (d.tags && d.tags->Generation() != d.tagsGeneration))
+            return false;
+        if ((d.usingDirectives && d.usingDirectives->size() != d.usingCount) ||
+            (d.inlineDirectives && d.inlineDirectives->size() != d.inlineCount))
+            return false;
+    }
+    for (auto&& r : lookup.reads)
+        if (r.first->sb->visited != r.second)
+            return false;
+    return true;
+}
+// unqualified and qualified lookups are cached by name and namespace list once they repeat; an entry stays
+// good until one of the namespaces it searched gets a new symbol or directive.   Block scopes come and go too
+// quickly to be worth caching.  The result is copied out because callers can search again, and rehash the cache,
+// while they are still walking it.
+static std::vector<SYMBOL*> namespacesearchInternal(const char* name, std::list<NAMESPACEVALUEDATA*>* ns, bool qualified,
+                                                    bool tagsOnly, bool allowUsing)
+{
+    std::string key;
+    bool cacheable = false;
+    // a search which doesn't go through any directives is no more than a table lookup per namespace
+    if (ns != localNameSpace)
+        for (auto ns1 : *ns)
+            if (ns1->usingDirectives || ns1->inlineDirectives ||
+                (ns1->name && ns1->name->sb->attribs.inheritable.linkage == Linkage::inline_))
+            {
+                cacheable = true;
+                break;
+            }
+    if (cacheable)
+    {
+        key = name;
+        key += '\0';
+        key += (char)(qualified | (tagsOnly << 1) | (allowUsing << 2));
+        for (auto ns1 : *ns)
+            key.append((const char*)&ns1, sizeof(ns1));
+        auto it = lookupCache.find(key);
+        if (it == lookupCache.end())
+        {
+            lookupCache.emplace(key, NamespaceLookup());
+            cacheable = false;
+        }
+        else if (it->second.traced)
+        {
+            if (ValidLookup(it->second))
+            {
+                it->second.hits++;
+                for (auto&& w : it->second.writes)
+                    w.first->sb->visited = w.second;
+                return it->second.result;
+            }
+            // a namespace which is still filling up can outdate an entry before it is ever used, in which
+            // case wait for the lookup to come round again before tracing it
+            if (!it->second.hits)
+            {
+                it->second = NamespaceLookup();
+                cacheable = false;
+            }
+        }
+    }
+    NamespaceLookupTrace trace;
+    if (cacheable)
+        lookupTrace = &trace;
     std::list<SYMBOL*> lst;
 
     for (auto ns1 : *ns )
@@ -201,7 +338,38 @@ static std::list<SYMBOL*> namespacesearchInternal(const char* name, std::list<NA
         if (qualified || lst.size())
             break;
     }
-    return lst;
+    lookupTrace = nullptr;
+    if (cacheable)
+    {
+        std::unordered_set<NAMESPACEVALUEDATA*> seen;
+        NamespaceLookup lookup;
+        for (auto v : trace.namespaces)
+        {
+            if (seen.insert(v).second)
+            {
+                if ((v->syms && v->syms->Next()) || (v->tags && v->tags->Next()))
+                {
+                    cacheable = false;
+                    break;
+                }
+                lookup.dependencies.push_back({v, v->syms, v->tags, v->syms ? v->syms->Generation() : 0,
+                                               v->tags ? v->tags->Generation() : 0, v->usingDirectives, v->inlineDirectives,
+                                               v->usingDirectives ? v->usingDirectives->size() : 0,
+                                               v->inlineDirectives ? v->inlineDirectives->size() : 0});
+            }
+        }
+        if (cacheable)
+        {
+            lookup.traced = true;
+            lookup.reads = std::move(trace.reads);
+            lookup.writes = std::move(trace.writes);
+            lookup.result.assign(lst.begin(), lst.end());
+            auto& entry = lookupCache[key];
+            entry = std::move(lookup);
+            return entry.result;
+        }
+    }
+    return std::vector<SYMBOL*>(lst.begin(), lst.end());
 }
 SYMBOL* namespacesearch(const char* name, std::list<NAMESPACEVALUEDATA*>* ns, bool qualified, bool tagsOnly)
 {
@@ -59,6 +59,7 @@
 #include "memory.h"
 #include "mangle.h"
 #include "libcxx.h"
+#include "overload.h"
 #include "lex.h"
 #include "lambda.h"
 #include "inline.h"
@@ -70,6 +71,7 @@
 #include "expr.h"
 #include "constopt.h"
 #include "browse.h"
+#include "ilprofile.h"
 #include "ilstream.h"
 #include "OptUtils.h"
 #include "istmt.h"
@@ -97,70 +99,12 @@
 // and this keeps from having the full impact of new/delete any
 // time they are used
 // resulted in about a 20% speedup of the compiler on the worst files
-
-#define HASHBLKSIZE 128 * 8
-
-// this structure is similar to the one used by the occ runtime library
-// so for example we can cache things that were allocated by LSCRTL.DLL
-// just as easily
-struct __preheader
-{
-    unsigned size;
-    __preheader* link;
-};
-__preheader* dictionary[HASHBLKSIZE];
-void* operator new(size_t aa)
-{
-    if (!aa)
-        aa++;
-    unsigned bb = (aa + 7) / 8;
-    if (aa < HASHBLKSIZE)
-    {
-        __preheader** x = dictionary + bb;
-        if (*x)
-        {
-            __preheader* rv = *x;
-            *x = rv->link;
-            return (void*)(rv + 1);
-        }
-    }
-    __preheader* rv;
-    while ((rv = (__preheader*)::malloc(bb * 8 + sizeof(__preheader))) == 0)
-    {
-        // If malloc fails and there is a new_handler,
-        // call it to try free up memory.
-
-#if !defined(__GNUC__) || __GNUC__ > 4
-        std::new_handler nh = std::get_new_handler();
-        if (nh)
-            nh();
-        else
-#endif
-            throw std::bad_alloc();
-    }
-    rv->size = aa;
-    rv->link = nullptr;
-    return (void *)(rv + 1);
-}
-void operator delete(void* p)
-{
-    if (!p)
-        return;
-    __preheader* item = ((__preheader *)p)-1;
-    if (item->size < HASHBLKSIZE)
-    {
-        unsigned bb = (item->size + 7) / 8;
-        __preheader** x = dictionary + bb;
-        item->link = *x;
-        *x = item;
-    }
-    else
-    {
-        // this would be buggy if we used aligned allocations and LSCRTL.DLL at the same time
-        // because of the way aligned allocations are handled...
-        free(item);
-    }
-}
+//
+// the blocks have a header similar to the one used by the occ runtime library
+// so for example we can free things that were allocated by LSCRTL.DLL
+// just as easily.  See slabAlloc in occopt/memory.cpp
+void* operator new(size_t aa) { return slabAlloc(aa); }
+void operator delete(void* p) { slabFree(p); }
 
 #endif
 #endif
@@ -379,6 +323,7 @@ void compile(bool global)
     rtti_init();
     expr_init();
     libcxx_init();
+    overload_init();
     statement_ini(global);
     lexini();
     setglbdefs();
@@ -719,6 +664,7 @@ int main(int argc, char* argv[])
             if (multipleFiles && !Optimizer::cparams.prm_quiet)
                 printf("%s\n", (char*)clist->data);
 
+            Optimizer::ProfileModule((char*)clist->data);
             compile(false);
             if (IsCompiler())
             {
@@ -801,6 +747,7 @@ int main(int argc, char* argv[])
         }
         if (Optimizer::architecture != ARCHITECTURE_MSIL || (Optimizer::cparams.prm_compileonly && !Optimizer::cparams.prm_asmfile))
             globalFree();
+        slabTrim();
         if (Optimizer::cparams.prm_diag)
         {
             mem_summary();
@@ -808,6 +755,7 @@ int main(int argc, char* argv[])
             printf("  Block peak:          %d\n", maxBlocks);
 
             printf("  Temp peak:           %d\n", maxTemps);
+            printf("  Trait cache hits:    %d\n", traitCacheHits);
         }
         maxBlocks = maxTemps = 0;
 
@@ -73,6 +73,25 @@ static bool getFuncConversions(SYMBOL* sym, CallSite* f, Type* atp, SYMBOL* pare
                                SYMBOL** userFunc, bool usesInitList, bool deduceTemplate);
 static void WeedTemplates(SYMBOL** table, int count, CallSite* args, Type* atp);
 
+struct OverloadResolution
+{
+    std::vector<unsigned> generations;
+    SYMBOL* found1;
+    SYMBOL* found2;
+};
+// results of choosing among non-template candidates, keyed by the candidate set and the arguments
+static std::unordered_map<std::string, OverloadResolution> overloadCache;
+
+void overload_init(void)
+{
+    overloadCache.clear();
+}
+void overload_class_complete(void)
+{
+    // a conversion to or from the new class may change which candidate is best
+    overloadCache.clear();
+}
+
 /* SYMBOL tab Keyword::hash_ function */
 static int GetHashValue(const char* string)
 {
@@ -4478,6 +4497,131 @@ SYMBOL* ClassTemplateArgumentDeduction(Type** tp, EXPRESSION** exp, SYMBOL* sp,
     }
     return deduced;
 }
+// the parts of an argument expression that the conversion rules look at, for the simple
+// expressions where the rest of the conversion only depends on the type
+static bool OverloadArgKey(std::string& key, Type* tp, EXPRESSION* exp)
+{
+    if (!tp || !exp || !tp->CanonicalKey(key))
+        return false;
+    key.push_back((char)exp->type);
+    switch (exp->type)
+    {
+        case ExpressionNode::auto_:
+        case ExpressionNode::global_:
+        case ExpressionNode::threadlocal_:
+            return true;
+        case ExpressionNode::c_u16_:
+        case ExpressionNode::c_u32_:
+        case ExpressionNode::c_c_:
+        case ExpressionNode::c_wc_:
+        case ExpressionNode::c_uc_:
+        case ExpressionNode::c_s_:
+        case ExpressionNode::c_us_:
+        case ExpressionNode::c_i_:
+        case ExpressionNode::c_ui_:
+        case ExpressionNode::c_l_:
+        case ExpressionNode::c_ul_:
+        case ExpressionNode::c_ll_:
+        case ExpressionNode::c_ull_:
+        case ExpressionNode::c_bool_:
+            key.append((const char*)&exp->v.i, sizeof(exp->v.i));
+            return true;
+        case ExpressionNode::thisref_:
+            exp = exp->left;
+            if (exp->type != ExpressionNode::callsite_)
+                return false;
+            /* fallthrough */
+        case ExpressionNode::callsite_: {
+            // the result of a call is classified by what was called and how the return value is passed
+            CallSite* func = exp->v.func;
+            if (!func->sp || !func->sp->sb)
+                return false;
+            bool isfunc = func->sp->tp->IsFunction();
+            key.push_back((char)((func->sp->tp->BaseType()->type == BasicType::aggregate_) | (isfunc << 1) |
+                                 (func->sp->sb->isConstructor << 2) | (func->sp->sb->isDestructor << 3) | (func->ascall << 4) |
+                                 (func->astemplate << 5) | (!!func->returnSP << 6) |
+                                 ((func->returnSP && func->returnSP->sb->anonymous) << 7)));
+            if (isfunc && !func->sp->tp->BaseType()->btp->CanonicalKey(key))
+                return false;
+            if (func->functp)
+            {
+                Type* tp = func->functp->BaseType()->btp;
+                key.push_back((char)(tp ? tp->BaseType()->type : BasicType::none_));
+            }
+            return true;
+        }
+        case ExpressionNode::l_bool_:
+        case ExpressionNode::l_c_:
+        case ExpressionNode::l_uc_:
+        case ExpressionNode::l_u16_:
+        case ExpressionNode::l_u32_:
+        case ExpressionNode::l_wc_:
+        case ExpressionNode::l_s_:
+        case ExpressionNode::l_us_:
+        case ExpressionNode::l_i_:
+        case ExpressionNode::l_ui_:
+        case ExpressionNode::l_inative_:
+        case ExpressionNode::l_unative_:
+        case ExpressionNode::l_l_:
+        case ExpressionNode::l_ul_:
+        case ExpressionNode::l_ll_:
+        case ExpressionNode::l_ull_:
+        case ExpressionNode::l_f_:
+        case ExpressionNode::l_d_:
+        case ExpressionNode::l_ld_:
+        case ExpressionNode::l_p_:
+            switch (exp->left->type)
+            {
+                case ExpressionNode::auto_:
+                case ExpressionNode::global_:
+                case ExpressionNode::threadlocal_:
+                    key.push_back((char)exp->left->type);
+                    return true;
+                default:
+                    return false;
+            }
+        default:
+            return false;
+    }
+}
+// a call can use the cache when all the candidates are plain functions and all the arguments are simple
+static bool OverloadKey(std::string& key, SYMBOL* sp, std::list<SYMBOL*>& gather, CallSite* args, Type* atp, int flags)
+{
+    if (!args || atp || !args->ascall || args->astemplate || args->templateParams || (definingTemplate && !instantiatingTemplate))
+        return false;
+    key.append((const char*)&sp, sizeof(sp));
+    key.append((const char*)&flags, sizeof(flags));
+    for (auto sym1 : gather)
+    {
+        for (auto sym : *sym1->tp->syms)
+            if (sym->sb->templateLevel || sym->templateParams)
+                return false;
+        key.append((const char*)&sym1, sizeof(sym1));
+    }
+    key.push_back(0);
+    if (args->thisptr && !OverloadArgKey(key, args->thistp, args->thisptr))
+        return false;
+    key.push_back(0);
+    if (args->arguments)
+    {
+        for (auto arg : *args->arguments)
+        {
+            if (arg->nested || arg->initializer_list || arg->packed || arg->vararg || arg->valist ||
+                !OverloadArgKey(key, arg->tp, arg->exp))
+                return false;
+            key.push_back(0);
+        }
+    }
+    return true;
+}
+static bool ValidResolution(OverloadResolution& resolution, std::list<SYMBOL*>& gather)
+{
+    int i = 0;
+    for (auto sym1 : gather)
+        if (sym1->tp->syms->Generation() != resolution.generations[i++])
+            return false;
+    return true;
+}
 SYMBOL* GetOverloadedFunction(Type** tp, EXPRESSION** exp, SYMBOL* sp, CallSite* args, Type* atp, int toErr,
                               bool maybeConversion, int flags)
 {
@@ -4679,64 +4823,34 @@ SYMBOL* GetOverloadedFunction(Type** tp, EXPRESSION** exp, SYMBOL* sp, CallSite*
                     enclosingDeclarations.Release();
                     return nullptr;
                 }
-                spList.resize(n);
-                icsList.resize(n);
-                lenList.resize(n);
-                funcList.resize(n);
-                n = insertFuncs(&spList[0], gather, args, atp, flags);
-                if (n != 1 || (spList[0] && !spList[0]->sb->isDestructor && !spList[0]->sb->specialized2))
+                std::string key;
+                bool cacheable = OverloadKey(key, sp, gather, args, atp, flags);
+                auto itc = cacheable ? overloadCache.find(key) : overloadCache.end();
+                if (itc != overloadCache.end() && ValidResolution(itc->second, gather))
                 {
-                    bool hasDest = false;
-                    
-                    std::unordered_map<int, SYMBOL*> storage;
-                    if (atp || args->ascall)
-                        GatherConversions(sp, &spList[0], n, args, atp, &icsList[0], &lenList[0], argCount, &funcList[0],
-                                          flags & _F_INITLIST, false);
-                    for (int i = 0; i < n; i++)
-                    {
-                        storage[i] = spList[i];
-                        hasDest |= spList[i] && spList[i]->sb->deleted;
-                    }
-                    if (atp || args->ascall)
-                        SelectBestFunc(&spList[0], &icsList[0], &lenList[0], args, argCount, n, &funcList[0]);
-                    WeedTemplates(&spList[0], n, args, atp);
-                    for (i = 0; i < n && !found1; i++)
-                    {
-                        if (spList[i] && !spList[i]->sb->deleted && !spList[i]->sb->castoperator)
-                           found1 = spList[i];
-                    }
-                    for (i = 0; i < n && !found1; i++)
-                    {
-                        if (spList[i] && !spList[i]->sb->deleted)
-                            found1 = spList[i];
-                    }
-                    for (i = 0; i < n; i++)
+                    found1 = itc->second.found1;
+                    found2 = itc->second.found2;
+                }
+                else
+                {
+                    spList.resize(n);
+                    icsList.resize(n);
+                    lenList.resize(n);
+                    funcList.resize(n);
+                    n = insertFuncs(&spList[0], gather, args, atp, flags);
+                    if (n != 1 || (spList[0] && !spList[0]->sb->isDestructor && !spList[0]->sb->specialized2))
                     {
-                        int j;
-                        if (!found1)
-                            found1 = spList[i];
-                        for (j = i; j < n && found1; j++)
+                        bool hasDest = false;
+                    
+                        std::unordered_map<int, SYMBOL*> storage;
+                        if (atp || args->ascall)
+                            GatherConversions(sp, &spList[0], n, args, atp, &icsList[0], &lenList[0], argCount, &funcList[0],
+                                              flags & _F_INITLIST, false);
+                        for (int i = 0; i < n; i++)
                         {
-                            if (spList[j] && found1 != spList[j] && found1->sb->castoperator == spList[j]->sb->castoperator && !SameTemplate(found1->tp, spList[j]->tp))
-                            {
-                                found2 = spList[j];
-                            }
+                            storage[i] = spList[i];
+                            hasDest |= spList[i] && spList[i]->sb->deleted;
                         }
-                        if (found1)
-                            break;
-                    }
-                    if ((!found1 || (!IsMove(found1) && found1->sb->deleted)) && hasDest)
-                    {
-                        auto found3 = found1;
-                        auto found4 = found2;
-                        // there were no matches.   But there are deleted functions
-                        // see if we can find a match among them...
-                        found1 = found2 = 0;
-                        for (auto v : storage)
-                            if (!v.second || !v.second->sb->deleted)
-                                spList[v.first] = v.second;
-                            else
-                                spList[v.first] = nullptr;
                         if (atp || args->ascall)
                             SelectBestFunc(&spList[0], &icsList[0], &lenList[0], args, argCount, n, &funcList[0]);
                         WeedTemplates(&spList[0], n, args, atp);
@@ -4748,16 +4862,16 @@ SYMBOL* GetOverloadedFunction(Type** tp, EXPRESSION** exp, SYMBOL* sp, CallSite*
                         for (i = 0; i < n && !found1; i++)
                         {
                             if (spList[i] && !spList[i]->sb->deleted)
-                               found1 = spList[i];
+                                found1 = spList[i];
                         }
                         for (i = 0; i < n; i++)
                         {
                             int j;
                             if (!found1)
                                 found1 = spList[i];
-                            for (j = i; j < n && found1 && !found2; j++)
+                            for (j = i; j < n && found1; j++)
                             {
-                            if (spList[j] && found1 != spList[j] && found1->sb->castoperator == spList[j]->sb->castoperator && !SameTemplate(found1->tp, spList[j]->tp))
+                                if (spList[j] && found1 != spList[j] && found1->sb->castoperator == spList[j]->sb->castoperator && !SameTemplate(found1->tp, spList[j]->tp))
                                 {
                                     found2 = spList[j];
                                 }
@@ -4765,33 +4879,83 @@ SYMBOL* GetOverloadedFunction(Type** tp, EXPRESSION** exp, SYMBOL* sp, CallSite*
                             if (found1)
                                 break;
                         }
-                        if (!found1)
+                        if ((!found1 || (!IsMove(found1) && found1->sb->deleted)) && hasDest)
                         {
-                            found1 = found3;
-                            found2 = found4;
+                            auto found3 = found1;
+                            auto found4 = found2;
+                            // there were no matches.   But there are deleted functions
+                            // see if we can find a match among them...
+                            found1 = found2 = 0;
+                            for (auto v : storage)
+                                if (!v.second || !v.second->sb->deleted)
+                                    spList[v.first] = v.second;
+                                else
+                                    spList[v.first] = nullptr;
+                            if (atp || args->ascall)
+                                SelectBestFunc(&spList[0], &icsList[0], &lenList[0], args, argCount, n, &funcList[0]);
+                            WeedTemplates(&spList[0], n, args, atp);
+                            for (i = 0; i < n && !found1; i++)
+                            {
+                                if (spList[i] && !spList[i]->sb->deleted && !spList[i]->sb->castoperator)
+                                   found1 = spList[i];
+                            }
+                            for (i = 0; i < n && !found1; i++)
+                            {
+                                if (spList[i] && !spList[i]->sb->deleted)
+                                   found1 = spList[i];
+                            }
+                            for (i = 0; i < n; i++)
+                            {
+                                int j;
+                                if (!found1)
+                                    found1 = spList[i];
+                                for (j = i; j < n && found1 && !found2; j++)
+                                {
+                                if (spList[j] && found1 != spList[j] && found1->sb->castoperator == spList[j]->sb->castoperator && !SameTemplate(found1->tp, spList[j]->tp))
+                                    {
+                                        found2 = spList[j];
+                                    }
+                                }
+                                if (found1)
+                                    break;
+                            }
+                            if (!found1)
+                            {
+                                found1 = found3;
+                                found2 = found4;
+                            }
                         }
-                    }
-                    if (found1 && found2 && !found1->sb->deleted && found2->sb->deleted)
-                        found2 = nullptr;
+                        if (found1 && found2 && !found1->sb->deleted && found2->sb->deleted)
+                            found2 = nullptr;
 #if !NDEBUG
-                    // this block to aid in debugging unfound functions...
-                    if ((toErr & F_GOFERR) && !inDeduceArgs && (!found1 || (found1 && found2)) && !definingTemplate)
-                    {
-
-                        n = insertFuncs(&spList[0], gather, args, atp, flags);
-                        if (atp || args->ascall)
+                        // this block to aid in debugging unfound functions...
+                        if ((toErr & F_GOFERR) && !inDeduceArgs && (!found1 || (found1 && found2)) && !definingTemplate)
                         {
-                            GatherConversions(sp, &spList[0], n, args, atp, &icsList[0], &lenList[0], argCount, &funcList[0],
-                                              flags & _F_INITLIST, false);
-                            SelectBestFunc(&spList[0], &icsList[0], &lenList[0], args, argCount, n, &funcList[0]);
+
+                            n = insertFuncs(&spList[0], gather, args, atp, flags);
+                            if (atp || args->ascall)
+                            {
+                                GatherConversions(sp, &spList[0], n, args, atp, &icsList[0], &lenList[0], argCount, &funcList[0],
+                                                  flags & _F_INITLIST, false);
+                                SelectBestFunc(&spList[0], &icsList[0], &lenList[0], args, argCount, n, &funcList[0]);
+                            }
+                            WeedTemplates(&spList[0], n, args, atp);
                         }
-                        WeedTemplates(&spList[0], n, args, atp);
-                    }
 #endif
-                }
-                else
-                {
-                    found1 = spList[0];
+                    }
+                    else
+                    {
+                        found1 = spList[0];
+                    }
+                    if (cacheable)
+                    {
+                        auto& resolution = overloadCache[key];
+                        resolution.generations.clear();
+                        for (auto sym1 : gather)
+                            resolution.generations.push_back(sym1->tp->syms->Generation());
+                        resolution.found1 = found1;
+                        resolution.found2 = found2;
+                    }
                 }
             }
             else
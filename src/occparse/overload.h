@@ -40,6 +40,8 @@ extern int matchOverloadLevel;
 #define F_GOFERR 1
 #define F_GOFDELETEDERR 2
 
+void overload_init(void);
+void overload_class_complete(void);
 bool matchOverload(Type* tnew, Type* told, bool argsOnly);
 SYMBOL* searchOverloads(SYMBOL* sym, SymbolTable<SYMBOL>* table);
 SYMBOL* lookupGenericConversion(SYMBOL* sym, Type* tp);
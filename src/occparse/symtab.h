@@ -73,18 +73,21 @@ inline SYMBOL* SymbolTable<SYMBOL>::AddOverloadName(SYMBOL* sym)
 template<class T>
 void SymbolTable<T>::remove(typename SymbolTable<T>::iterator it)
 {
+    generation_++;
     lookupTable_.erase((*it)->name);
     return inOrder_.remove(*it);
 }
 template<class T>
 inline void SymbolTable<T>::remove(T* sym)
 {
+    generation_++;
     lookupTable_.erase(sym->name);
     inOrder_.remove(sym);
 }
 template<class T>
 typename SymbolTable<T>::iterator SymbolTable<T>::insert(typename SymbolTable<T>::iterator it, SYMBOL* sym)
 {
+    generation_++;
     lookupTable_[sym->name] = sym;
     return inOrder_.insert(it, sym);
 }
@@ -112,6 +115,7 @@ T* search(const SymbolTable<T>* tbl, const std::string& name)
 template <class T>
 inline void SymbolTable<T>::AddName(T* sym)
 {
+    generation_++;
     inOrder_.push_back(sym);
     lookupTable_[sym->name] = sym;
 }
@@ -1032,6 +1032,85 @@ bool Type::SameIntegerType(Type* t2)
     }
     return t1->type == t2->type;
 }
+static void KeyAppend(std::string& key, int val)
+{
+    key.append((const char*)&val, sizeof(val));
+}
+static bool KeyAppendPointer(std::string& key, void* val)
+{
+    key.append((const char*)&val, sizeof(val));
+    return true;
+}
+// appends an encoding of the type which is the same for all copies of the type.   Returns false if the type is
+// dependent or names a class which isn't complete yet, since anything computed from such a type may change
+bool Type::CanonicalKey(std::string& key)
+{
+    Type* tp = this;
+    while (tp)
+    {
+        while (tp->type == BasicType::typedef_)
+            tp = tp->btp;
+        KeyAppend(key, (int)tp->type);
+        KeyAppend(key, tp->array | (tp->vla << 1) | (tp->lref << 2) | (tp->rref << 3) | (tp->nullptrType << 4));
+        switch (tp->type)
+        {
+            case BasicType::struct_:
+            case BasicType::class_:
+            case BasicType::union_: {
+                SYMBOL* sym = tp->sp;
+                if (sym->sb->mainsym)
+                    sym = sym->sb->mainsym;
+                if (!sym->tp->syms || sym->sb->declaring || (sym->sb->templateLevel && !sym->sb->instantiated))
+                    return false;
+                return KeyAppendPointer(key, sym);
+            }
+            case BasicType::enum_: {
+                SYMBOL* sym = tp->sp;
+                // the constants of an enumeration being declared see it before it is named, and its size may still change
+                if (!sym)
+                    return false;
+                if (sym->sb->mainsym)
+                    sym = sym->sb->mainsym;
+                return KeyAppendPointer(key, sym);
+            }
+            case BasicType::memberptr_: {
+                SYMBOL* sym = tp->sp;
+                if (sym->sb->mainsym)
+                    sym = sym->sb->mainsym;
+                KeyAppendPointer(key, sym);
+                break;
+            }
+            case BasicType::func_:
+            case BasicType::ifunc_:
+                KeyAppend(key, tp->syms->size());
+                for (auto sym : *tp->syms)
+                    if (!sym->tp->CanonicalKey(key))
+                        return false;
+                break;
+            case BasicType::pointer_:
+                if (tp->array)
+                    KeyAppend(key, tp->size);
+                break;
+            case BasicType::bitint_:
+            case BasicType::unsigned_bitint_:
+                KeyAppend(key, tp->bitintbits);
+                break;
+            case BasicType::any_:
+            case BasicType::auto_:
+            case BasicType::templateparam_:
+            case BasicType::templateselector_:
+            case BasicType::templatedecltype_:
+            case BasicType::templatedeferredtype_:
+            case BasicType::derivedfromtemplate_:
+            case BasicType::templateholder_:
+                return false;
+            default:
+                break;
+        }
+        tp = tp->btp;
+    }
+    return true;
+}
 bool Type::SameCharType(Type* typ2)
 {
     Type* typ1 = this;
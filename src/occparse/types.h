@@ -117,6 +117,7 @@ struct Type
     Type* CopyType(bool deep = false, std::function<void(Type*&, Type*&)> callback = nullptr);
     bool IsConstWithArr();
     bool SameIntegerType(Type* t2);
+    bool CanonicalKey(std::string& key);
     Type* InitializerListType();
     bool InstantiateDeferred(bool noErr= false);
     Type* InitializeDeferred();
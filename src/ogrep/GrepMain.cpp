@@ -32,11 +32,23 @@
 #include <iomanip>
 #include <iostream>
 #include <algorithm>
+#include <sstream>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #ifdef HAVE_UNISTD_H
 #    include <unistd.h>
 #else
 #    include <io.h>
 #endif
+#ifndef TARGET_OS_WINDOWS
+#    include <dirent.h>
+#    include <fnmatch.h>
+#    include <sys/stat.h>
+#endif
 CmdSwitchParser GrepMain::SwitchParser;
 CmdSwitchBool GrepMain::recurseDirs(SwitchParser, 'd');
 CmdSwitchBool GrepMain::caseInSensitive(SwitchParser, 'i', false);
@@ -56,6 +68,7 @@ CmdSwitchInt GrepMain::showBefore(SwitchParser, 'B', 0, 0, INT_MAX);
 CmdSwitchInt GrepMain::showBoth(SwitchParser, 'C', 0, 0, INT_MAX);
 CmdSwitchInt GrepMain::maxMatches(SwitchParser, 'm', INT_MAX, 0, INT_MAX);
 CmdSwitchBool GrepMain::quiet(SwitchParser, 'q');
+CmdSwitchInt GrepMain::threads(SwitchParser, 'j', INT_MAX, 1, INT_MAX);
 
 const char* GrepMain::usageText = "[options] searchstring file[s]";
 const char* GrepMain::helpText =
@@ -68,6 +81,7 @@ const char* GrepMain::helpText =
     "   -w             Complete Words Only        -z   Verbose\n"
     "   -A:#           Show Lines After           -B:# Show Lines Before\n"
     "   -C:#           Show Lines Both            -m:# Set Max Matches\n"
+    "   -j:#           Search with # threads\n"
     "   -V, --version  Show version and date      -? or --help  This help\n"
     "\n"
     "Regular expressions special characters:\n"
@@ -125,7 +139,8 @@ void GrepMain::SetModes(void)
         displayHeaderFileName.SetValue(true);
     }
 }
-void GrepMain::DisplayMatch(const std::string& fileName, int& matchCount, int lineno, const char* startpos, const char* text)
+void GrepMain::DisplayMatch(std::ostream& out, const std::string& fileName, int& matchCount, int lineno, const char* startpos,
+                            const char* text)
 {
     if (quiet.GetValue())
     {
@@ -133,9 +148,9 @@ void GrepMain::DisplayMatch(const std::string& fileName, int& matchCount, int li
     }
     if (matchCount == 0 && displayHeaderFileName.GetValue())
     {
-        std::cout << "FILE: " << fileName;
+        out << "FILE: " << fileName;
         if (verboseMode.GetValue() || !displayMatchCount.GetValue())
-            std::cout << std::endl;
+            out << std::endl;
     }
     if (!displayFileNamesOnly.GetValue())
     {
@@ -146,7 +161,7 @@ void GrepMain::DisplayMatch(const std::string& fileName, int& matchCount, int li
         if (!q)
             q = p + strlen(p);
         if (showBefore.GetValue() || showAfter.GetValue())
-            std::cout << "--" << std::endl;
+            out << "--" << std::endl;
         for (int i = 0; i < showBefore.GetValue() + 1 && p > startpos;)
         {
             if (p[-1] == '\n')
@@ -170,24 +185,24 @@ void GrepMain::DisplayMatch(const std::string& fileName, int& matchCount, int li
             {
                 int n = fileName.size();
                 n = ((n + 8) / 8) * 8;
-                std::cout << std::setfill(' ') << std::setw(n) << std::left << fileName;
+                out << std::setfill(' ') << std::setw(n) << std::left << fileName;
             }
             if (displayLineNumbers.GetValue())
             {
-                std::cout << std::setfill(' ') << std::setw(8) << std::left << lineno++;
+                out << std::setfill(' ') << std::setw(8) << std::left << lineno++;
             }
             std::string buf(p + 1, s - p - 1);
-            std::cout << buf;
+            out << buf;
 
             p = s;
-            std::cout << std::endl;
+            out << std::endl;
         }
     }
     matchCount++;
-    std::cout.clear();
+    out.clear();
 }
-void GrepMain::FindLine(const std::string fileName, int& matchCount, int& matchLine, char** matchPos, char* startpos, char* curpos,
-                        bool matched)
+void GrepMain::FindLine(std::ostream& out, const std::string fileName, int& matchCount, int& matchLine, char** matchPos,
+                        char* startpos, char* curpos, bool matched)
 {
     char* p = *matchPos;
     do
@@ -199,7 +214,7 @@ void GrepMain::FindLine(const std::string fileName, int& matchCount, int& matchL
         {
             if (displayNonMatching.GetValue())
             {
-                DisplayMatch(fileName, matchCount, matchLine, startpos, p);
+                DisplayMatch(out, fileName, matchCount, matchLine, startpos, p);
             }
             if (*p)
             {
@@ -210,7 +225,7 @@ void GrepMain::FindLine(const std::string fileName, int& matchCount, int& matchL
     } while (p < curpos);
     if (matched && !displayNonMatching.GetValue())
     {
-        DisplayMatch(fileName, matchCount, matchLine, startpos, curpos);
+        DisplayMatch(out, fileName, matchCount, matchLine, startpos, curpos);
     }
     if (*p)
     {
@@ -219,15 +234,26 @@ void GrepMain::FindLine(const std::string fileName, int& matchCount, int& matchL
     }
     *matchPos = p;
 }
-int GrepMain::OneFile(RegExpContext& regexp, const std::string fileName, std::istream& fil, int& openCount)
+int GrepMain::OneFile(RegExpContext& regexp, const std::string fileName, std::istream& fil, int& openCount, std::ostream& out)
 {
     openCount++;
-    // couldn't do this as a straight definition as MSVC decided to treat it as a func
-    std::unique_ptr<std::string> str =
-        std::make_unique<std::string>(std::istreambuf_iterator<char>(fil), std::istreambuf_iterator<char>());
-    str->erase(std::remove(str->begin(), str->end(), '\r'), str->end());
-    std::string bufs = " " + *str;
-    bufs[0] = 0;
+    // read the file straight into the buffer the matcher runs over.   It needs a nul
+    // in front of the text, and carriage returns are squeezed out in place
+    std::string bufs(1, 0);
+    fil.seekg(0, std::ios::end);
+    std::streamoff size = fil.tellg();
+    if (size > 0 && fil.seekg(0, std::ios::beg))
+    {
+        bufs.resize(size + 1);
+        fil.read(&bufs[1], size);
+        bufs.resize(fil.gcount() + 1);
+    }
+    else
+    {
+        fil.clear();
+        bufs.append(std::istreambuf_iterator<char>(fil), std::istreambuf_iterator<char>());
+    }
+    bufs.erase(std::remove(bufs.begin() + 1, bufs.end(), '\r'), bufs.end());
     int matchCount = 0;
     int lineno = 0;
     int length = bufs.size() - 1;
@@ -245,12 +271,12 @@ int GrepMain::OneFile(RegExpContext& regexp, const std::string fileName, std::is
             matched = regexp.Match(str - buf, length, buf);
             if (matched)
             {
-                FindLine(fileName, matchCount, matchLine, &matchPos, start, buf + regexp.GetStart(), true);
+                FindLine(out, fileName, matchCount, matchLine, &matchPos, start, buf + regexp.GetStart(), true);
                 p = (char*)strchr((char*)buf + regexp.GetEnd(), '\n');
             }
             else
             {
-                FindLine(fileName, matchCount, matchLine, &matchPos, start, str + strlen(str), false);
+                FindLine(out, fileName, matchCount, matchLine, &matchPos, start, str + strlen(str), false);
             }
             if (!p)
                 p = str + strlen(str);
@@ -262,25 +288,203 @@ int GrepMain::OneFile(RegExpContext& regexp, const std::string fileName, std::is
         {
             if (displayNonMatching.GetValue())
             {
-                std::cout << matchCount << " Non-matching lines" << std::endl;
+                out << matchCount << " Non-matching lines" << std::endl;
             }
             else
             {
-                std::cout << matchCount << " Matching lines" << std::endl;
+                out << matchCount << " Matching lines" << std::endl;
             }
         }
         else if (matchCount && displayMatchCount.GetValue() && !quiet.GetValue())
         {
-            std::cout << ": " << matchCount << std::endl;
+            out << ": " << matchCount << std::endl;
+        }
+    }
+    return matchCount;
+}
+// list one directory: the files matching the mask, and the subdirectories (with a trailing separator)
+void GrepMain::ListDirectory(const std::string& path, const std::string& mask, std::vector<std::string>& files,
+                             std::vector<std::string>& dirs)
+{
+#ifdef TARGET_OS_WINDOWS
+    struct _finddata_t find;
+    intptr_t handle;
+    std::string q = path + mask;
+    if ((handle = _findfirst(q.c_str(), &find)) != -1)
+    {
+        do
+        {
+            if (!(find.attrib & (_A_SUBDIR | _A_HIDDEN)))
+                files.push_back(path + find.name);
+        } while (_findnext(handle, &find) != -1);
+        _findclose(handle);
+    }
+    q = path + "*.*";
+    if ((handle = _findfirst(q.c_str(), &find)) != -1)
+    {
+        do
+        {
+            if ((find.attrib & _A_SUBDIR) && strcmp(find.name, ".") && strcmp(find.name, ".."))
+                dirs.push_back(path + find.name + CmdFiles::DIR_SEP);
+        } while (_findnext(handle, &find) != -1);
+        _findclose(handle);
+    }
+#else
+    DIR* dir = opendir(path.empty() ? "." : path.c_str());
+    if (dir)
+    {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr)
+        {
+            // skips hidden files as well as . and ..
+            if (entry->d_name[0] == '.')
+                continue;
+            std::string name = path + entry->d_name;
+            struct stat st;
+            if (lstat(name.c_str(), &st) != 0)
+                continue;
+            if (S_ISDIR(st.st_mode))
+                dirs.push_back(name + CmdFiles::DIR_SEP);
+            else if (!fnmatch(mask.c_str(), entry->d_name, 0))
+            {
+                // links are followed for files but not for directories, so the walk can't loop
+                if (S_ISLNK(st.st_mode) && stat(name.c_str(), &st) != 0)
+                    continue;
+                if (S_ISREG(st.st_mode))
+                    files.push_back(name);
+            }
+        }
+        closedir(dir);
+    }
+#endif
+    std::sort(files.begin(), files.end());
+    std::sort(dirs.begin(), dirs.end());
+}
+// find the files matching a mask in a directory and all its subdirectories.   Directories are
+// listed by a pool of threads sharing a queue; the results are kept in a tree so that the final
+// order is the same as a sequential walk: the files in a directory followed by those in each
+// subdirectory in turn.
+void GrepMain::WalkDirectories(const std::string& name, int threadCount, std::vector<std::string>& names)
+{
+    struct Directory
+    {
+        Directory(const std::string& Path) : path(Path) {}
+        std::string path;
+        std::vector<std::string> files;
+        std::vector<std::unique_ptr<Directory>> children;
+    };
+    size_t n = name.find_last_of(CmdFiles::DIR_SEP[0]);
+    size_t n1 = name.find_last_of('/');
+    if (n == std::string::npos || (n1 != std::string::npos && n1 > n))
+        n = n1;
+    Directory root(n == std::string::npos ? "" : name.substr(0, n + 1));
+    std::string mask = n == std::string::npos ? name : name.substr(n + 1);
+
+    std::deque<Directory*> queue;
+    queue.push_back(&root);
+    int pending = 1;
+    std::mutex mutex;
+    std::condition_variable cv;
+    auto worker = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;)
+        {
+            cv.wait(lock, [&]() { return !queue.empty() || !pending; });
+            if (queue.empty())
+                break;
+            Directory* dir = queue.front();
+            queue.pop_front();
+            lock.unlock();
+            std::vector<std::string> subdirs;
+            ListDirectory(dir->path, mask, dir->files, subdirs);
+            for (auto&& s : subdirs)
+                dir->children.push_back(std::make_unique<Directory>(s));
+            lock.lock();
+            for (auto&& c : dir->children)
+                queue.push_back(c.get());
+            pending += dir->children.size();
+            pending--;
+            cv.notify_all();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threadCount; i++)
+        pool.push_back(std::thread(worker));
+    worker();
+    for (auto&& t : pool)
+        t.join();
+
+    std::function<void(Directory*)> gather = [&](Directory* dir) {
+        names.insert(names.end(), dir->files.begin(), dir->files.end());
+        for (auto&& c : dir->children)
+            gather(c.get());
+    };
+    gather(&root);
+}
+// search files on a pool of threads, each with its own matcher.   Each file's output is collected
+// in a buffer and written out in file order, so the output doesn't depend on the scheduling
+int GrepMain::SearchFiles(const char* expression, const std::vector<std::string>& names, int threadCount, int& openCount)
+{
+    struct Result
+    {
+        bool done = false;
+        int matchCount = 0;
+        int openCount = 0;
+        std::string text;
+    };
+    std::vector<Result> results(names.size());
+    std::atomic<size_t> next(0);
+    // the word character table is static, fill it in before the threads start
+    RegExpMatch::Init(!caseInSensitive.GetValue());
+    std::mutex mutex;
+    std::condition_variable cv;
+    auto worker = [&]() {
+        RegExpContext regexp(expression, regularExpressions.GetValue(), !caseInSensitive.GetValue(), completeWords.GetValue());
+        size_t i;
+        while ((i = next++) < names.size())
+        {
+            std::ostringstream out;
+            int opened = 0;
+            int matches = 0;
+            std::fstream fil(names[i], std::ios::in | std::ios::binary);
+            if (fil.is_open())
+                matches = OneFile(regexp, names[i], fil, opened, out);
+            std::lock_guard<std::mutex> lock(mutex);
+            results[i].matchCount = matches;
+            results[i].openCount = opened;
+            results[i].text = out.str();
+            results[i].done = true;
+            cv.notify_all();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threadCount; i++)
+        pool.push_back(std::thread(worker));
+    int matchCount = 0;
+    for (auto&& result : results)
+    {
+        std::string text;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return result.done; });
+            text = std::move(result.text);
         }
+        std::cout << text;
+        matchCount += result.matchCount;
+        openCount += result.openCount;
     }
+    std::cout.flush();
+    for (auto&& t : pool)
+        t.join();
     return matchCount;
 }
 int GrepMain::Run(int argc, char** argv)
 {
-    auto files = ToolChain::StandardToolStartup(SwitchParser, argc, argv, usageText, helpText, [this]() {
-        return !verboseMode.GetValue();
-    });
+    // with -d the masks are matched in each directory the walk reaches, so they are left
+    // alone here even when nothing matches in the current directory
+    auto files = ToolChain::StandardToolStartup(
+        SwitchParser, argc, argv, usageText, helpText, [this]() { return !verboseMode.GetValue(); },
+        [this]() { return recurseDirs.GetValue(); });
 
     if (showBoth.GetExists())
     {
@@ -301,20 +505,46 @@ int GrepMain::Run(int argc, char** argv)
         return 2;
     }
 
+    int threadCount = 1;
+    if (threads.GetExists())
+    {
+        threadCount = threads.GetValue();
+        if (threadCount == INT_MAX)
+            threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+    }
     int openCount = 0;
     int matchCount = 0;
     if (!isatty(fileno(stdin)))
     {
-        matchCount += OneFile(regexp, "STDIN", std::cin, openCount);
+        matchCount += OneFile(regexp, "STDIN", std::cin, openCount, std::cout);
     }
     else
-        for (int i = 1; i < files.size(); i++)
+    {
+        std::vector<std::string> names;
+        if (recurseDirs.GetValue())
         {
-            std::string name = files[i];
-            std::fstream fil(name, std::ios::in | std::ios::binary);
-            if (fil.is_open())
-                matchCount += OneFile(regexp, name, fil, openCount);
+            for (int i = 1; i < files.size(); i++)
+                WalkDirectories(files[i], threadCount, names);
         }
+        else
+        {
+            for (int i = 1; i < files.size(); i++)
+                names.push_back(files[i]);
+        }
+        if (threadCount > 1 && names.size() > 1)
+        {
+            matchCount += SearchFiles(argv[1], names, threadCount, openCount);
+        }
+        else
+        {
+            for (auto&& name : names)
+            {
+                std::fstream fil(name, std::ios::in | std::ios::binary);
+                if (fil.is_open())
+                    matchCount += OneFile(regexp, name, fil, openCount, std::cout);
+            }
+        }
+    }
     if (openCount == 0)
     {
         if (!quiet.GetValue())
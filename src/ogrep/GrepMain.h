@@ -27,16 +27,24 @@
 #define GREPMAIN_H
 #include "RegExp.h"
 #include "CmdSwitch.h"
+#include <iostream>
+#include <string>
+#include <vector>
 
 class GrepMain
 {
   public:
     int Run(int argc, char** argv);
     void SetModes();
-    void DisplayMatch(const std::string& fileName, int& matchCount, int lineno, const char* startpos, const char* text);
-    void FindLine(const std::string fileName, int& matchCount, int& matchLine, char** matchPos, char* startpos, char* curpos,
-                  bool matched);
-    int OneFile(RegExpContext& regexp, const std::string fileName, std::istream& file, int& openCount);
+    void DisplayMatch(std::ostream& out, const std::string& fileName, int& matchCount, int lineno, const char* startpos,
+                      const char* text);
+    void FindLine(std::ostream& out, const std::string fileName, int& matchCount, int& matchLine, char** matchPos, char* startpos,
+                  char* curpos, bool matched);
+    int OneFile(RegExpContext& regexp, const std::string fileName, std::istream& file, int& openCount, std::ostream& out);
+    void ListDirectory(const std::string& path, const std::string& mask, std::vector<std::string>& files,
+                       std::vector<std::string>& dirs);
+    void WalkDirectories(const std::string& name, int threadCount, std::vector<std::string>& names);
+    int SearchFiles(const char* expression, const std::vector<std::string>& names, int threadCount, int& openCount);
 
   private:
     static CmdSwitchParser SwitchParser;
@@ -54,6 +62,7 @@ class GrepMain
     static CmdSwitchInt showBefore;
     static CmdSwitchInt showBoth;
     static CmdSwitchInt maxMatches;
+    static CmdSwitchInt threads;
     // not actual parameters
     static CmdSwitchBool displayFileNames;
     static CmdSwitchBool displayHeaderFileName;
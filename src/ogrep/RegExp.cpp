@@ -224,7 +224,8 @@ int RegExpMatch::MatchOne(RegExpContext& context, const char* str)
 {
     if (MatchRange(context, str))
         return 0;
-    if (*str && IsSet(*str))
+    // the bits above 127 hold the flags, so characters there never match a set
+    if (*str && (UBYTE)*str < 128 && IsSet((UBYTE)*str))
         return 1;
     if (IsSet(M_MATCH))
     {
@@ -318,6 +319,65 @@ int RegExpMatch::MatchOne(RegExpContext& context, const char* str)
     }
     return -1;
 }
+// returns the number of characters this item consumes when it matches:
+// zero for anchors and word boundaries, one for a plain character set,
+// and -1 when it can't be known in advance
+int RegExpMatch::GetWidth() const
+{
+    if (HasInterval())
+        return -1;
+    bool chars = false;
+    for (int i = 0; i < 128 / 8; i++)
+        if (matches[i])
+            chars = true;
+    for (int i = 128; i < 256; i++)
+    {
+        if (IsSet(i))
+        {
+            if (chars)
+                return -1;
+            switch (i)
+            {
+                case RE_M_WORD:
+                case RE_M_IWORD:
+                case RE_M_BWORD:
+                case RE_M_EWORD:
+                case RE_M_BBUFFER:
+                case RE_M_EBUFFER:
+                case RE_M_SOL:
+                case RE_M_EOL:
+                case M_START:
+                case M_END:
+                    break;
+                default:
+                    return -1;
+            }
+        }
+    }
+    return chars ? 1 : 0;
+}
+// returns the character matched if this item matches exactly one character
+// (or one letter in either case), else -1.   Letters are returned in lower case
+int RegExpMatch::GetLiteral() const
+{
+    if (GetWidth() != 1)
+        return -1;
+    int first = -1, count = 0;
+    for (int i = 0; i < 128; i++)
+    {
+        if (IsSet(i))
+        {
+            if (first < 0)
+                first = i;
+            count++;
+        }
+    }
+    if (count == 1)
+        return tolower(first);
+    if (count == 2 && isupper(first) && IsSet(tolower(first)))
+        return tolower(first);
+    return -1;
+}
 int RegExpMatch::Matches(RegExpContext& context, const char* str)
 {
     if (rl >= 0 && rh >= 0)
@@ -554,6 +614,123 @@ void RegExpContext::Parse(const char* exp, bool regular, bool CaseSensitive, boo
     {
         matches.push_back(std::make_unique<RegExpMatch>(RegExpMatch::RE_M_EWORD, caseSensitive));
     }
+    if (!invalid)
+        Analyze();
+}
+// gather what every match must look like, so that Match() can skip over text that can't match
+// without running the matcher at each position.   This is only done in ways that can't change
+// the result: the matcher advances one character after a failure unless an interval was involved,
+// so positions are only skipped wholesale when there are no intervals in the expression
+void RegExpContext::Analyze()
+{
+    literal.clear();
+    literalOffset = -1;
+    fixedSteps = true;
+    firstChar = -1;
+    hasFirstChars = false;
+    for (auto& match : matches)
+        if (match->HasInterval())
+            fixedSteps = false;
+
+    // the first item that consumes anything gives the set of characters a match can start with
+    for (auto& match : matches)
+    {
+        int width = match->GetWidth();
+        if (width == 1)
+        {
+            match->GetCharSet(firstChars);
+            hasFirstChars = true;
+            int n = 0;
+            for (int i = 1; i < 128; i++)
+                if (firstChars[i / 8] & (1 << (i & 7)))
+                    firstChar = n++ ? -1 : i;
+        }
+        if (width != 0)
+            break;
+    }
+
+    // the longest run of plain characters is a literal string every match contains
+    int offset = 0;
+    std::string current;
+    int currentOffset = 0;
+    for (auto& match : matches)
+    {
+        int ch = match->GetLiteral();
+        if (ch > 0)
+        {
+            if (current.empty())
+                currentOffset = offset;
+            current += (char)ch;
+            if (current.size() > literal.size())
+            {
+                literal = current;
+                literalOffset = currentOffset;
+            }
+        }
+        else
+        {
+            current.clear();
+        }
+        int width = match->GetWidth();
+        if (width < 0 || offset < 0)
+            offset = -1;
+        else
+            offset += width;
+    }
+}
+// find the next place the required literal appears, letters match in either case
+const char* RegExpContext::FindLiteral(const char* str) const
+{
+    int lower = (UBYTE)literal[0];
+    int upper = toupper(lower);
+    for (;;)
+    {
+        if (lower == upper)
+            str = strchr(str, lower);
+        else
+            while (*str && *str != lower && *str != upper)
+                str++;
+        if (!str || !*str)
+            return nullptr;
+        size_t i;
+        for (i = 1; i < literal.size(); i++)
+            if (tolower((UBYTE)str[i]) != (UBYTE)literal[i])
+                break;
+        if (i == literal.size())
+            return str;
+        str++;
+    }
+}
+// returns the first position at or after str where a match might start, or nullptr if there is none
+const char* RegExpContext::NextCandidate(const char* str)
+{
+    if (!literal.empty())
+    {
+        if (fixedSteps && literalOffset >= 0)
+        {
+            for (int i = 0; i < literalOffset; i++)
+                if (!str[i])
+                    return nullptr;
+            const char* p = FindLiteral(str + literalOffset);
+            return p ? p - literalOffset : nullptr;
+        }
+        if (!nextLiteral || nextLiteral < str)
+        {
+            nextLiteral = FindLiteral(str);
+            if (!nextLiteral)
+                return nullptr;
+        }
+    }
+    if (firstChar > 0)
+        return strchr(str, firstChar);
+    if (hasFirstChars)
+    {
+        while (*str && ((UBYTE)*str >= 128 || !(firstChars[*str / 8] & (1 << (*str & 7)))))
+            str++;
+        if (!*str)
+            return nullptr;
+    }
+    return str;
 }
 int RegExpContext::MatchOne(const char* str)
 {
@@ -576,8 +753,12 @@ bool RegExpContext::Match(int start, int len, const char* Beginning)
     const char* str = Beginning + start;
     const char* end = str + len;
     matchStackTop = 0;
+    nextLiteral = nullptr;
     while (*str && str < end)
     {
+        str = NextCandidate(str);
+        if (!str || str >= end)
+            break;
         int n = MatchOne(str);
         if (n >= 0)
         {
@@ -32,6 +32,7 @@ typedef unsigned char UBYTE;
 #include <cctype>
 #include <cstring>
 #include <memory>
+#include <string>
 class RegExpContext;
 
 class RegExpMatch
@@ -118,6 +119,10 @@ class RegExpMatch
     void SetMatchRange(int val) { matchRange = val; }
     int GetMatchRange() const { return matchRange; }
     void SetInterval(int Rl, int Rh) { rl = Rl, rh = Rh; }
+    bool HasInterval() const { return rl >= 0 && rh >= 0; }
+    int GetWidth() const;
+    int GetLiteral() const;
+    void GetCharSet(UBYTE* set) const { memcpy(set, matches, 128 / 8); }
     int Matches(RegExpContext& context, const char* str);
     static void Init(bool caseSensitive);
 
@@ -152,7 +157,16 @@ class RegExpContext
 
   public:
     RegExpContext(const char* exp, bool regular, bool caseSensitive, bool matchesWord) :
-        caseSensitive(true), m_so(0), m_eo(0), invalid(false), beginning(nullptr)
+        caseSensitive(true),
+        m_so(0),
+        m_eo(0),
+        invalid(false),
+        beginning(nullptr),
+        literalOffset(-1),
+        fixedSteps(false),
+        firstChar(-1),
+        hasFirstChars(false),
+        nextLiteral(nullptr)
     {
         matchStackTop = 0;
         Parse(exp, regular, caseSensitive, matchesWord);
@@ -170,6 +184,9 @@ class RegExpContext
     int GetSpecial(char ch);
     int MatchOne(const char* str);
     void Clear();
+    void Analyze();
+    const char* NextCandidate(const char* str);
+    const char* FindLiteral(const char* str) const;
 
   private:
     std::deque<std::unique_ptr<RegExpMatch>> matches;
@@ -182,6 +199,15 @@ class RegExpContext
     int matchStackTop;
     int matchOffsets[10][2];
     int matchCount;
+
+    // prefilter data, gathered from the parsed expression by Analyze()
+    std::string literal;
+    int literalOffset;
+    bool fixedSteps;
+    int firstChar;
+    bool hasFirstChars;
+    UBYTE firstChars[128 / 8];
+    const char* nextLiteral;
 };
 
 #endif
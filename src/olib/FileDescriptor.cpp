@@ -26,6 +26,9 @@
 #include "LibFiles.h"
 #include "ObjFile.h"
 
-LibFiles::FileDescriptor::FileDescriptor(const ObjString& Name) : offset(0), name(Name), data(nullptr) {}
-LibFiles::FileDescriptor::FileDescriptor(const FileDescriptor& old) : name(old.name), offset(old.offset), data(nullptr) {}
+LibFiles::FileDescriptor::FileDescriptor(const ObjString& Name) : offset(0), name(Name), data(nullptr), dead(false) {}
+LibFiles::FileDescriptor::FileDescriptor(const FileDescriptor& old) :
+    name(old.name), offset(old.offset), data(nullptr), dead(old.dead)
+{
+}
 LibFiles::FileDescriptor::~FileDescriptor() {}
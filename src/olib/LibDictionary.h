@@ -65,10 +65,15 @@ class LibDictionary
     const std::vector<unsigned>& Lookup(FILE* stream, ObjInt dictOffset, ObjInt dictPages, const ObjString& str);
     bool Write(FILE* stream);
     void CreateDictionary(LibFiles& files);
+    // brings a dictionary loaded from the library up to date, indexes maps the old
+    // file table to the new one with -1 for modules which are gone
+    void UpdateDictionary(LibFiles& files, const std::vector<int>& indexes);
+    bool Load(FILE* stream, ObjInt dictOffset);
     void Clear() { dictionary.clear(); }
 
   protected:
-    void InsertInDictionary(const char* name, int index);
+    void InsertModule(Dictionary& dict, ObjFile* file, int index);
+    void InsertInDictionary(Dictionary& dict, const ObjString& name, int index);
 
   private:
     Dictionary dictionary;
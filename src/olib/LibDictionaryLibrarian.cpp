@@ -33,75 +33,147 @@
 #include <iostream>
 #include <cstring>
 #include "UTF8.h"
+#include <thread>
+#include <algorithm>
 
 void LibDictionary::CreateDictionary(LibFiles& files)
 {
-    int total = 0;
-    int symbols = 0;
     Clear();
+    std::vector<ObjFile*> modules;
+    for (auto&& fd : files)
+        if (fd->data)
+            modules.push_back(fd->data);
+    // each thread indexes a contiguous run of modules into its own dictionary, merging
+    // them in order afterwards keeps the module lists for each name sorted
+    size_t threads = std::thread::hardware_concurrency();
+    if (threads > modules.size() / 64 + 1)
+        threads = modules.size() / 64 + 1;
+    if (threads == 0)
+        threads = 1;
+    std::vector<Dictionary> partial(threads);
+    auto indexer = [&](size_t n) {
+        size_t last = modules.size() * (n + 1) / threads;
+        for (size_t i = modules.size() * n / threads; i < last; i++)
+            InsertModule(partial[n], modules[i], i);
+    };
+    std::vector<std::thread> workers;
+    for (size_t n = 1; n < threads; n++)
+        workers.push_back(std::thread(indexer, n));
+    indexer(0);
+    for (auto&& t : workers)
+        t.join();
+    dictionary = std::move(partial[0]);
+    for (size_t n = 1; n < threads; n++)
+    {
+        for (auto&& d : partial[n])
+        {
+            auto&& list = dictionary[d.first];
+            list.insert(list.end(), d.second.begin(), d.second.end());
+        }
+    }
+}
+void LibDictionary::UpdateDictionary(LibFiles& files, const std::vector<int>& indexes)
+{
+    // the old dictionary refers to modules by where they were in the old file table,
+    // names from modules which are gone are dropped
+    for (auto it = dictionary.begin(); it != dictionary.end();)
+    {
+        auto&& list = it->second;
+        size_t n = 0;
+        for (auto index : list)
+            if (index < indexes.size() && indexes[index] >= 0)
+                list[n++] = indexes[index];
+        list.resize(n);
+        if (n)
+            ++it;
+        else
+            it = dictionary.erase(it);
+    }
+    // the modules which have been read are the ones being added to the library
     int i = 0;
     for (auto&& fd : files)
     {
         if (fd->data)
+            InsertModule(dictionary, fd->data, i);
+        i++;
+    }
+    for (auto&& d : dictionary)
+        std::sort(d.second.begin(), d.second.end());
+}
+void LibDictionary::InsertModule(Dictionary& dict, ObjFile* file, int index)
+{
+    for (auto pi = file->PublicBegin(); pi != file->PublicEnd(); ++pi)
+    {
+        InsertInDictionary(dict, (*pi)->GetName(), index);
+    }
+    for (auto pi = file->ImportBegin(); pi != file->ImportEnd(); ++pi)
+    {
+        if (static_cast<ObjImportSymbol*>(*pi)->GetDllName().size())
+            InsertInDictionary(dict, (*pi)->GetName(), index);
+    }
+    // support for virtual sections
+    for (auto si = file->SectionBegin(); si != file->SectionEnd(); ++si)
+    {
+        if ((*si)->GetQuals() & ObjSection::virt)
         {
-            for (auto pi = fd->data->PublicBegin(); pi != fd->data->PublicEnd(); ++pi)
-            {
-                InsertInDictionary((*pi)->GetName().c_str(), i);
-            }
-            for (auto pi = fd->data->ImportBegin(); pi != fd->data->ImportEnd(); ++pi)
-            {
-                if (static_cast<ObjImportSymbol*>(*pi)->GetDllName().size())
-                    InsertInDictionary((*pi)->GetName().c_str(), i);
-            }
-            // support for virtual sections
-            for (auto si = fd->data->SectionBegin(); si != fd->data->SectionEnd(); ++si)
+            const std::string& name = (*si)->GetName();
+            size_t j = name.find('@');
+            if (j != std::string::npos)
             {
-                if ((*si)->GetQuals() & ObjSection::virt)
+                InsertInDictionary(dict, name.substr(j), index);
+                if (strncmp(name.c_str(), "vsb@", 4) == 0)
                 {
-                    int j;
-                    std::string name = (*si)->GetName();
-                    for (j = 0; j < name.size(); j++)
-                        if (name[j] == '@')
-                            break;
-                    if (j < name.size())
-                    {
-                        InsertInDictionary(name.c_str()+ j, i);
-                        if (strncmp((*si)->GetName().c_str(), "vsb@", 4) == 0)
-                        {
-                            InsertInDictionary(name.c_str() + j + 1, i);
-                        }
-                    }
+                    InsertInDictionary(dict, name.substr(j + 1), index);
                 }
             }
-            i++;
         }
     }
 }
-void LibDictionary::InsertInDictionary(const char* name, int index)
+void LibDictionary::InsertInDictionary(Dictionary& dict, const ObjString& name, int index)
 {
-    char buf[2048];
-    int l = strlen(name);
-    int n = l + 1;
-    strncpy(buf, name, 2048);
-    buf[2047] = 0;
-    std::string id = buf;
+    // names were always cut off at 2047 characters
+    size_t n = name.find('\0');
+    if (n > 2047)
+        n = 2047;
+    std::string id(name, 0, n);
     if (!caseSensitive)
-        id = UTF8::ToUpper(id);
-    dictionary[id].push_back(index);
+    {
+        bool ascii = true;
+        for (auto& c : id)
+        {
+            if (c & 0x80)
+            {
+                ascii = false;
+                break;
+            }
+            c = toupper(c);
+        }
+        if (!ascii)
+            id = UTF8::ToUpper(id);
+    }
+    dict[std::move(id)].push_back(index);
 }
 bool LibDictionary::Write(FILE* stream)
 {
     char sig[4] = {'1', '1', 0, 0};
     if (fwrite(&sig[0], 4, 1, stream) != 1)
         return false;
-    for (auto d : dictionary)
+    // written in name order, the hash order depends on how the dictionary was built and so
+    // on how many threads built it
+    std::vector<const Dictionary::value_type*> entries;
+    entries.reserve(dictionary.size());
+    for (auto&& d : dictionary)
+        entries.push_back(&d);
+    std::sort(entries.begin(), entries.end(),
+              [](const Dictionary::value_type* left, const Dictionary::value_type* right) { return left->first < right->first; });
+    for (auto d : entries)
     {
-        short len = d.first.size();
+        short len = d->first.size();
         if (fwrite(&len, sizeof(len), 1, stream) != 1)
             return false;
-        if (fwrite(d.first.c_str(), len, 1, stream) != 1)
+        if (fwrite(d->first.c_str(), len, 1, stream) != 1)
             return false;
-        auto&& list = d.second;
+        auto&& list = d->second;
         unsigned fileNum;
         for (int i = 0; i < list.size() - 1; i++)
         {
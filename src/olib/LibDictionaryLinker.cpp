@@ -51,48 +51,52 @@ ObjInt DictCompare::casecmp(const std::string& str1, const std::string& str2, in
     }
     return v;
 }
+bool LibDictionary::Load(FILE* stream, ObjInt dictionaryOffset)
+{
+    if (fseek(stream, 0, SEEK_END))
+        return false;
+    int end = ftell(stream);
+    int size = end - dictionaryOffset;
+    std::unique_ptr<ObjByte[]> buf = std::make_unique<ObjByte[]>(size);
+    ObjByte* q = buf.get();
+    if (fseek(stream, dictionaryOffset, SEEK_SET))
+        return false;
+    if (fread(q, size, 1, stream) != 1)
+        return false;
+    // attempt to shut up coverity
+    if (feof(stream))
+        return false;
+    char sig[4] = {'1', '1', 0, 0};
+    if (memcmp(sig, q, 4))
+        return false;
+    int len;
+    q += 4;
+    len = *(short*)q;
+    while (len)
+    {
+        q += 2;
+        std::string name = std::string((char*)q, len);
+        q += len;
+        unsigned fileNum;
+        do
+        {
+            fileNum = *(unsigned*)(q);
+            q += sizeof(unsigned);
+            dictionary[name].push_back(fileNum & ~DictionaryContinuationFlag);
+        } while (fileNum & DictionaryContinuationFlag);
+        len = *(short*)q;
+    }
+    return true;
+}
 const std::vector<unsigned>& LibDictionary::Lookup(FILE* stream, ObjInt dictionaryOffset, ObjInt dictionarySize, const ObjString& name)
 {
     const static std::vector<unsigned> dummy;
     if (dictionary.empty())
     {
-        if (fseek(stream, 0, SEEK_END))
-            return dummy;
-        int end = ftell(stream);
-        int size = end - dictionaryOffset;
-        std::unique_ptr<ObjByte[]> buf = std::make_unique<ObjByte[]>(size);
-        ObjByte* q = buf.get();
-        if (fseek(stream, dictionaryOffset, SEEK_SET))
-            return dummy;
-        if (fread(q, size, 1, stream) != 1)
-            return dummy;
-        // attempt to shut up coverity
-        if (feof(stream))
-            return dummy;
-        char sig[4] = {'1', '1', 0, 0};
-        if (!memcmp(sig, q, 4))
-        {
-            int len;
-            q += 4;
-            len = *(short*)q;
-            while (len)
-            {
-                q += 2;
-                std::string name = std::string((char *)q, len);
-                q += len;
-                unsigned fileNum;
-                do
-                {
-                    fileNum = *(unsigned*)(q);
-                    q += sizeof(unsigned);
-                    dictionary[name].push_back(fileNum & ~DictionaryContinuationFlag);
-                } while (fileNum & DictionaryContinuationFlag);
-                len = *(short*)q;
-            }
-        }
-        else
+        if (!Load(stream, dictionaryOffset))
         {
             std::cout << "Old format library detected, please rebuild libraries" << std::endl;
+            return dummy;
         }
     }
     auto it = dictionary.find(name);
@@ -29,8 +29,10 @@
 #include <deque>
 #include <cstdio>
 #include <memory>
+#include <climits>
 class ObjFile;
 class ObjFactory;
+class MappedFile;
 class LibFiles
 {
   public:
@@ -42,14 +44,18 @@ class LibFiles
         ObjString name;
         ObjInt offset;
         ObjFile* data;
+        // a module which has been removed or replaced, its old copy is still in the library
+        // until it gets compacted
+        bool dead;
     };
+    const unsigned DeadModuleFlag = 1 << (sizeof(unsigned) * CHAR_BIT - 1);
     LibFiles(bool CaseSensitive = true, bool noexport = false) : caseSensitive(CaseSensitive), noExport(noexport) {}
     virtual ~LibFiles() {}
 
     void Add(ObjFile& obj);
     void Add(const ObjString& Name);
     void Remove(const ObjString& Name);
-    void Extract(FILE* stream, const ObjString& Name);
+    void Extract(const MappedFile& library, const ObjString& Name);
     void Replace(ObjFile& obj);
     void Replace(const ObjString& Name);
 
@@ -58,10 +64,14 @@ class LibFiles
     bool WriteNames(FILE* stream);
     bool ReadOffsets(FILE* stream, int count);
     bool WriteOffsets(FILE* stream);
-    bool ReadFiles(FILE* stream, ObjFactory* factory);
+    // reads every module not already loaded, using one thread per factory.  Modules
+    // already in the library are skipped unless libraryModules is set
+    bool ReadFiles(const ObjString& libName, std::deque<ObjFactory>& factories, bool libraryModules = true);
     bool WriteFiles(FILE* stream, ObjInt align);
+    bool AppendFiles(FILE* stream, ObjInt align);
+    void RemoveDead();
 
-    ObjFile* LoadModule(FILE* stream, ObjInt FileIndex, ObjFactory* factory);
+    ObjFile* LoadModule(const MappedFile& library, ObjInt FileIndex, ObjFactory* factory);
 
     typedef std::deque<std::unique_ptr<FileDescriptor>>::iterator iterator;
     iterator begin() { return files.begin(); }
@@ -69,8 +79,10 @@ class LibFiles
 
   protected:
     ObjFile* ReadData(FILE* stream, const ObjString& name, ObjFactory* factory);
+    ObjFile* ReadData(const MappedFile& library, ObjInt offset, const ObjString& name, ObjFactory* factory);
     bool WriteData(FILE* stream, ObjFile* file, const ObjString& name);
     bool Align(FILE* stream, ObjInt align);
+    void KeepDead(FileDescriptor& file);
 
   private:
     std::deque<std::unique_ptr<FileDescriptor>> files;
@@ -29,8 +29,13 @@
 #include "ObjIeee.h"
 #include "ObjFactory.h"
 #include "CmdFiles.h"
+#include "MappedFile.h"
 #include <iostream>
 #include <cstring>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
 #ifdef HAVE_UNISTD_H
 #    include <unistd.h>
 #else
@@ -40,7 +45,7 @@
 void LibFiles::Add(ObjFile& obj)
 {
     for (int i = 0; i < files.size(); i++)
-        if (files[i]->name == obj.GetName())
+        if (!files[i]->dead && files[i]->name == obj.GetName())
         {
             std::cout << "Warning: module '" << files[i]->name << "' already exists in library, it won't be added" << std::endl;
             return;
@@ -58,7 +63,7 @@ void LibFiles::Add(const ObjString& Name)
     if (npos != std::string::npos)
         internalName = Name.substr(npos + 1);
     for (int i = 0; i < files.size(); i++)
-        if (files[i]->name == internalName)
+        if (!files[i]->dead && files[i]->name == internalName)
         {
             std::cout << "Warning: module '" << Name << "' already exists in library, it won't be added" << std::endl;
             return;
@@ -73,15 +78,19 @@ void LibFiles::Remove(const ObjString& Name)
         internalName = Name.substr(npos + 1);
     for (auto it = begin(); it != end(); ++it)
     {
-        if ((*it)->name == internalName)
+        if (!(*it)->dead && (*it)->name == internalName)
         {
-            files.erase(it);
+            // a module from the library stays there as dead space until the library is compacted
+            if ((*it)->offset)
+                (*it)->dead = true;
+            else
+                files.erase(it);
             return;
         }
     }
     std::cout << "Warning: Module '" << Name << "' not in library and could not be removed" << std::endl;
 }
-void LibFiles::Extract(FILE* stream, const ObjString& Name)
+void LibFiles::Extract(const MappedFile& library, const ObjString& Name)
 {
     size_t npos = Name.find_last_of(CmdFiles::DIR_SEP);
     std::string internalName = Name;
@@ -92,9 +101,9 @@ void LibFiles::Extract(FILE* stream, const ObjString& Name)
     ObjFactory fact1(&im1);
     for (auto&& file : *this)
     {
-        if (file->name == internalName)
+        if (!file->dead && file->name == internalName)
         {
-            ObjFile* p = LoadModule(stream, count, &fact1);
+            ObjFile* p = LoadModule(library, count, &fact1);
             if (p)
             {
                 FILE* ostr = fopen(Name.c_str(), "wb");
@@ -127,6 +136,16 @@ void LibFiles::Extract(FILE* stream, const ObjString& Name)
     }
     std::cout << "Warning: Module '" << Name << "' not in library and could not be extracted" << std::endl;
 }
+void LibFiles::KeepDead(FileDescriptor& file)
+{
+    // the old copy of a replaced module moves to the end of the file table so that the
+    // library can be updated in place
+    if (file.offset)
+    {
+        files.push_back(std::make_unique<FileDescriptor>(file));
+        files.back()->dead = true;
+    }
+}
 void LibFiles::Replace(ObjFile& obj)
 {
     std::string Name = obj.GetName();
@@ -136,8 +155,9 @@ void LibFiles::Replace(ObjFile& obj)
         internalName = Name.substr(npos + 1);
     for (auto&& file : *this)
     {
-        if (file->name == internalName)
+        if (!file->dead && file->name == internalName)
         {
+            KeepDead(*file);
             if (file->data)
             {
                 file->data = nullptr;
@@ -158,8 +178,9 @@ void LibFiles::Replace(const ObjString& Name)
         internalName = Name.substr(npos + 1);
     for (auto&& file : *this)
     {
-        if (file->name == internalName)
+        if (!file->dead && file->name == internalName)
         {
+            KeepDead(*file);
             if (file->data)
             {
                 file->data = nullptr;
@@ -202,7 +223,9 @@ bool LibFiles::WriteOffsets(FILE* stream)
 {
     for (auto&& file : *this)
     {
-        ObjInt ofs = file->offset;
+        unsigned ofs = file->offset;
+        if (file->dead)
+            ofs |= DeadModuleFlag;
         if (fwrite(&ofs, 4, 1, stream) != 1)
             return false;
     }
@@ -218,65 +241,91 @@ bool LibFiles::Align(FILE* stream, int align)
             return false;
     return true;
 }
-bool LibFiles::ReadFiles(FILE* stream, ObjFactory* factory)
+bool LibFiles::ReadFiles(const ObjString& libName, std::deque<ObjFactory>& factories, bool libraryModules)
 {
-    bool rv = true;
-    bool done = false;
-    while (!done)
+    enum
     {
-        done = true;
-        for (auto it = begin(); it != end();)
+        READ_OK,
+        READ_SYNTAX,
+        READ_MISSING
+    };
+    // modules are parsed in parallel, each thread has its own factory and they all
+    // parse the library's modules from one mapping of it.  Threads take the next module
+    // in line so the work stays balanced when a few modules are much larger than the rest
+    std::vector<int> status(files.size(), READ_OK);
+    std::atomic<size_t> next(0);
+    std::vector<std::exception_ptr> errors(factories.size());
+    std::unique_ptr<MappedFile> library;
+    if (libraryModules)
+        library = std::make_unique<MappedFile>(libName);
+    auto reader = [&](size_t n) {
+        ObjFactory* factory = &factories[n];
+        for (size_t i = next++; i < files.size(); i = next++)
         {
-            auto itn = it;
-            ++it;
-            if (!(*itn)->data)
+            try
             {
-                if ((*itn)->offset)
+                auto&& file = files[i];
+                if (file->data || file->dead || (file->offset && !libraryModules))
+                    continue;
+                if (file->offset)
                 {
-                    if (fseek(stream, (*itn)->offset, SEEK_SET))
-                        return false;
-                    (*itn)->data = ReadData(stream, (*itn)->name, factory);
-                    if (!(*itn)->data)
-                    {
-                        std::cout << "Error: Syntax error in module '" << (*itn)->name << "'" << std::endl;
-                        files.erase(itn);
-                        done = false;
-                        rv = false;
-                        break;
-                    }
+                    file->data = ReadData(*library, file->offset, file->name, factory);
                     // leaving export records alone if they were added previosly without --noexport
+                    if (!file->data)
+                        status[i] = READ_SYNTAX;
                 }
                 else
                 {
-                    FILE* istr = fopen((*itn)->name.c_str(), "rb");
+                    FILE* istr = fopen(file->name.c_str(), "rb");
                     if (istr != nullptr)
                     {
-                        (*itn)->data = ReadData(istr, (*itn)->name, factory);
+                        file->data = ReadData(istr, file->name, factory);
                         fclose(istr);
-                        if (!(*itn)->data)
-                        {
-                            std::cout << "Error: Syntax error in module '" << (*itn)->name << "'" << std::endl;
-                            files.erase(itn);
-                            done = false;
-                            rv = false;
-                            break;
-                        }
+                        if (!file->data)
+                            status[i] = READ_SYNTAX;
                         else if (noExport)
-                        {
-                            (*itn)->data->ExportClear();
-                        }
+                            file->data->ExportClear();
                     }
                     else
                     {
-                        std::cout << "Error: Module '" << (*itn)->name << "' does not exist" << std::endl;
-                        files.erase(itn);
-                        done = false;
-                        rv = false;
-                        break;
+                        status[i] = READ_MISSING;
                     }
                 }
             }
+            catch (...)
+            {
+                // the bad file exception ends up in main, the same as if this were one thread
+                errors[n] = std::current_exception();
+                next = files.size();
+            }
         }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < factories.size(); i++)
+        threads.push_back(std::thread(reader, i));
+    reader(0);
+    for (auto&& t : threads)
+        t.join();
+    for (auto&& e : errors)
+        if (e)
+            std::rethrow_exception(e);
+
+    // report in library order and drop the modules which couldn't be read
+    bool rv = true;
+    int i = 0;
+    for (auto it = begin(); it != end(); i++)
+    {
+        if (status[i] == READ_OK)
+        {
+            ++it;
+            continue;
+        }
+        if (status[i] == READ_SYNTAX)
+            std::cout << "Error: Syntax error in module '" << (*it)->name << "'" << std::endl;
+        else
+            std::cout << "Error: Module '" << (*it)->name << "' does not exist" << std::endl;
+        it = files.erase(it);
+        rv = false;
     }
     return rv;
 }
@@ -293,3 +342,28 @@ bool LibFiles::WriteFiles(FILE* stream, ObjInt align)
     }
     return true;
 }
+bool LibFiles::AppendFiles(FILE* stream, ObjInt align)
+{
+    for (auto&& file : *this)
+    {
+        if (!file->dead && !file->offset)
+        {
+            if (!Align(stream, align))
+                return false;
+            file->offset = ftell(stream);
+            if (!WriteData(stream, file->data, file->name))
+                return false;
+        }
+    }
+    return true;
+}
+void LibFiles::RemoveDead()
+{
+    for (auto it = begin(); it != end();)
+    {
+        if ((*it)->dead)
+            it = files.erase(it);
+        else
+            ++it;
+    }
+}
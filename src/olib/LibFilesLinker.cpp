@@ -28,6 +28,7 @@
 #include "ObjFile.h"
 #include "ObjIeee.h"
 #include "ObjFactory.h"
+#include "MappedFile.h"
 #include <cassert>
 
 ObjFile* LibFiles::ReadData(FILE* stream, const ObjString& name, ObjFactory* factory)
@@ -36,6 +37,11 @@ ObjFile* LibFiles::ReadData(FILE* stream, const ObjString& name, ObjFactory* fac
     ObjIeee ieee(name.c_str(), caseSensitive);
     return ieee.Read(stream, ObjIeee::eAll, factory);
 }
+ObjFile* LibFiles::ReadData(const MappedFile& library, ObjInt offset, const ObjString& name, ObjFactory* factory)
+{
+    ObjIeee ieee(name.c_str(), caseSensitive);
+    return ieee.Read(library, offset, ObjIeee::eAll, factory);
+}
 bool LibFiles::ReadNames(FILE* stream, int count)
 {
     for (int i = 0; i < count; i++)
@@ -65,18 +71,17 @@ bool LibFiles::ReadOffsets(FILE* stream, int count)
         unsigned ofs;
         if (fread(&ofs, 4, 1, stream) != 1)
             return false;
-        file->offset = ofs;
+        file->offset = ofs & ~DeadModuleFlag;
+        file->dead = !!(ofs & DeadModuleFlag);
     }
     return true;
 }
-ObjFile* LibFiles::LoadModule(FILE* stream, ObjInt FileIndex, ObjFactory* factory)
+ObjFile* LibFiles::LoadModule(const MappedFile& library, ObjInt FileIndex, ObjFactory* factory)
 {
     if (FileIndex >= files.size())
         return nullptr;
     auto& a = files[FileIndex];
-    if (!a->offset)
-        return nullptr;
-    if (fseek(stream, a->offset, SEEK_SET))
+    if (!a->offset || a->dead)
         return nullptr;
-    return ReadData(stream, a->name, factory);
+    return ReadData(library, a->offset, a->name, factory);
 }
@@ -28,10 +28,12 @@
 
 #include <vector>
 #include <set>
+#include <deque>
 #include <cstdio>
 #include "ObjTypes.h"
 #include "LibDictionary.h"
 #include "LibFiles.h"
+#include "MappedFile.h"
 
 class ObjSymbol;
 class ObjFile;
@@ -45,6 +47,7 @@ class LibManager
         CANNOT_CREATE = -1,
         CANNOT_READ = -2,
         CANNOT_WRITE = -3,
+        CANNOT_UPDATE = -4,
         SUCCESS = 0
     };
     LibManager(const ObjString& Name, bool noexport, bool CaseSensitive = true) :
@@ -59,11 +62,11 @@ class LibManager
     void AddFile(const ObjString& name) { files.Add(name); }
     void AddFile(ObjFile& obj) { files.Add(obj); }
     void RemoveFile(const ObjString& name) { files.Remove(name); }
-    void ExtractFile(const ObjString& name) { files.Extract(stream, name); }
+    void ExtractFile(const ObjString& name) { files.Extract(Library(), name); }
     void ReplaceFile(const ObjString& name) { files.Replace(name); }
     void ReplaceFile(ObjFile& obj) { files.Replace(obj); }
     const std::vector<unsigned>& Lookup(const ObjString& name);
-    ObjFile* LoadModule(ObjInt index, ObjFactory* factory) { return files.LoadModule(stream, index, factory); }
+    ObjFile* LoadModule(ObjInt index, ObjFactory* factory) { return files.LoadModule(Library(), index, factory); }
     bool LoadLibrary();
     int SaveLibrary();
     bool fail() const { return false; }  // stream.fail(); }
@@ -72,10 +75,14 @@ class LibManager
     {
         if (stream)
             fclose(stream);
+        stream = nullptr;
+        map = nullptr;
     }
     enum
     {
-        ALIGN = 512
+        ALIGN = 512,
+        // percentage of the module space which may be dead before the library is compacted
+        DEAD_SPACE_LIMIT = 25
     };
     struct LibHeader
     {
@@ -95,6 +102,8 @@ class LibManager
 
   protected:
     bool Align(FILE* ostr, ObjInt align = ALIGN);
+    int UpdateLibrary(std::deque<ObjFactory>& factories);
+    bool Truncate(FILE* ostr);
     void InitHeader();
     bool WriteHeader()
     {
@@ -112,10 +121,19 @@ class LibManager
             return false;
         return true;
     }
+    // modules are parsed straight out of one mapping of the library, made the first time
+    // a module is loaded
+    const MappedFile& Library()
+    {
+        if (!map)
+            map = std::make_unique<MappedFile>(name);
+        return *map;
+    }
 
   private:
     LibHeader header;
     FILE* stream;
+    std::unique_ptr<MappedFile> map;
     LibFiles files;
     LibDictionary dictionary;
     ObjString name;
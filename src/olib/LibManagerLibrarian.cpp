@@ -27,13 +27,37 @@
 #include "ObjIeee.h"
 #include "ObjFactory.h"
 #include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <deque>
+#include <thread>
+#ifdef HAVE_UNISTD_H
+#    include <unistd.h>
+#else
+#    include <io.h>
+#endif
 
 int LibManager::SaveLibrary()
 {
+    // one factory per thread reading modules, they own the modules until the library is written
+    size_t threads = std::thread::hardware_concurrency();
+    if (threads > files.size())
+        threads = files.size();
+    if (threads == 0)
+        threads = 1;
+    std::deque<ObjIeeeIndexManager> indexManagers(threads);
+    std::deque<ObjFactory> factories;
+    for (auto&& im : indexManagers)
+        factories.emplace_back(&im);
+    if (stream && header.sig == LibHeader::LIB_SIG)
+    {
+        int rv = UpdateLibrary(factories);
+        if (rv != CANNOT_UPDATE)
+            return rv;
+    }
     InitHeader();
-    ObjIeeeIndexManager im1;
-    ObjFactory fact1(&im1);
-    if (!files.ReadFiles(stream, &fact1))
+    files.RemoveDead();
+    if (!files.ReadFiles(name, factories))
         return CANNOT_READ;
     dictionary.CreateDictionary(files);
     // can't do more reading
@@ -44,6 +68,9 @@ int LibManager::SaveLibrary()
     {
         return CANNOT_CREATE;
     }
+    // the library goes out in one pass, with a buffer big enough that most modules don't
+    // cost more than a write or two
+    setvbuf(ostr, nullptr, _IOFBF, 1024 * 1024);
     if (fwrite(&header, sizeof(header), 1, ostr) != 1)
     {
         fclose(ostr);
@@ -107,6 +134,136 @@ int LibManager::SaveLibrary()
     fclose(ostr);
     return SUCCESS;
 }
+int LibManager::UpdateLibrary(std::deque<ObjFactory>& factories)
+{
+    // the tables always come after the modules, whatever is added goes where they start
+    ObjInt tableStart = header.namesOffset >= header.filesOffset ? header.namesOffset : header.offsetsOffset;
+    std::vector<unsigned> oldOffsets(header.filesInModule);
+    if (oldOffsets.size())
+    {
+        if (fseek(stream, header.offsetsOffset, SEEK_SET))
+            return CANNOT_UPDATE;
+        if (fread(&oldOffsets[0], sizeof(unsigned), oldOffsets.size(), stream) != oldOffsets.size())
+            return CANNOT_UPDATE;
+    }
+    // a module runs up to the one after it, so this is the size of the old copies
+    // of removed and replaced modules including their alignment
+    std::vector<ObjInt> starts;
+    for (auto&& file : files)
+        if (file->offset)
+            starts.push_back(file->offset);
+    starts.push_back(tableStart);
+    std::sort(starts.begin(), starts.end());
+    // in long long, a library with large debug info overflows an int once it is multiplied out
+    long long dead = 0;
+    for (auto&& file : files)
+        if (file->dead)
+            dead += *std::upper_bound(starts.begin(), starts.end(), file->offset) - file->offset;
+    if (dead * 100 > (long long)(tableStart - header.filesOffset) * DEAD_SPACE_LIMIT)
+        return CANNOT_UPDATE;
+    if (!dictionary.Load(stream, header.dictionaryOffset))
+    {
+        dictionary.Clear();
+        return CANNOT_UPDATE;
+    }
+    if (!files.ReadFiles(name, factories, false))
+        return CANNOT_READ;
+    std::unordered_map<ObjInt, int> current;
+    int i = 0;
+    for (auto&& file : files)
+    {
+        if (!file->dead && file->offset)
+            current[file->offset] = i;
+        i++;
+    }
+    std::vector<int> indexes(oldOffsets.size(), -1);
+    for (i = 0; i < oldOffsets.size(); i++)
+    {
+        auto it = current.find(oldOffsets[i]);
+        if (it != current.end())
+            indexes[i] = it->second;
+    }
+    dictionary.UpdateDictionary(files, indexes);
+    // can't do more reading
+    Close();
+    header.filesInModule = files.size();
+    FILE* ostr = fopen(name.c_str(), "r+b");
+    if (!ostr)
+    {
+        return CANNOT_CREATE;
+    }
+    setvbuf(ostr, nullptr, _IOFBF, 1024 * 1024);
+    if (fseek(ostr, tableStart, SEEK_SET))
+    {
+        fclose(ostr);
+        return CANNOT_WRITE;
+    }
+    if (!files.AppendFiles(ostr, ALIGN))
+    {
+        fclose(ostr);
+        return CANNOT_WRITE;
+    }
+    if (!Align(ostr))
+    {
+        fclose(ostr);
+        return CANNOT_WRITE;
+    }
+    header.namesOffset = ftell(ostr);
+    if (!files.WriteNames(ostr))
+    {
+        fclose(ostr);
+        return CANNOT_WRITE;
+    }
+    if (!Align(ostr))
+    {
+        fclose(ostr);
+        return CANNOT_WRITE;
+    }
+    header.offsetsOffset = ftell(ostr);
+    if (!files.WriteOffsets(ostr))
+    {
+        fclose(ostr);
+        return CANNOT_WRITE;
+    }
+    if (!Align(ostr))
+    {
+        fclose(ostr);
+        return CANNOT_WRITE;
+    }
+    header.dictionaryOffset = ftell(ostr);
+    header.dictionaryBlocks = 0;
+    if (!dictionary.Write(ostr))
+    {
+        fclose(ostr);
+        return CANNOT_WRITE;
+    }
+    // the old tables may have gone further than the new ones
+    if (fflush(ostr) || !Truncate(ostr))
+    {
+        fclose(ostr);
+        return CANNOT_WRITE;
+    }
+    if (fseek(ostr, 0, SEEK_SET))
+    {
+        fclose(ostr);
+        return CANNOT_WRITE;
+    }
+    if (fwrite(&header, sizeof(header), 1, ostr) != 1)
+    {
+        fclose(ostr);
+        return CANNOT_WRITE;
+    }
+    fclose(ostr);
+    return SUCCESS;
+}
+bool LibManager::Truncate(FILE* ostr)
+{
+#ifdef HAVE_UNISTD_H
+    return !ftruncate(fileno(ostr), ftell(ostr));
+#else
+    return !_chsize(_fileno(ostr), ftell(ostr));
+#endif
+}
 bool LibManager::Align(FILE* ostr, ObjInt align)
 {
     char buf[ALIGN];
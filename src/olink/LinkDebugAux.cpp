@@ -67,7 +67,8 @@ int LinkerColumnsWithNameVirtualTable::Column(void* cursor, sqlite3_context* ctx
 int LinkerColumnsWithNameVirtualTable::RowId(void* cursor, sqlite3_int64* pRowid)
 {
     struct lfcurs* q = (struct lfcurs*)cursor;
-    return q->i;
+    *pRowid = q->i;
+    return SQLITE_OK;
 }
 char* LinkerColumnsWithNameVirtualTable::GetVTabDeclarator() { return (char*)declarator.c_str(); }
 char* LinkerColumnsWithNameVirtualTable::GetName() { return (char*)name.c_str(); }
@@ -42,6 +42,7 @@
 #include <cctype>
 #include <iostream>
 #include <algorithm>
+#include <thread>
 #ifdef HAVE_UNISTD_H
 #    include <unistd.h>
 #else
@@ -56,7 +57,8 @@ static int version_ok;
 // speed things up for individual tables, but when you are writing as database the
 // disk writes are the limiting factor.  Nonetheless I remain with the virtual table
 // approach because the codelooks much prettier...
-const char* LinkDebugFile::pragmas = {"PRAGMA journal_mode=MEMORY; PRAGMA temp_store=MEMORY;"};
+// the database is written once and thrown away if the link fails, so there is no journal and no syncing
+const char* LinkDebugFile::pragmas = {"PRAGMA journal_mode=OFF; PRAGMA synchronous=OFF; PRAGMA temp_store=MEMORY;"};
 const char* LinkDebugFile::tables = {
     "BEGIN; "
     "CREATE TABLE dbPropertyBag ("
@@ -163,7 +165,6 @@ const char* LinkDebugFile::tables = {
     ");"
     "COMMIT; "};
 const char* LinkDebugFile::indexes = {
-    "BEGIN; "
     "CREATE INDEX LNIndex ON LineNumbers(fileid,line);"
     "CREATE INDEX TNIndex1 ON TypeNames(symbolId);"
     "CREATE INDEX TNIndex2 ON TypeNames(typeId);"
@@ -172,8 +173,7 @@ const char* LinkDebugFile::indexes = {
     "CREATE INDEX GBLIndex1 ON Globals(symbolId, fileId);"
     "CREATE INDEX GBLIndex2 ON Globals(varAddress, fileId);"
     "CREATE INDEX LCLIndex ON Locals(symbolId, fileId);"
-    "CREATE INDEX AUTIndex ON Autos(symbolId, fileId, funcId);"
-    "COMMIT; "};
+    "CREATE INDEX AUTIndex ON Autos(symbolId, fileId, funcId);"};
 LinkDebugFile::~LinkDebugFile() {}
 bool LinkDebugFile::Begin(void) { return SQLiteExec("BEGIN"); }
 bool LinkDebugFile::End(void) { return SQLiteExec("END"); }
@@ -221,10 +221,16 @@ bool LinkDebugFile::DBOpen(char* name)
         sqlite3_busy_timeout(dbPointer, 100);
     return rv;
 }
-bool LinkDebugFile::WriteFileNames()
+bool LinkDebugFile::BulkInsert(SQL3VirtualTable& table, const char* name)
+{
+    bool rv = table.Start(dbPointer) == SQLITE_OK && table.InsertIntoFrom(name, false) == SQLITE_OK;
+    table.Stop();
+    return rv;
+}
+void LinkDebugFile::GatherFileNames()
 {
-    std::vector<sqlite3_int64> v;
-    std::vector<ObjString> n;
+    std::vector<sqlite3_int64>& v = fileNameData;
+    std::vector<ObjString>& n = fileNameStrings;
     for (auto it = file->SourceFileBegin(); it != file->SourceFileEnd(); ++it)
     {
         ObjString name = (*it)->GetName();
@@ -234,16 +240,10 @@ bool LinkDebugFile::WriteFileNames()
         v.push_back(index);
         n.push_back(name);
     }
-    LinkerColumnsWithNameVirtualTable fns(v, n, 2, true);
-    fns.Start(dbPointer);
-    fns.InsertIntoFrom("filenames");
-    fns.Stop();
-    v.clear();
-    return true;
 }
-bool LinkDebugFile::WriteLineNumbers()
+void LinkDebugFile::GatherLineNumbers()
 {
-    std::vector<sqlite3_int64> v;
+    std::vector<sqlite3_int64>& v = lineData;
     //    std::vector<sqlite3_int64> a;
     for (auto it = file->SectionBegin(); it != file->SectionEnd(); ++it)
     {
@@ -281,15 +281,10 @@ bool LinkDebugFile::WriteLineNumbers()
             address += memory->GetSize();
         }
     }
-    IntegerColumnsVirtualTable lines(v, 3);
-    lines.Start(dbPointer);
-    lines.InsertIntoFrom("linenumbers");
-    lines.Stop();
     //    IntegerColumnsVirtualTable linesfull(a, 3);
     //    linesfull.Start(dbPointer);
     //    linesfull.InsertIntoFrom("linenumbersfull");
     //    linesfull.Stop();
-    return true;
 }
 void LinkDebugFile::PushCPPName(const ObjString& name, int n)
 {
@@ -352,36 +347,10 @@ int LinkDebugFile::GetSQLNameId(const ObjString& name)
     PushCPPName(name, n);
     return n;
 }
-bool LinkDebugFile::WriteNamesTable()
-{
-    std::vector<sqlite3_int64> v;
-    for (int i = 0; i < nameList.size(); i++)
-    {
-        v.push_back(i + 1);
-    }
-    LinkerColumnsWithNameVirtualTable fns(v, nameList, 2, true);
-    fns.Start(dbPointer);
-    fns.InsertIntoFrom("names");
-    fns.Stop();
-    nameList.clear();
-    v.clear();
-    for (auto map : CPPMappingList)
-    {
-        v.push_back(map.simpleId);
-        v.push_back(map.complexId);
-    }
-    IntegerColumnsVirtualTable args(v, 2);
-    args.Start(dbPointer);
-    args.InsertIntoFrom("cppnamemapping");
-    args.Stop();
-    CPPMappingList.clear();
-    return true;
-}
-bool LinkDebugFile::WriteVariableTypes()
+void LinkDebugFile::GatherVariableTypes()
 {
-    ObjString empty = "";
-    std::vector<sqlite3_int64> v;
-    std::vector<ObjString> n;
+    std::vector<sqlite3_int64>& v = typeData;
+    std::vector<ObjString>& n = typeStrings;
     for (auto it = file->TypeBegin(); it != file->TypeEnd(); ++it)
     {
         ObjType* type = *it;
@@ -477,11 +446,6 @@ bool LinkDebugFile::WriteVariableTypes()
                 break;
         }
     }
-    LinkerColumnsWithNameVirtualTable types(v, n, 11, true);
-    types.Start(dbPointer);
-    types.InsertIntoFrom("types");
-    types.Stop();
-    v.clear();
     for (auto it = file->TypeBegin(); it != file->TypeEnd(); ++it)
     {
         ObjType* type = *it;
@@ -492,9 +456,9 @@ bool LinkDebugFile::WriteVariableTypes()
                 int order = 0;
                 for (auto param : *func)
                 {
-                    v.push_back(func->GetIndex());
-                    v.push_back(GetTypeIndex(param));
-                    v.push_back(order++);
+                    argData.push_back(func->GetIndex());
+                    argData.push_back(GetTypeIndex(param));
+                    argData.push_back(order++);
                 }
             }
             break;
@@ -502,11 +466,10 @@ bool LinkDebugFile::WriteVariableTypes()
                 break;
         }
     }
-    IntegerColumnsVirtualTable args(v, 3);
-    args.Start(dbPointer);
-    args.InsertIntoFrom("args");
-    args.Stop();
-    v.clear();
+}
+void LinkDebugFile::GatherFields()
+{
+    std::vector<sqlite3_int64>& v = fieldData;
     for (auto it = file->TypeBegin(); it != file->TypeEnd(); ++it)
     {
         ObjType* type = *it;
@@ -530,13 +493,8 @@ bool LinkDebugFile::WriteVariableTypes()
                 break;
         }
     }
-    IntegerColumnsVirtualTable fields(v, 5);
-    fields.Start(dbPointer);
-    fields.InsertIntoFrom("fields");
-    fields.Stop();
-    return true;
 }
-bool LinkDebugFile::WriteVariableNames()
+bool LinkDebugFile::GatherVariableNames()
 {
     for (auto it = file->PublicBegin(); it != file->PublicEnd(); ++it)
     {
@@ -612,14 +570,14 @@ ObjInt LinkDebugFile::GetSectionBase(ObjExpression* e)
     }
     return 0;
 }
-bool LinkDebugFile::WriteGlobalsTable()
+void LinkDebugFile::GatherGlobalsTable()
 {
-    std::vector<sqlite3_int64> v;
+    std::vector<sqlite3_int64>& v = globalData;
     for (auto it = file->PublicBegin(); it != file->PublicEnd(); ++it)
     {
         int index = (*it)->GetIndex();
         // ObjString name = (*it)->GetName();
-        index = publicMap[index];
+        index = Lookup(publicMap, index);
         int address = GetSectionBase((*it)->GetOffset());
         address += (*it)->GetOffset()->EvalNoModify(0);
         int type = -1;
@@ -631,53 +589,38 @@ bool LinkDebugFile::WriteGlobalsTable()
         v.push_back(address);
         v.push_back(fileId);
     }
-    IntegerColumnsVirtualTable globals(v, 4);
-    globals.Start(dbPointer);
-    globals.InsertIntoFrom("globals");
-    globals.Stop();
-
-    v.clear();
+    std::vector<sqlite3_int64>& l = localData;
     for (auto it = file->LocalBegin(); it != file->LocalEnd(); ++it)
     {
         int index = (*it)->GetIndex();
         // ObjString name = (*it)->GetName();
-        index = localMap[index];
+        index = Lookup(localMap, index);
         int address = GetSectionBase((*it)->GetOffset());
         address += (*it)->GetOffset()->EvalNoModify(0);
         int type = -1;
         if ((*it)->GetBaseType())
             type = GetTypeIndex((*it)->GetBaseType());
         int fileId = (*it)->GetSourceFile() ? (*it)->GetSourceFile()->GetIndex() : 0;
-        v.push_back(index);
-        v.push_back(type);
-        v.push_back(address);
-        v.push_back(fileId);
+        l.push_back(index);
+        l.push_back(type);
+        l.push_back(address);
+        l.push_back(fileId);
     }
-    IntegerColumnsVirtualTable locals(v, 4);
-    locals.Start(dbPointer);
-    locals.InsertIntoFrom("locals");
-    locals.Stop();
 
-    v.clear();
+    std::vector<sqlite3_int64>& vs = virtualData;
     for (auto sect : Sections)
     {
-        int n = sectionMap[sect->GetName()];
+        int n = Lookup(sectionMap, sect->GetName());
         int address = ParentSections[sect]->GetBase() + sect->GetBase();
         int type = -1;
         if (sect->GetVirtualType())
             type = GetTypeIndex(sect->GetVirtualType());
         int fileId = /*(*it)->GetSourceFile() ? sect->GetSourceFile()->GetIndex() :*/ 0;
-        v.push_back(n);
-        v.push_back(type);
-        v.push_back(address);
-        v.push_back(fileId);
+        vs.push_back(n);
+        vs.push_back(type);
+        vs.push_back(address);
+        vs.push_back(fileId);
     }
-    IntegerColumnsVirtualTable virtuals(v, 4);
-    virtuals.Start(dbPointer);
-    virtuals.InsertIntoFrom("virtuals");
-    virtuals.Stop();
-
-    return true;
 }
 class context
 {
@@ -687,9 +630,9 @@ class context
     ObjLineNo* currentLine;
     std::map<ObjSymbol*, ObjLineNo*> vars;
 };
-bool LinkDebugFile::WriteAutosTable()
+void LinkDebugFile::GatherAutosTable()
 {
-    std::vector<sqlite3_int64> v;
+    std::vector<sqlite3_int64>& v = autoData;
     std::deque<std::unique_ptr<context>> contexts;
     std::unique_ptr<context> currentContext;
     int funcId = 0;
@@ -729,7 +672,7 @@ bool LinkDebugFile::WriteAutosTable()
                             break;
                         case ObjDebugTag::eVirtualFunctionStart: {
                             ObjSection* func = tag->GetSection();
-                            funcId = sectionMap[func->GetName()];
+                            funcId = Lookup(sectionMap, func->GetName());
                         }
                             // fall through
                         case ObjDebugTag::eFunctionStart:
@@ -738,11 +681,11 @@ bool LinkDebugFile::WriteAutosTable()
                                 ObjSymbol* func = tag->GetSymbol();
                                 if (func->GetType() == ObjSymbol::ePublic)
                                 {
-                                    funcId = publicMap[func->GetIndex()];
+                                    funcId = Lookup(publicMap, func->GetIndex());
                                 }
                                 else
                                 {
-                                    funcId = localMap[func->GetIndex()];
+                                    funcId = Lookup(localMap, func->GetIndex());
                                 }
                             }
                             // fallthrough
@@ -763,7 +706,7 @@ bool LinkDebugFile::WriteAutosTable()
                             {
                                 ObjSymbol* s = obj.first;
                                 int startLine = obj.second->GetLineNumber();
-                                v.push_back(autoMap[s->GetIndex()]);
+                                v.push_back(Lookup(autoMap, s->GetIndex()));
                                 v.push_back(GetTypeIndex(s->GetBaseType()));
                                 v.push_back(funcId);
                                 v.push_back(fileId);
@@ -785,51 +728,73 @@ bool LinkDebugFile::WriteAutosTable()
             address += mem->GetSize();
         }
     }
-    IntegerColumnsVirtualTable autos(v, 7);
-    autos.Start(dbPointer);
-    autos.InsertIntoFrom("autos");
-    autos.Stop();
     contexts.clear();
-
-    return true;
 }
-bool LinkDebugFile::WriteTypeNamesTable()
+void LinkDebugFile::GatherTypeNamesTable()
 {
-    std::vector<sqlite3_int64> v;
+    std::vector<sqlite3_int64>& v = typeNameData;
     for (auto it = file->TypeBegin(); it != file->TypeEnd(); ++it)
     {
         ObjString name = (*it)->GetName();
         if (!name.empty())
         {
             int index = (*it)->GetIndex();
-            v.push_back(typeMap[index]);
+            v.push_back(Lookup(typeMap, index));
             v.push_back(index);
         }
     }
-    IntegerColumnsVirtualTable tns(v, 2, true);
-    tns.Start(dbPointer);
-    tns.InsertIntoFrom("typenames");
-    tns.Stop();
-    return true;
+}
+bool LinkDebugFile::WriteTables()
+{
+    std::vector<sqlite3_int64> nameData, mappingData;
+    for (int i = 0; i < nameList.size(); i++)
+        nameData.push_back(i + 1);
+    for (auto map : CPPMappingList)
+    {
+        mappingData.push_back(map.simpleId);
+        mappingData.push_back(map.complexId);
+    }
+    LinkerColumnsWithNameVirtualTable fileNames(fileNameData, fileNameStrings, 2, true);
+    IntegerColumnsVirtualTable lines(lineData, 3);
+    LinkerColumnsWithNameVirtualTable types(typeData, typeStrings, 11, true);
+    IntegerColumnsVirtualTable args(argData, 3);
+    IntegerColumnsVirtualTable fields(fieldData, 5);
+    IntegerColumnsVirtualTable globals(globalData, 4);
+    IntegerColumnsVirtualTable locals(localData, 4);
+    IntegerColumnsVirtualTable virtuals(virtualData, 4);
+    IntegerColumnsVirtualTable autos(autoData, 7);
+    IntegerColumnsVirtualTable typeNames(typeNameData, 2, true);
+    LinkerColumnsWithNameVirtualTable names(nameData, nameList, 2, true);
+    IntegerColumnsVirtualTable mapping(mappingData, 2);
+    return BulkInsert(fileNames, "filenames") && BulkInsert(lines, "linenumbers") && BulkInsert(types, "types") &&
+           BulkInsert(args, "args") && BulkInsert(fields, "fields") && BulkInsert(globals, "globals") &&
+           BulkInsert(locals, "locals") && BulkInsert(virtuals, "virtuals") && BulkInsert(autos, "autos") &&
+           BulkInsert(typeNames, "typenames") && BulkInsert(names, "names") && BulkInsert(mapping, "cppnamemapping");
 }
 bool LinkDebugFile::CreateOutput()
 {
     bool ok = DBOpen((char*)outputFile.c_str());
     if (ok)
     {
-        ok = false;
-        //        Begin();
-        if (WriteFileNames())
-            if (WriteLineNumbers())
-                if (WriteVariableTypes())
-                    if (WriteVariableNames())
-                        if (WriteGlobalsTable())
-                            if (WriteAutosTable())
-                                if (WriteTypeNamesTable())
-                                    if (WriteNamesTable())
-                                        if (CreateIndexes())
-                                            ok = true;
-        //        End();
+        // names are numbered in the order they are first seen so they are assigned on this thread,
+        // other tables are gathered alongside them.  Only the globals walk touches section offsets.
+        std::thread lines([this]() {
+            GatherFileNames();
+            GatherLineNumbers();
+        });
+        std::thread types([this]() { GatherVariableTypes(); });
+        GatherFields();
+        ok = GatherVariableNames();
+        std::thread autos([this]() {
+            GatherAutosTable();
+            GatherTypeNamesTable();
+        });
+        if (ok)
+            GatherGlobalsTable();
+        lines.join();
+        types.join();
+        autos.join();
+        ok = ok && Begin() && WriteTables() && CreateIndexes() && End();
     }
     if (dbPointer)
         sqlite3_close(dbPointer);
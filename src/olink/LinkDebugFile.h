@@ -29,6 +29,7 @@
 #include <map>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include "sqlvt.h"
 #include <deque>
 class ObjFile;
@@ -52,18 +53,25 @@ class LinkDebugFile
     bool CreateTables(void);
     bool CreateIndexes(void);
     bool DBOpen(char* name);
-    bool WriteFileNames();
-    bool WriteLineNumbers();
+    bool BulkInsert(SQL3VirtualTable& table, const char* name);
+    void GatherFileNames();
+    void GatherLineNumbers();
     void PushCPPName(const ObjString& name, int n);
     int GetSQLNameId(const ObjString& name);
-    bool WriteNamesTable();
-    bool WriteVariableTypes();
-    bool WriteVariableNames();
+    void GatherVariableTypes();
+    void GatherFields();
+    bool GatherVariableNames();
     ObjInt GetSectionBase(ObjExpression* e);
-    bool WriteGlobalsTable();
-    bool WriteVirtualsTable();
-    bool WriteAutosTable();
-    bool WriteTypeNamesTable();
+    void GatherGlobalsTable();
+    void GatherAutosTable();
+    void GatherTypeNamesTable();
+    bool WriteTables();
+    template <class T>
+    static int Lookup(std::map<T, int>& map, const T& key)
+    {
+        auto it = map.find(key);
+        return it == map.end() ? 0 : it->second;
+    }
     int GetTypeIndex(ObjType* Type)
     {
         if (Type->GetType() < ObjType::eVoid)
@@ -82,12 +90,16 @@ class LinkDebugFile
     std::vector<ObjSection*>& Sections;
     ObjFile* file;
     sqlite3* dbPointer;
-    std::map<ObjString, int> names;
+    std::unordered_map<ObjString, int> names;
     std::map<std::string, int> sectionMap;
     std::map<int, int> publicMap, localMap, autoMap, typeMap;
     std::vector<ObjString> nameList;
     std::map<ObjSection*, ObjSection*> ParentSections;
     std::deque<CPPMapping> CPPMappingList;
+    // rows for each table, gathered before anything is written
+    std::vector<sqlite3_int64> fileNameData, lineData, typeData, argData, fieldData;
+    std::vector<sqlite3_int64> globalData, localData, virtualData, autoData, typeNameData;
+    std::vector<ObjString> fileNameStrings, typeStrings;
     static const char* tables;
     static const char* pragmas;
     static const char* indexes;
@@ -0,0 +1,215 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ * 
+ */
+
+#include "BuildCache.h"
+#include "ParseCache.h"
+#include "Rule.h"
+#include "Eval.h"
+#include "Maker.h"
+#include "Spawner.h"
+#include "MappedFile.h"
+#include "os.h"
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+#ifdef TARGET_OS_WINDOWS
+#    include <direct.h>
+#endif
+
+BuildCache* BuildCache::active;
+
+BuildCache::BuildCache(const std::string& HashFile, const std::string& OutputDir) :
+    hashFile(HashFile), outputDir(OutputDir), changed(false)
+{
+    if (hashFile.empty() && outputDir.empty())
+        return;
+    if (!hashFile.empty())
+    {
+        std::fstream in(hashFile, std::ios::in);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            size_t n = line.find(' ');
+            if (n != std::string::npos)
+                keys[line.substr(n + 1)] = line.substr(0, n);
+        }
+    }
+    if (!outputDir.empty())
+    {
+        if (outputDir.back() != '/' && outputDir.back() != '\\')
+            outputDir += "/";
+#ifdef TARGET_OS_WINDOWS
+        _mkdir(outputDir.c_str());
+#else
+        mkdir(outputDir.c_str(), 0777);
+#endif
+    }
+    active = this;
+}
+BuildCache::~BuildCache()
+{
+    Save();
+    if (active == this)
+        active = nullptr;
+}
+std::string BuildCache::FileHash(const std::string& name)
+{
+    {
+        std::lock_guard<decltype(lock)> lk(lock);
+        auto it = fileHashes.find(name);
+        if (it != fileHashes.end())
+            return it->second;
+    }
+    std::string rv;
+    MappedFile file(name);
+    if (file.IsOpen())
+        rv = ParseCache::Hash(file.Data(), file.Size());
+    std::lock_guard<decltype(lock)> lk(lock);
+    fileHashes[name] = rv;
+    return rv;
+}
+std::string BuildCache::Key(const std::string& goal, std::shared_ptr<RuleList>& ruleList, std::shared_ptr<Command>& commands)
+{
+    std::string desc = goal + "\n";
+    {
+        std::lock_guard<decltype(OS::GetConsoleMutex())> lck(OS::GetConsoleMutex());
+        for (auto&& cmd : *commands)
+        {
+            if (cmd.find("$(MAKE)") != std::string::npos || cmd.find("${MAKE}") != std::string::npos)
+                return "";
+            Eval c(cmd, false, ruleList, nullptr);
+            desc += c.Evaluate() + "\n";
+        }
+    }
+    for (auto& rule : *ruleList)
+    {
+        std::string working = rule->GetPrerequisites();
+        while (!working.empty())
+        {
+            std::string thisOne = Eval::ExtractFirst(working, " ");
+            desc += thisOne + "=" + FileHash(Maker::GetFullName(thisOne)) + "\n";
+        }
+    }
+    return ParseCache::Hash((const unsigned char*)desc.c_str(), desc.size());
+}
+std::string BuildCache::CacheName(const std::string& key)
+{
+    std::string rv = outputDir + key;
+    rv[rv.find(':')] = '-';
+    return rv;
+}
+bool BuildCache::CopyFile(const std::string& from, const std::string& to)
+{
+    std::fstream in(from, std::ios::in | std::ios::binary);
+    if (!in.is_open())
+        return false;
+    std::string tempName = to + ".tmp";
+    bool ok;
+    {
+        std::fstream out(tempName, std::ios::out | std::ios::binary);
+        out << in.rdbuf();
+        out.close();
+        ok = !out.fail();
+    }
+#ifndef TARGET_OS_WINDOWS
+    // keep the permissions, a cached executable has to stay executable
+    struct stat st;
+    if (ok && stat(from.c_str(), &st) == 0)
+        ok = chmod(tempName.c_str(), st.st_mode & 07777) == 0;
+#endif
+    if (ok)
+    {
+#ifdef TARGET_OS_WINDOWS
+        remove(to.c_str());
+#endif
+        ok = rename(tempName.c_str(), to.c_str()) == 0;
+    }
+    if (!ok)
+        remove(tempName.c_str());
+    return ok;
+}
+bool BuildCache::Restore(const std::string& goal, const std::string& key)
+{
+    bool upToDate;
+    {
+        std::lock_guard<decltype(lock)> lk(lock);
+        auto it = keys.find(goal);
+        upToDate = it != keys.end() && it->second == key;
+    }
+    if (upToDate && !!OS::GetFileTime(goal))
+    {
+        // bring the time up to date too so the next run doesn't have to look at the contents again
+        OS::SetFileTime(goal, OS::GetCurrentTime());
+        return true;
+    }
+    if (!outputDir.empty() && CopyFile(CacheName(key), goal))
+    {
+        std::lock_guard<decltype(lock)> lk(lock);
+        keys[goal] = key;
+        fileHashes.erase(goal);
+        changed = true;
+        return true;
+    }
+    return false;
+}
+void BuildCache::Built(const std::string& goal, const std::string& key)
+{
+    {
+        std::lock_guard<decltype(lock)> lk(lock);
+        fileHashes.erase(goal);
+        // a rule that didn't make its target can't be skipped next time
+        if (!OS::GetFileTime(goal))
+            return;
+        keys[goal] = key;
+        changed = true;
+    }
+    if (!outputDir.empty())
+        CopyFile(goal, CacheName(key));
+}
+void BuildCache::Save()
+{
+    std::lock_guard<decltype(lock)> lk(lock);
+    if (!changed || hashFile.empty())
+        return;
+    changed = false;
+    std::string tempName = hashFile + ".tmp";
+    FILE* fil = fopen(tempName.c_str(), "w");
+    if (fil)
+    {
+        bool ok = true;
+        for (auto&& k : keys)
+            ok &= fprintf(fil, "%s %s\n", k.second.c_str(), k.first.c_str()) >= 0;
+        ok &= fclose(fil) == 0;
+        if (ok)
+        {
+#ifdef TARGET_OS_WINDOWS
+            remove(hashFile.c_str());
+#endif
+            ok = rename(tempName.c_str(), hashFile.c_str()) == 0;
+        }
+        if (!ok)
+            remove(tempName.c_str());
+    }
+}
@@ -0,0 +1,74 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ * 
+ */
+
+#ifndef BUILDCACHE_H
+#define BUILDCACHE_H
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+class RuleList;
+class Command;
+
+/* rebuild decisions by content instead of by time.  Before the commands for a target run
+ * a key is made from the target name, its commands with the variables expanded, and a hash
+ * of the contents of each of its prerequisites.  When the hash file says the target was
+ * last built with the same key the commands are skipped and the target is just touched.
+ * Otherwise if the output cache directory has a copy of the target from a build with that
+ * key it is copied back instead of running the commands.  After the commands run
+ * successfully the key is remembered and the target is copied into the output cache.
+ *
+ * only the target itself goes into the output cache; other files the commands write
+ * aren't known about.  Recursive makes and phony targets are always run.
+ */
+class BuildCache
+{
+  public:
+    BuildCache(const std::string& HashFile, const std::string& OutputDir);
+    ~BuildCache();
+
+    static BuildCache* Active() { return active; }
+    std::string Key(const std::string& goal, std::shared_ptr<RuleList>& ruleList, std::shared_ptr<Command>& commands);
+    bool Restore(const std::string& goal, const std::string& key);
+    void Built(const std::string& goal, const std::string& key);
+    void Save();
+
+  protected:
+    std::string FileHash(const std::string& name);
+    std::string CacheName(const std::string& key);
+    static bool CopyFile(const std::string& from, const std::string& to);
+
+  private:
+    std::string hashFile;
+    std::string outputDir;
+    bool changed;
+    std::mutex lock;
+    std::unordered_map<std::string, std::string> keys;
+    std::unordered_map<std::string, std::string> fileHashes;
+    static BuildCache* active;
+};
+#endif
@@ -26,6 +26,7 @@
 #include "Eval.h"
 #include "Rule.h"
 #include "CmdFiles.h"
+#include "ParseCache.h"
 #include "Variable.h"
 #include "Parser.h"
 #include "Spawner.h"
@@ -56,6 +57,8 @@ std::string Eval::GPath;
 int Eval::errcount;
 std::vector<std::string> Eval::callArgs;
 std::mutex Eval::evalLock;
+std::unordered_map<std::string, std::shared_ptr<Expansion>> Eval::expansions;
+std::mutex Eval::expansionLock;
 std::unordered_map<std::string, Eval::StringFunc> Eval::builtins = {{"subst", &Eval::subst},
                                                                     {"patsubst", &Eval::patsubst},
                                                                     {"strip", &Eval::strip},
@@ -93,6 +96,38 @@ std::unordered_map<std::string, Eval::StringFunc> Eval::builtins = {{"subst", &E
                                                                     {"info", &Eval::info},
                                                                     {"exists", &Eval::exists}};
 
+// hands out the words in a list the same way calling ExtractFirst(list, " ") over and over would,
+// but when there are no quotes or escapes to deal with it walks the list in place instead of
+// moving the rest of it down after every word
+class WordWalker
+{
+  public:
+    WordWalker(std::string& List) : list(List), pos(0), plain(List.find_first_of("\"'\\") == std::string::npos) {}
+    bool Done() const { return plain ? pos >= list.size() : list.empty(); }
+    std::string Next()
+    {
+        if (!plain)
+            return Eval::ExtractFirst(list, " ");
+        pos = list.find_first_not_of(' ', pos);
+        if (pos == std::string::npos)
+            pos = list.size();
+        size_t end = list.find_first_of(" \t\n", pos);
+        if (end == std::string::npos)
+            end = list.size();
+        std::string rv = list.substr(pos, end - pos);
+        if (list.find_first_not_of(" \t", end) == std::string::npos)
+            pos = list.size();
+        else
+            pos = end + 1;
+        return rv;
+    }
+
+  private:
+    std::string& list;
+    size_t pos;
+    bool plain;
+};
+
 Eval::Eval(const std::string name, bool ExpandWildcards, std::shared_ptr<RuleList> RuleList, std::shared_ptr<Rule> Rule) :
     str(name), expandWildcards(ExpandWildcards), ruleList(RuleList), rule(Rule)
 {
@@ -107,6 +142,7 @@ void Eval::Clear()
     ruleStack.clear();
     foreachVars.clear();
     macroset.clear();
+    expansions.clear();
     errcount = 0;
 }
 
@@ -114,7 +150,11 @@ std::string Eval::Evaluate()
 {
     std::string rv = ParseMacroLine(str);
     if (expandWildcards)
+    {
+        std::string names = rv;
         rv = wildcardinternal(rv);
+        ParseCache::Probe('X', names, rv);
+    }
     return rv;
 }
 
@@ -254,12 +294,30 @@ size_t Eval::MacroSpan(const std::string line, size_t pos)
 }
 std::string Eval::ParseMacroLine(const std::string& in)
 {
+    if (in.find_first_of('$') == std::string::npos)
+        return in;
     std::string rv;
+    Expand(*LookupExpansion(in), rv);
+    return rv;
+}
+void Expansion::AddLiteral(const std::string& text)
+{
+    if (!text.empty())
+    {
+        if (!parts.empty() && parts.back().kind == literal)
+            parts.back().text += text;
+        else
+            parts.push_back(Part{literal, text, nullptr, ""});
+    }
+}
+std::shared_ptr<Expansion> Eval::Compile(const std::string& in)
+{
+    auto rv = std::make_shared<Expansion>();
     int n = 0;
     int m = in.find_first_of('$');
     while (m != std::string::npos)
     {
-        rv += in.substr(n, m - n);
+        rv->AddLiteral(in.substr(n, m - n));
         if (m != in.size() - 1 && in[m + 1] == '$')
         {
             n = m + 1;
@@ -268,22 +326,11 @@ std::string Eval::ParseMacroLine(const std::string& in)
                 m = 1;
             if (in[n + 1] == '(' && m >= 3)
             {
-                rv += "$(";
                 std::string temp = in.substr(n + 2, m - 3);
-                for (size_t q = 0; q < temp.size() - 1; q++)
-                {
-                    if (temp[q] == '$')
-                    {
-                        std::string temp1 = temp.substr(q + 1, 1), temp2;
-                        if (AutomaticVar(temp1, temp2))
-                        {
-                            temp = temp.substr(0, q) + temp2 + (q < temp.size() - 2 ? temp.substr(q + 2) : "");
-                            q += temp2.size() - 2;
-                        }
-                    }
-                }
-                rv += temp;
-                rv += ")";
+                if (temp.find_first_of('$') == std::string::npos)
+                    rv->AddLiteral("$(" + temp + ")");
+                else
+                    rv->parts.push_back(Expansion::Part{Expansion::escaped, temp, nullptr, ""});
                 n = m + n;
                 m = 0;
             }
@@ -294,21 +341,139 @@ std::string Eval::ParseMacroLine(const std::string& in)
             n = MacroSpan(in, m + 1);
             if (n == 1 || n == 2)
             {
-                rv += ExpandMacro(in.substr(m + 1, n));
+                CompileMacro(*rv, in.substr(m + 1, n));
                 n = m + 1 + n;
             }
             else if (n != std::string::npos)
             {
-                rv += ExpandMacro(in.substr(m + 2, n - 2));
+                CompileMacro(*rv, in.substr(m + 2, n - 2));
                 n = m + n + 1;
             }
             m = in.find_first_of('$', n);
         }
     }
     if (n != std::string::npos)
-        rv += in.substr(n);
+        rv->AddLiteral(in.substr(n));
     return rv;
 }
+void Eval::CompileMacro(Expansion& expansion, const std::string& name)
+{
+    Expansion::Part part{Expansion::macro, name, nullptr, ""};
+    if (!name.empty() && name != ".VARIABLES" && name[0] != '$' && !isdigit(name[0]))
+    {
+        std::string temp = name;
+        std::string fw = ExtractFirst(temp, " ");
+        auto it = builtins.find(fw);
+        size_t z = std::string::npos;
+        if (it != builtins.end())
+            z = name.find_first_not_of(' ', fw.size());
+        if (z != std::string::npos)
+        {
+            part.kind = Expansion::function;
+            part.func = it->second;
+            part.args = name.substr(z);
+        }
+        else if (name.find_first_of(':') == std::string::npos)
+        {
+            part.kind = Expansion::variable;
+        }
+    }
+    expansion.parts.push_back(std::move(part));
+}
+std::shared_ptr<Expansion> Eval::LookupExpansion(const std::string& in)
+{
+    std::lock_guard<decltype(expansionLock)> lk(expansionLock);
+    auto it = expansions.find(in);
+    if (it != expansions.end())
+        return it->second;
+    // this sees the results of $(call) and friends as well as makefile text, don't let it grow without bound
+    if (expansions.size() >= 16384)
+        expansions.clear();
+    auto rv = Compile(in);
+    expansions[in] = rv;
+    return rv;
+}
+std::shared_ptr<Expansion> Eval::LookupExpansion(Variable* v)
+{
+    std::lock_guard<decltype(expansionLock)> lk(expansionLock);
+    auto rv = v->GetExpansion();
+    if (!rv)
+    {
+        rv = Compile(v->GetValue());
+        v->SetExpansion(rv);
+    }
+    return rv;
+}
+void Eval::Expand(const Expansion& expansion, std::string& rv)
+{
+    for (auto&& part : expansion.parts)
+    {
+        switch (part.kind)
+        {
+            case Expansion::literal:
+                rv += part.text;
+                break;
+            case Expansion::escaped: {
+                std::string temp = part.text;
+                for (size_t q = 0; q < temp.size() - 1; q++)
+                {
+                    if (temp[q] == '$')
+                    {
+                        std::string temp1 = temp.substr(q + 1, 1), temp2;
+                        if (AutomaticVar(temp1, temp2))
+                        {
+                            temp = temp.substr(0, q) + temp2 + (q < temp.size() - 2 ? temp.substr(q + 2) : "");
+                            q += temp2.size() - 2;
+                        }
+                    }
+                }
+                rv += "$(";
+                rv += temp;
+                rv += ")";
+                break;
+            }
+            case Expansion::variable: {
+                std::string temp;
+                if (ruleList && part.text.size() <= 2 && AutomaticVar(part.text, temp))
+                {
+                    rv += temp;
+                    break;
+                }
+                Variable* v = LookupVariable(part.text);
+                if (v)
+                {
+                    ExpandVariable(v, rv);
+                }
+                else if (internalWarnings)
+                {
+                    temp = part.text;
+                    warning("'" + ExtractFirst(temp, " ") + "' is undefined.");
+                }
+                break;
+            }
+            case Expansion::function:
+                rv += (this->*(part.func))(part.args);
+                break;
+            case Expansion::macro:
+                rv += ExpandMacro(part.text);
+                break;
+        }
+    }
+}
+void Eval::ExpandVariable(Variable* v, std::string& rv)
+{
+    if (v->GetFlavor() == Variable::f_recursive && macroset.find(v->GetName()) == macroset.end())
+    {
+        auto p = macroset.insert(v->GetName());
+        auto expansion = LookupExpansion(v);
+        Expand(*expansion, rv);
+        macroset.erase(p.first);
+    }
+    else
+    {
+        rv += v->GetValue();
+    }
+}
 Variable* Eval::LookupVariable(const std::string& name)
 {
     Variable* v = nullptr;
@@ -550,11 +715,12 @@ std::string Eval::ExpandMacro(const std::string& name)
         return rv;
     if (name == ".VARIABLES")
     {
-        for (auto& var : *VariableContainer::Instance())
+        ParseCache::ConsultAll();
+        for (auto var : VariableContainer::Instance()->Sorted())
         {
             if (!rv.empty())
                 rv += " ";
-            rv += var.first;
+            rv += var->GetName();
         }
     }
     else if (name[0] == '$')
@@ -562,8 +728,7 @@ std::string Eval::ExpandMacro(const std::string& name)
         size_t n = MacroSpan(name, 1);
         rv = name.substr(0, n + 1);
         extra = std::string(name.substr(n + 1));
-        Eval a(rv, false, ruleList, rule);
-        rv = a.Evaluate();
+        rv = ParseMacroLine(rv);
     }
     else
     {
@@ -594,31 +759,20 @@ std::string Eval::ExpandMacro(const std::string& name)
             {
                 extra = name.substr(m);
                 rv = name.substr(0, m);
-                Eval a(extra, false, ruleList, rule);
-                extra = a.Evaluate();
+                extra = ParseMacroLine(extra);
             }
             else
             {
                 rv = name;
             }
-            bool found = false;
             Variable* v = LookupVariable(rv);
+            rv = "";
             if (v)
             {
-                rv = v->GetValue();
-                if (v->GetFlavor() == Variable::f_recursive)
-                {
-                    if (macroset.find(v->GetName()) == macroset.end())
-                    {
-                        auto p = macroset.insert(v->GetName());
-                        rv = ParseMacroLine(rv);
-                        macroset.erase(p.first);
-                    }
-                }
+                ExpandVariable(v, rv);
             }
             else
             {
-                rv = "";
                 if (internalWarnings)
                 {
                     warning("'" + fw + "' is undefined.");
@@ -869,12 +1023,9 @@ std::string Eval::subst(const std::string& arglist)
     std::string text;
     if (ThreeArgs(arglist, from, to, text))
     {
-        Eval f(from, false, ruleList, rule);
-        from = f.Evaluate();
-        Eval t(to, false, ruleList, rule);
-        to = t.Evaluate();
-        Eval x(text, false, ruleList, rule);
-        text = x.Evaluate();
+        from = ParseMacroLine(from);
+        to = ParseMacroLine(to);
+        text = ParseMacroLine(text);
         int m = text.find(from);
         while (m != std::string::npos)
         {
@@ -892,18 +1043,16 @@ std::string Eval::patsubst(const std::string& arglist)
     std::string text;
     if (ThreeArgs(arglist, pattern, replacement, text))
     {
-        Eval o(pattern, false, ruleList, rule);
-        pattern = o.Evaluate();
-        Eval t(replacement, false, ruleList, rule);
-        replacement = t.Evaluate();
-        Eval r(text, false, ruleList, rule);
-        text = r.Evaluate();
+        pattern = ParseMacroLine(pattern);
+        replacement = ParseMacroLine(replacement);
+        text = ParseMacroLine(text);
         size_t start;
         size_t n = 0;
         std::string rv;
-        while (!text.empty())
+        WordWalker walker(text);
+        while (!walker.Done())
         {
-            std::string thisOne = ExtractFirst(text, " ");
+            std::string thisOne = walker.Next();
             if (MatchesPattern(thisOne, pattern, start, 0) != std::string::npos)
             {
                 std::string stem = FindStem(thisOne, pattern);
@@ -920,8 +1069,7 @@ std::string Eval::patsubst(const std::string& arglist)
 std::string Eval::strip(const std::string& arglist)
 {
     std::string rv;
-    Eval e(arglist, false, ruleList, rule);
-    std::string a = e.Evaluate();
+    std::string a = ParseMacroLine(arglist);
     size_t m = a.find_first_not_of("\t ");
     size_t n = a.find_first_of("\t ", m);
     while (n != std::string::npos)
@@ -944,10 +1092,8 @@ std::string Eval::findstring(const std::string& arglist)
     std::string rv;
     if (TwoArgs(arglist, find, in))
     {
-        Eval f(find, false, ruleList, rule);
-        find = f.Evaluate();
-        Eval i(in, false, ruleList, rule);
-        in = i.Evaluate();
+        find = ParseMacroLine(find);
+        in = ParseMacroLine(in);
         if (in.find(find) != std::string::npos)
             rv = find;
     }
@@ -960,14 +1106,13 @@ std::string Eval::filter(const std::string& arglist)
     std::string rv;
     if (TwoArgs(arglist, pattern, text))
     {
-        Eval p(pattern, false, ruleList, rule);
-        pattern = p.Evaluate();
-        Eval t(text, false, ruleList, rule);
-        text = t.Evaluate();
-        while (!text.empty())
+        pattern = ParseMacroLine(pattern);
+        text = ParseMacroLine(text);
+        WordWalker walker(text);
+        while (!walker.Done())
         {
             std::string working = pattern;
-            std::string fw = ExtractFirst(text, " ");
+            std::string fw = walker.Next();
             while (!working.empty())
             {
                 std::string p = ExtractFirst(working, " ");
@@ -990,14 +1135,13 @@ std::string Eval::filterout(const std::string& arglist)
     std::string rv;
     if (TwoArgs(arglist, pattern, text))
     {
-        Eval p(pattern, false, ruleList, rule);
-        pattern = p.Evaluate();
-        Eval t(text, false, ruleList, rule);
-        text = t.Evaluate();
-        while (!text.empty())
+        pattern = ParseMacroLine(pattern);
+        text = ParseMacroLine(text);
+        WordWalker walker(text);
+        while (!walker.Done())
         {
             std::string working = pattern;
-            std::string fw = ExtractFirst(text, " ");
+            std::string fw = walker.Next();
             bool notfound = true;
             while (!working.empty())
             {
@@ -1018,11 +1162,11 @@ std::string Eval::filterout(const std::string& arglist)
 std::string Eval::sort(const std::string& arglist)
 {
     std::set<std::string> sortList;
-    Eval a(arglist, false, ruleList, rule);
-    std::string working = a.Evaluate();
-    while (!working.empty())
+    std::string working = ParseMacroLine(arglist);
+    WordWalker walker(working);
+    while (!walker.Done())
     {
-        sortList.insert(ExtractFirst(working, " "));
+        sortList.insert(walker.Next());
     }
     std::string rv;
     for (auto&& strng : sortList)
@@ -1040,10 +1184,8 @@ std::string Eval::word(const std::string& arglist)
     std::string rv;
     if (TwoArgs(arglist, count, text))
     {
-        Eval c(count, false, ruleList, rule);
-        count = c.Evaluate();
-        Eval t(text, false, ruleList, rule);
-        text = t.Evaluate();
+        count = ParseMacroLine(count);
+        text = ParseMacroLine(text);
         int n = GetNumber(count);
         for (int i = 0; i < n; i++)
         {
@@ -1065,12 +1207,9 @@ std::string Eval::wordlist(const std::string& arglist)
     std::string rv;
     if (ThreeArgs(arglist, start, end, text))
     {
-        Eval s(start, false, ruleList, rule);
-        start = s.Evaluate();
-        Eval e(end, false, ruleList, rule);
-        end = e.Evaluate();
-        Eval t(text, false, ruleList, rule);
-        text = t.Evaluate();
+        start = ParseMacroLine(start);
+        end = ParseMacroLine(end);
+        text = ParseMacroLine(text);
         int sn = GetNumber(start);
         int en = GetNumber(end);
         for (int i = 1; i < sn; i++)
@@ -1097,17 +1236,17 @@ std::string Eval::wordlist(const std::string& arglist)
 std::string Eval::words(const std::string& arglist)
 {
     std::string text;
-    Eval t(arglist, false, ruleList, rule);
-    text = t.Evaluate();
+    text = ParseMacroLine(arglist);
     size_t n = 0;
     size_t count = 0;
     n = text.find_first_not_of(' ');
     if (n != std::string::npos)
     {
-        while (!text.empty())
+        WordWalker walker(text);
+        while (!walker.Done())
         {
             count++;
-            ExtractFirst(text, " ");
+            walker.Next();
         }
     }
     std::string rv = Utils::NumberToString(count);
@@ -1116,16 +1255,14 @@ std::string Eval::words(const std::string& arglist)
 std::string Eval::firstword(const std::string& arglist)
 {
     std::string text;
-    Eval t(arglist, false, ruleList, rule);
-    text = t.Evaluate();
+    text = ParseMacroLine(arglist);
     return ExtractFirst(text, " ");
 }
 
 std::string Eval::lastword(const std::string& arglist)
 {
     std::string text;
-    Eval t(arglist, false, ruleList, rule);
-    text = t.Evaluate();
+    text = ParseMacroLine(arglist);
     size_t n = text.find_last_not_of(' ');
     std::string rv;
     if (n != std::string::npos)
@@ -1141,12 +1278,12 @@ std::string Eval::lastword(const std::string& arglist)
 std::string Eval::dir(const std::string& names)
 {
     std::string working = names;
-    Eval w(working, false, ruleList, rule);
-    working = w.Evaluate();
+    working = ParseMacroLine(working);
     std::string rv;
-    while (!working.empty())
+    WordWalker walker(working);
+    while (!walker.Done())
     {
-        std::string p = ExtractFirst(working, " ");
+        std::string p = walker.Next();
         size_t n = p.find_last_of("/\\");
         if (!rv.empty())
             rv += " ";
@@ -1161,12 +1298,12 @@ std::string Eval::dir(const std::string& names)
 std::string Eval::notdir(const std::string& names)
 {
     std::string working = names;
-    Eval w(working, false, ruleList, rule);
-    working = w.Evaluate();
+    working = ParseMacroLine(working);
     std::string rv;
-    while (!working.empty())
+    WordWalker walker(working);
+    while (!walker.Done())
     {
-        std::string p = ExtractFirst(working, " ");
+        std::string p = walker.Next();
         size_t n = p.find_last_of("/\\");
         std::string intermed;
         if (n != std::string::npos)
@@ -1183,12 +1320,12 @@ std::string Eval::notdir(const std::string& names)
 std::string Eval::suffix(const std::string& names)
 {
     std::string working = names;
-    Eval w(working, false, ruleList, rule);
-    working = w.Evaluate();
+    working = ParseMacroLine(working);
     std::string rv;
-    while (!working.empty())
+    WordWalker walker(working);
+    while (!walker.Done())
     {
-        std::string p = ExtractFirst(working, " ");
+        std::string p = walker.Next();
         size_t n = p.find_last_of('.');
         if (n != std::string::npos && (n == p.size() - 1 || (p[n + 1] != '\\' && p[n + 1] != '/')))
         {
@@ -1203,12 +1340,12 @@ std::string Eval::suffix(const std::string& names)
 std::string Eval::basename(const std::string& names)
 {
     std::string working = names;
-    Eval w(working, false, ruleList, rule);
-    working = w.Evaluate();
+    working = ParseMacroLine(working);
     std::string rv;
-    while (!working.empty())
+    WordWalker walker(working);
+    while (!walker.Done())
     {
-        std::string p = ExtractFirst(working, " ");
+        std::string p = walker.Next();
         size_t n = p.find_last_of('.');
         if (!rv.empty())
             rv += " ";
@@ -1231,17 +1368,16 @@ std::string Eval::addsuffix(const std::string& arglist)
     std::string rv;
     if (TwoArgs(arglist, suffix, names))
     {
-        Eval s(suffix, false, ruleList, rule);
-        suffix = s.Evaluate();
-        Eval n(names, false, ruleList, rule);
-        names = n.Evaluate();
+        suffix = ParseMacroLine(suffix);
+        names = ParseMacroLine(names);
         if (names.find_last_not_of(' ') != std::string::npos)
         {
-            while (!names.empty())
+            WordWalker walker(names);
+            while (!walker.Done())
             {
                 if (!rv.empty())
                     rv += " ";
-                rv += ExtractFirst(names, " ");
+                rv += walker.Next();
                 rv += suffix;
             }
         }
@@ -1256,18 +1392,17 @@ std::string Eval::addprefix(const std::string& arglist)
     std::string rv;
     if (TwoArgs(arglist, prefix, names))
     {
-        Eval p(prefix, false, ruleList, rule);
-        prefix = p.Evaluate();
-        Eval n(names, false, ruleList, rule);
-        names = n.Evaluate();
+        prefix = ParseMacroLine(prefix);
+        names = ParseMacroLine(names);
         if (names.find_last_not_of(' ') != std::string::npos)
         {
-            while (!names.empty())
+            WordWalker walker(names);
+            while (!walker.Done())
             {
                 if (!rv.empty())
                     rv += " ";
                 rv += prefix;
-                rv += ExtractFirst(names, " ");
+                rv += walker.Next();
             }
         }
     }
@@ -1278,6 +1413,7 @@ std::string Eval::wildcard(const std::string& arglist)
 {
     std::string names = strip(arglist);
     std::string rv;
+    std::string pattern = names;
     names = wildcardinternal(names);
     while (!names.empty())
     {
@@ -1290,6 +1426,8 @@ std::string Eval::wildcard(const std::string& arglist)
         }
     }
 
+    Utils::ReplaceAll(pattern, "$", "$$");
+    ParseCache::Probe('W', pattern, rv);
     return rv;
 }
 std::string Eval::wildcardinternal(std::string& names)
@@ -1383,19 +1521,16 @@ std::string Eval::condIf(const std::string& arglist)
             n = ifst.find_last_not_of(' ');
             ifst.replace(n + 1, ifst.size() - n - 1, "");
         }
-        Eval i(ifst, false, ruleList, rule);
-        ifst = i.Evaluate();
+        ifst = ParseMacroLine(ifst);
         if (ifst != "")
         {
-            Eval t(then, false, ruleList, rule);
-            rv = t.Evaluate();
+            rv = ParseMacroLine(then);
         }
         else
         {
             if (!els.empty())
             {
-                Eval e(els, false, ruleList, rule);
-                rv = e.Evaluate();
+                rv = ParseMacroLine(els);
             }
         }
     }
@@ -1411,8 +1546,7 @@ std::string Eval::condOr(const std::string& arglist)
     {
         left = right.substr(0, n);
         right.replace(0, n + 1, "");
-        Eval l(left, false, ruleList, rule);
-        left = l.Evaluate();
+        left = ParseMacroLine(left);
         if (!left.empty())
             return left;
         n = arglist.find_first_of(',');
@@ -1430,8 +1564,7 @@ std::string Eval::condAnd(const std::string& arglist)
     {
         left = right.substr(0, n);
         right.replace(0, n + 1, "");
-        Eval l(left, false, ruleList, rule);
-        left = l.Evaluate();
+        left = ParseMacroLine(left);
         if (left.empty())
             return left;
         n = right.find_first_of(',');
@@ -1448,22 +1581,21 @@ std::string Eval::foreach (const std::string& arglist)
     std::string rv;
     if (ThreeArgs(arglist, var, list, next))
     {
-        Eval v1(var, false, ruleList, rule);
-        var = v1.Evaluate();
-        Eval l(list, false, ruleList, rule);
-        list = l.Evaluate();
+        var = ParseMacroLine(var);
+        list = ParseMacroLine(list);
         if (list.find_first_not_of(' ') != std::string::npos)
         {
             std::unique_ptr<Variable> v = std::make_unique<Variable>(var, list, Variable::f_simple, Variable::o_file);
             foreachVars.push_front(v.get());
-            while (!list.empty())
+            auto body = LookupExpansion(next);
+            WordWalker walker(list);
+            while (!walker.Done())
             {
-                std::string value = ExtractFirst(list, " ");
+                std::string value = walker.Next();
                 v->SetValue(value);
-                Eval t(next, false, ruleList, rule);
                 if (!rv.empty())
                     rv += " ";
-                rv += t.Evaluate();
+                Expand(*body, rv);
             }
             foreachVars.pop_front();
         }
@@ -1487,8 +1619,7 @@ std::string Eval::call(const std::string& arglist)
         else
         {
             sub = "$(" + sub + ")";
-            Eval l(sub, false, ruleList, rule);
-            rv = l.Evaluate();
+            rv = ParseMacroLine(sub);
         }
     }
     else
@@ -1512,15 +1643,13 @@ std::string Eval::call(const std::string& arglist)
             {
                 std::string left = args.substr(0, n);
                 args.replace(0, n + 1, "");
-                Eval l1(left, false, ruleList, rule);
-                left = l1.Evaluate();
+                left = ParseMacroLine(left);
                 l.PushCallArg(left);
                 n = args.find_first_of(',');
             }
             if (!args.empty())
             {
-                Eval l1(args, false, ruleList, rule);
-                args = l1.Evaluate();
+                args = ParseMacroLine(args);
                 l.PushCallArg(args);
             }
             rv = l.Evaluate();
@@ -1618,7 +1747,10 @@ std::string Eval::shell(const std::string& arglist)
     Eval a(arglist, false, ruleList, rule);
     EnvironmentStrings empty;
     Spawner sp(empty, true, true, false, false, false, false);
-    return sp.shell(a.Evaluate());
+    std::string cmd = a.Evaluate();
+    std::string rv = sp.shell(cmd);
+    ParseCache::Probe('S', cmd, rv);
+    return rv;
 }
 
 std::string Eval::error(const std::string& arglist, const std::string fileOverride, int lineOverride)
@@ -1636,6 +1768,7 @@ std::string Eval::error(const std::string& arglist, const std::string fileOverri
     {
         os << "Error: " << arglist << std::endl;
     }
+    ParseCache::Uncacheable();
     OS::WriteToConsole(os.str());
     errcount++;
     return "";
@@ -1645,6 +1778,7 @@ std::string Eval::errorx(const std::string& arglist)
     Eval a(arglist, false, nullptr, nullptr);
     std::ostringstream os;
     std::cout << "Error " << file << "(" << lineno << "): " << a.Evaluate() << std::endl;
+    ParseCache::Uncacheable();
     OS::WriteToConsole(os.str());
     errcount++;
     return "";
@@ -1664,6 +1798,7 @@ std::string Eval::warning(const std::string& arglist, const std::string fileOver
     {
         os << "Warning: " << arglist << std::endl;
     }
+    ParseCache::Uncacheable();
     OS::WriteToConsole(os.str());
     return "";
 }
@@ -1672,6 +1807,7 @@ std::string Eval::warningx(const std::string& arglist)
     Eval a(arglist, false, nullptr, nullptr);
     std::ostringstream os;
     os << "Warning " << file << "(" << lineno << "): " << a.Evaluate() << std::endl;
+    ParseCache::Uncacheable();
     OS::WriteToConsole(os.str());
     return "";
 }
@@ -1681,15 +1817,15 @@ std::string Eval::info(const std::string& arglist)
     Eval a(arglist, false, ruleList, rule);
     std::ostringstream os;
     os << a.Evaluate() << std::endl;
+    ParseCache::Uncacheable();
     OS::WriteToConsole(os.str());
     return "";
 }
 std::string Eval::exists(const std::string& arglist)
 {
-    Eval a(arglist, false, ruleList, rule);
-    std::string fileName = a.Evaluate();
+    std::string fileName = ParseMacroLine(arglist);
     std::fstream aa(fileName, std::ios::in);
-    if (aa.is_open())
-        return "1";
-    return "0";
+    std::string rv = aa.is_open() ? "1" : "0";
+    ParseCache::Probe('E', fileName, rv);
+    return rv;
 }
@@ -33,14 +33,18 @@
 #include <set>
 #include "os.h"
 #include <mutex>
+#include <memory>
 class RuleList;
 class Rule;
 class Variable;
+class Expansion;
 
 #define SpaceThunk "\xff"
 
 class Eval
 {
+    friend class ParseCache;
+
   public:
     Eval(const std::string name, bool expandWildcards, std::shared_ptr<RuleList> ruleList = nullptr, std::shared_ptr<Rule> rule = nullptr);
     ~Eval() {}
@@ -85,9 +89,14 @@ class Eval
     static std::string AdjustForSpaces(const std::string& in);
     static size_t MacroSpan(const std::string iline, size_t pos);
     std::string ParseMacroLine(const std::string& in);
+    static std::shared_ptr<Expansion> Compile(const std::string& in);
+    static std::shared_ptr<Expansion> LookupExpansion(const std::string& in);
+    static std::shared_ptr<Expansion> LookupExpansion(Variable* v);
+    void Expand(const Expansion& expansion, std::string& rv);
     static Variable* LookupVariable(const std::string& name);
     bool AutomaticVar(const std::string& name, std::string& rv);
     std::string ExpandMacro(const std::string& name);
+    void ExpandVariable(Variable* v, std::string& rv);
     static size_t FindPercent(const std::string& name, size_t pos = 0);
     static std::string FindStem(const std::string& name, const std::string& pattern);
     static std::string ReplaceQuotes(const std::string& value);
@@ -141,9 +150,13 @@ class Eval
     // internal
     static int GetErrCount() { return errcount; }
 
-  private:
     typedef std::string (Eval::*StringFunc)(const std::string& arglist);
+
+  private:
+    static void CompileMacro(Expansion& expansion, const std::string& name);
     static std::unordered_map<std::string, StringFunc> builtins;
+    static std::unordered_map<std::string, std::shared_ptr<Expansion>> expansions;
+    static std::mutex expansionLock;
     static std::string VPath;
     static std::unordered_map<std::string, std::string> vpaths;
     static bool internalWarnings;
@@ -161,4 +174,28 @@ class Eval
     bool expandWildcards;
     static int errcount;
 };
+
+// a string broken up into its literal text and the macros in it, so that it is only
+// scanned once no matter how many times it gets expanded
+class Expansion
+{
+  public:
+    enum Kind
+    {
+        literal,
+        escaped,   // $$(...), automatic variables inside still get replaced
+        variable,  // a plain variable reference
+        function,  // a builtin function with its arguments
+        macro      // anything else, ExpandMacro works it out
+    };
+    struct Part
+    {
+        Kind kind;
+        std::string text;
+        Eval::StringFunc func;
+        std::string args;
+    };
+    void AddLiteral(const std::string& text);
+    std::vector<Part> parts;
+};
 #endif
\ No newline at end of file
@@ -30,6 +30,7 @@
 #include "Variable.h"
 #include "Maker.h"
 #include "Rule.h"
+#include "ParseCache.h"
 #include <fstream>
 #include <iostream>
 #include <cstring>
@@ -64,6 +65,7 @@ bool Include::Parse(const std::string& name, bool ignoreOk, bool MakeFiles)
     if (name == "-")
     {
         rv = true;
+        ParseCache::Uncacheable();
         std::string inputFile;
         while (!std::cin.eof())
         {
@@ -86,6 +88,7 @@ bool Include::Parse(const std::string& name, bool ignoreOk, bool MakeFiles)
         std::string current = name;
         if (access(current.c_str(), 0) == -1)
         {
+            ParseCache::Missing(current);
             std::string includeDirs;
             Variable* id = VariableContainer::Instance()->Lookup(".INCLUDE_DIRS");
             if (id)
@@ -102,6 +105,7 @@ bool Include::Parse(const std::string& name, bool ignoreOk, bool MakeFiles)
                 current = Eval::ExtractFirst(includeDirs, ";") + "\\" + name;
                 if (access(current.c_str(), 0) != -1)
                     break;
+                ParseCache::Missing(current);
             }
         }
         std::fstream in(current, std::ios::in | std::ios::binary);
@@ -116,6 +120,7 @@ bool Include::Parse(const std::string& name, bool ignoreOk, bool MakeFiles)
                 in.read(text.get(), len);
                 text.get()[len] = 0;
                 in.close();
+                ParseCache::File(current, text.get(), len);
                 char *p = text.get(), *q = p;
                 while (*p)
                     if (*p != '\r')
@@ -135,7 +140,7 @@ bool Include::Parse(const std::string& name, bool ignoreOk, bool MakeFiles)
         }
         else
         {
-
+            ParseCache::Missing(current);
             if (ignoreOk)
             {
                 ignoredFiles.insert(name);
@@ -178,7 +183,12 @@ bool Include::AddFileList(const std::string& name, bool ignoreOk, bool MakeFile)
             {
                 includes = currentPath.top() + CmdFiles::PATH_SEP + includes;
             }
+            size_t n = cmdFiles.size();
             cmdFiles.AddFromPath(current, includes);
+            std::string found;
+            for (; n < cmdFiles.size(); n++)
+                found += cmdFiles[n] + "\n";
+            ParseCache::Probe('I', current + "\n" + includes, found);
         }
     }
     for (auto it = cmdFiles.begin(); rv && it != cmdFiles.end(); ++it)
@@ -34,6 +34,8 @@
 
 class Include
 {
+    friend class ParseCache;
+
   public:
     static std::shared_ptr<Include> Instance();
     ~Include() {}
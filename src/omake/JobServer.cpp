@@ -27,7 +27,7 @@ std::shared_ptr<JobServer> JobServer::GetJobServer(const std::string& auth_strin
 #else
     int readfd, writefd;
     std::string read = auth_string.substr(0, auth_string.find(','));
-    std::string write = auth_string.substr(auth_string.find(','));
+    std::string write = auth_string.substr(auth_string.find(',') + 1);
     readfd = std::stoi(read);
     writefd = std::stoi(write);
     return std::make_shared<POSIXJobServer>(readfd, writefd);
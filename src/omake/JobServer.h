@@ -58,6 +58,8 @@ class POSIXJobServer : public JobServer
 {
     friend class JobServer;
     int readfd = -1, writefd = -1;
+    // nonblocking descriptor for the read end used by TryTakeNewJob, -2 when it can't be opened
+    int tryfd = -1;
     int get_read_fd() { return readfd; }
     int get_write_fd() { return writefd; }
 
@@ -33,6 +33,8 @@
 #include "Parser.h"
 #include "Eval.h"
 #include "CmdFiles.h"
+#include "ParseCache.h"
+#include "BuildCache.h"
 #include <cctype>
 #include <iostream>
 #include <iomanip>
@@ -70,6 +72,9 @@ CmdSwitchBool MakeMain::treeBuild(SwitchParser, 'T');
 CmdSwitchBool MakeMain::keepResponseFiles(SwitchParser, 'K');
 CmdSwitchInt MakeMain::jobs(SwitchParser, 'j', INT_MAX, 1, INT_MAX);
 CmdSwitchString MakeMain::jobServer(SwitchParser, 0, 0, {"jobserver-auth"});
+CmdSwitchString MakeMain::cacheFile(SwitchParser, 0, 0, {"cache-file"});
+CmdSwitchString MakeMain::hashFile(SwitchParser, 0, 0, {"hash-file"});
+CmdSwitchString MakeMain::outputCache(SwitchParser, 0, 0, {"output-cache"});
 CmdSwitchCombineString MakeMain::jobOutputMode(SwitchParser, 'O');
 
 const char* MakeMain::helpText =
@@ -91,6 +96,9 @@ const char* MakeMain::helpText =
     "/w    Print make status       --eval=STRING evaluate a statement\n"
     "/!    No logo                 /? or --help  this help\n"
     "--jobserver-auth=xxxx               Name a jobserver to use for getting jobs\n"
+    "--cache-file=xxxx                   Reuse the parsed makefiles from a file when nothing changed\n"
+    "--hash-file=xxxx                    Decide what to rebuild by content, keeping the hashes in a file\n"
+    "--output-cache=xxxx                 Copy targets built before from the same inputs out of a directory\n"
     "--version                           Show version info\n"
     "--no-builtin-rules                  Ignore builtin rules\n" 
     "--no-builtin-vars                   Ignore builtin variables\n" 
@@ -388,14 +396,14 @@ void MakeMain::ShowRule(RuleList* ruleList)
 void MakeMain::ShowDatabase()
 {
     std::cout << "Variables:" << std::endl;
-    for (auto& var : *VariableContainer::Instance())
+    for (auto var : VariableContainer::Instance()->Sorted())
     {
-        std::cout << std::setw(25) << std::setfill(' ') << std::right << (var.first);
-        if (var.second->GetFlavor() == Variable::f_recursive)
+        std::cout << std::setw(25) << std::setfill(' ') << std::right << var->GetName();
+        if (var->GetFlavor() == Variable::f_recursive)
             std::cout << " =  ";
         else
             std::cout << " := ";
-        std::cout << var.second->GetValue() << std::endl;
+        std::cout << var->GetValue() << std::endl;
     }
     std::cout << std::endl << "Explicit rules:" << std::endl;
     for (auto& rule : *RuleContainer::Instance())
@@ -544,6 +552,13 @@ int MakeMain::Run(int argc, char** argv)
                 SetVariable("SHELL", val, Variable::o_environ, false);
                 SetVariable(".SHELLFLAGS", "-c", Variable::o_environ, false);
             }
+#ifndef TARGET_OS_WINDOWS
+            else
+            {
+                SetVariable("SHELL", "/bin/sh", Variable::o_environ, false);
+                SetVariable(".SHELLFLAGS", "-c", Variable::o_environ, false);
+            }
+#endif
         }
 
         std::string wd = OS::GetWorkingDir();
@@ -584,16 +599,6 @@ int MakeMain::Run(int argc, char** argv)
         SetVariable(".INCLUDE_DIRS", includes.GetValue(), Variable::o_command_line, false);
         SetVariable("VPATH", includes.GetValue(), Variable::o_environ, false);
         SetInternalVars();
-        v = VariableContainer::Instance()->Lookup("MAKEFILES");
-        if (v)
-        {
-            v->SetExport(true);
-            Include::Instance()->AddFileList(v->GetValue(), true, true);
-        }
-        std::shared_ptr<Rule> rule = std::make_shared<Rule>(".SUFFIXES", ".c .o .cpp .nas .asm .s", "", std::make_shared<Command>("", 0), "", 0, false);
-        std::shared_ptr<RuleList> ruleList = std::make_shared<RuleList>(".SUFFIXES");
-        ruleList->Add(rule, false);
-        *RuleContainer::Instance() += ruleList;
         std::string files = specifiedFiles.GetValue();
         if (files.empty())
         {
@@ -604,9 +609,28 @@ int MakeMain::Run(int argc, char** argv)
         }
         if (treeBuild.GetValue())
             SetTreePath(files);
-        Include::Instance()->AddFileList(files, false, false);
-        SetupImplicit();
-        RuleContainer::Instance()->SecondaryEval();
+        // anything that changes what the parse does without going through a variable or a file goes in the key
+        std::string key = std::string(__DATE__ " " __TIME__ "\n") + OS::GetWorkingDir() + "\n" + files + "\n" +
+                          (noBuiltinRules.GetValue() ? "r" : "") + (noBuiltinVars.GetValue() ? "R" : "");
+        ParseCache cache(cacheFile.GetValue(), key);
+        if (!cache.Load())
+        {
+            cache.Record();
+            v = VariableContainer::Instance()->Lookup("MAKEFILES");
+            if (v)
+            {
+                v->SetExport(true);
+                Include::Instance()->AddFileList(v->GetValue(), true, true);
+            }
+            std::shared_ptr<Rule> rule = std::make_shared<Rule>(".SUFFIXES", ".c .o .cpp .nas .asm .s", "", std::make_shared<Command>("", 0), "", 0, false);
+            std::shared_ptr<RuleList> ruleList = std::make_shared<RuleList>(".SUFFIXES");
+            ruleList->Add(rule, false);
+            *RuleContainer::Instance() += ruleList;
+            Include::Instance()->AddFileList(files, false, false);
+            SetupImplicit();
+            RuleContainer::Instance()->SecondaryEval();
+            cache.Save();
+        }
         bool didSomething = false;
         done = !Include::Instance()->MakeMakefiles(silent.GetValue(), outputType, didSomething);
         if (!didSomething)
@@ -688,6 +712,7 @@ int MakeMain::Run(int argc, char** argv)
         }
         if (maker.CreateDependencyTree())
         {
+            BuildCache cache(hashFile.GetValue(), outputCache.GetValue());
             rv = maker.RunCommands(keepGoing.GetValue());
             if (query.GetValue() && rv == 0)
                 rv = maker.HasCommands() ? 1 : 0;
@@ -79,6 +79,9 @@ class MakeMain
     static CmdSwitchInt jobs;
     static CmdSwitchCombineString jobOutputMode;
     static CmdSwitchString jobServer;
+    static CmdSwitchString cacheFile;
+    static CmdSwitchString hashFile;
+    static CmdSwitchString outputCache;
     static const char* helpText;
     static const char* usageText;
     static const char* builtinVars;
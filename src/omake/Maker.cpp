@@ -626,11 +626,12 @@ void Maker::GetEnvironment(EnvironmentStrings& env)
     std::shared_ptr<RuleList> rl = RuleContainer::Instance()->Lookup(".EXPORT_ALL_VARIABLES");
     if (rl)
         exportAll = true;
-    for (auto& var : *VariableContainer::Instance())
+    // in name order, the environment block windows builds from this has to be sorted
+    for (auto var : VariableContainer::Instance()->Sorted())
     {
-        if (exportAll || var.second->GetExport())
+        if (exportAll || var->GetExport())
         {
-            EnvEntry a((var.first), var.second->GetValue());
+            EnvEntry a(var->GetName(), var->GetValue());
             env.push_back(a);
         }
     }
@@ -38,6 +38,8 @@ class Runner;
 
 class Maker
 {
+    friend class ParseCache;
+
   public:
     Maker(bool Silent, bool DisplayOnly, bool IgnoreResults, bool Touch, OutputType Type, bool rebuildAll = false,
           bool keepResponseFiles = false, std::string newFiles = "", std::string oldFiles = "");
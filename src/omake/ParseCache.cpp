@@ -0,0 +1,535 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ * 
+ */
+
+#include "ParseCache.h"
+#include "Variable.h"
+#include "Rule.h"
+#include "Eval.h"
+#include "Include.h"
+#include "Maker.h"
+#include "Spawner.h"
+#include "CmdFiles.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+
+#define PARSECACHE_VERSION 1
+
+ParseCache* ParseCache::recording;
+
+static const char cacheSignature[] = "OMAKEDB";
+
+namespace
+{
+class CacheWriter
+{
+  public:
+    void Put(uint32_t val) { data.append((const char*)&val, sizeof(val)); }
+    void Put(const std::string& str)
+    {
+        Put((uint32_t)str.size());
+        data += str;
+    }
+    void Put(const Variable* v)
+    {
+        Put(v->GetName());
+        Put(v->GetValue());
+        Put((uint32_t)v->GetFlavor());
+        Put((uint32_t)v->GetOrigin());
+        Put((uint32_t)(v->GetConstant() | (v->GetPermanent() << 1) | (v->GetExport() << 2)));
+    }
+    std::string data;
+};
+class CacheReader
+{
+  public:
+    CacheReader(const unsigned char* Data, size_t Size) : p(Data), end(Data + Size), ok(true) {}
+    uint32_t Get32()
+    {
+        uint32_t rv = 0;
+        if (end - p < (ptrdiff_t)sizeof(rv))
+        {
+            ok = false;
+            return 0;
+        }
+        memcpy(&rv, p, sizeof(rv));
+        p += sizeof(rv);
+        return rv;
+    }
+    std::string GetString()
+    {
+        uint32_t len = Get32();
+        if (!ok || end - p < (ptrdiff_t)len)
+        {
+            ok = false;
+            return "";
+        }
+        std::string rv((const char*)p, len);
+        p += len;
+        return rv;
+    }
+    Variable* GetVariable()
+    {
+        std::string name = GetString();
+        std::string value = GetString();
+        Variable::Flavor flavor = (Variable::Flavor)Get32();
+        Variable::Origin origin = (Variable::Origin)Get32();
+        uint32_t flags = Get32();
+        Variable* v = new Variable(name, value, flavor, origin);
+        v->SetConstant(!!(flags & 1));
+        v->SetPermanent(!!(flags & 2));
+        v->SetExport(!!(flags & 4));
+        return v;
+    }
+    // counts are checked against what is left so a damaged file can't make us allocate wildly
+    uint32_t GetCount()
+    {
+        uint32_t rv = Get32();
+        if (rv > (uint32_t)(end - p))
+            ok = false;
+        return ok ? rv : 0;
+    }
+    bool Ok() const { return ok; }
+
+  private:
+    const unsigned char* p;
+    const unsigned char* end;
+    bool ok;
+};
+}  // namespace
+
+ParseCache::ParseCache(const std::string& FileName, const std::string& Key) :
+    fileName(FileName), key(Key), cacheable(true), consultAll(false)
+{
+}
+ParseCache::~ParseCache()
+{
+    if (recording == this)
+        recording = nullptr;
+}
+std::string ParseCache::Hash(const unsigned char* data, size_t len)
+{
+    // FNV-1a, with the length so an empty file differs from a missing one
+    uint64_t hash = UINT64_C(14695981039346656037);
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ data[i]) * UINT64_C(1099511628211);
+    char buf[40];
+    sprintf(buf, "%016llx:%llu", (unsigned long long)hash, (unsigned long long)len);
+    return buf;
+}
+std::string ParseCache::Encode(const Variable* v)
+{
+    if (!v)
+        return "";
+    std::string rv;
+    rv += (char)('0' + v->GetFlavor());
+    rv += (char)('0' + v->GetOrigin());
+    rv += (char)('0' + (v->GetConstant() | (v->GetPermanent() << 1) | (v->GetExport() << 2)));
+    rv += v->GetValue();
+    return rv;
+}
+std::string ParseCache::EncodeAll()
+{
+    std::string rv;
+    auto vc = VariableContainer::Instance();
+    for (auto v : vc->Sorted())
+        rv += v->GetName() + "=" + Encode(v) + "\n";
+    for (auto&& v : vc->patternVariables)
+        rv += v->GetName() + "=" + Encode(v.get()) + "\n";
+    return Hash((const unsigned char*)rv.c_str(), rv.size());
+}
+void ParseCache::AddDependency(char kind, const std::string& arg, const std::string& result)
+{
+    std::string sig = kind + arg + '\0' + result;
+    if (seen.insert(sig).second)
+        dependencies.push_back(Dependency{kind, arg, result});
+}
+bool ParseCache::Check(const Dependency& dependency)
+{
+    switch (dependency.kind)
+    {
+        case 'F': {
+            MappedFile file(dependency.arg);
+            if (!file.IsOpen())
+                return dependency.result.empty();
+            return dependency.result == Hash(file.Data(), file.Size());
+        }
+        case 'V':
+            return dependency.result == Encode(VariableContainer::Instance()->Lookup(dependency.arg));
+        case 'A':
+            return dependency.result == EncodeAll();
+        case 'I': {
+            size_t n = dependency.arg.find('\n');
+            CmdFiles files;
+            files.AddFromPath(dependency.arg.substr(0, n), dependency.arg.substr(n + 1));
+            std::string found;
+            for (auto&& name : files)
+                found += name + "\n";
+            return dependency.result == found;
+        }
+        case 'W': {
+            Eval e("", false);
+            return dependency.result == e.wildcard(dependency.arg);
+        }
+        case 'X': {
+            Eval e("", false);
+            std::string names = dependency.arg;
+            return dependency.result == e.wildcardinternal(names);
+        }
+        case 'E': {
+            std::fstream file(dependency.arg, std::ios::in);
+            return dependency.result == (file.is_open() ? "1" : "0");
+        }
+        case 'S': {
+            EnvironmentStrings empty;
+            Spawner sp(empty, true, true, false, false, false, false);
+            return dependency.result == sp.shell(dependency.arg);
+        }
+        default:
+            return false;
+    }
+}
+bool ParseCache::Load()
+{
+    if (fileName.empty())
+        return false;
+    MappedFile file(fileName);
+    if (!file.IsOpen())
+        return false;
+    CacheReader in(file.Data(), file.Size());
+    if (in.GetString() != cacheSignature || in.Get32() != PARSECACHE_VERSION || in.GetString() != key || !in.Ok())
+        return false;
+    std::vector<Dependency> checks;
+    for (uint32_t i = 0, n = in.GetCount(); i < n && in.Ok(); i++)
+    {
+        char kind = (char)in.Get32();
+        std::string arg = in.GetString();
+        std::string result = in.GetString();
+        checks.push_back(Dependency{kind, arg, result});
+    }
+    if (!in.Ok())
+        return false;
+    // shell commands last, they are the expensive ones
+    for (auto&& d : checks)
+        if (d.kind != 'S' && !Check(d))
+            return false;
+    for (auto&& d : checks)
+        if (d.kind == 'S' && !Check(d))
+            return false;
+
+    // the database is good, anything going wrong from here on means it was damaged
+    // so we can't back out of what was loaded
+    auto vc = VariableContainer::Instance();
+    for (uint32_t i = 0, n = in.GetCount(); i < n && in.Ok(); i++)
+    {
+        if (in.Get32())
+            *vc += in.GetVariable();
+        else
+            vc->variables.erase(in.GetString());
+    }
+    vc->patternVariables.clear();
+    for (uint32_t i = 0, n = in.GetCount(); i < n && in.Ok(); i++)
+        *vc += in.GetVariable();
+
+    std::vector<std::shared_ptr<Command>> commands;
+    for (uint32_t i = 0, n = in.GetCount(); i < n && in.Ok(); i++)
+    {
+        std::string file = in.GetString();
+        int line = in.Get32();
+        auto command = std::make_shared<Command>(file, line);
+        for (uint32_t j = 0, m = in.GetCount(); j < m && in.Ok(); j++)
+            *command += in.GetString();
+        *CommandContainer::Instance() += command;
+        commands.push_back(command);
+    }
+    std::vector<std::shared_ptr<Variable>> specifics;
+    for (uint32_t i = 0, n = in.GetCount(); i < n && in.Ok(); i++)
+        specifics.push_back(std::shared_ptr<Variable>(in.GetVariable()));
+    std::vector<std::shared_ptr<Rule>> rules;
+    for (uint32_t i = 0, n = in.GetCount(); i < n && in.Ok(); i++)
+    {
+        std::string target = in.GetString();
+        std::string prerequisites = in.GetString();
+        std::string orderPrerequisites = in.GetString();
+        uint32_t command = in.Get32();
+        std::string file = in.GetString();
+        int line = in.Get32();
+        uint32_t flags = in.Get32();
+        auto rule = std::make_shared<Rule>(target, prerequisites, orderPrerequisites,
+                                           command < commands.size() ? commands[command] : nullptr, file, line, !!(flags & 4),
+                                           !!(flags & 8), !!(flags & 16), !!(flags & 32), !!(flags & 64), !!(flags & 2),
+                                           !!(flags & 256));
+        rule->SetUpToDate(!!(flags & 1));
+        rule->SetBuiltin(!!(flags & 128));
+        rules.push_back(rule);
+    }
+    std::vector<std::shared_ptr<RuleList>> ruleLists;
+    for (uint32_t i = 0, n = in.GetCount(); i < n && in.Ok(); i++)
+    {
+        auto ruleList = std::make_shared<RuleList>(in.GetString());
+        ruleList->targetPatternStem = in.GetString();
+        ruleList->relatedPatternRules = in.GetString();
+        ruleList->newerPrerequisites = in.GetString();
+        uint32_t flags = in.Get32();
+        ruleList->doubleColon = !!(flags & 1);
+        ruleList->intermediate = !!(flags & 2);
+        ruleList->keep = !!(flags & 4);
+        ruleList->isBuilt = !!(flags & 8);
+        for (uint32_t j = 0, m = in.GetCount(); j < m && in.Ok(); j++)
+        {
+            uint32_t rule = in.Get32();
+            if (rule < rules.size())
+                ruleList->rules.push_back(rules[rule]);
+        }
+        for (uint32_t j = 0, m = in.GetCount(); j < m && in.Ok(); j++)
+        {
+            std::string name = in.GetString();
+            uint32_t v = in.Get32();
+            if (v < specifics.size())
+                ruleList->specificVariables[name] = specifics[v];
+        }
+        ruleLists.push_back(ruleList);
+    }
+    auto rc = RuleContainer::Instance();
+    for (uint32_t i = 0, n = in.GetCount(); i < n && in.Ok(); i++)
+    {
+        std::string name = in.GetString();
+        uint32_t ruleList = in.Get32();
+        if (ruleList < ruleLists.size())
+            rc->namedRules[name] = ruleLists[ruleList];
+    }
+    for (uint32_t i = 0, n = in.GetCount(); i < n && in.Ok(); i++)
+    {
+        uint32_t ruleList = in.Get32();
+        if (ruleList < ruleLists.size())
+            rc->implicitRules.push_back(ruleLists[ruleList]);
+    }
+
+    auto include = Include::Instance();
+    for (uint32_t i = 0, n = in.GetCount(); i < n && in.Ok(); i++)
+        include->files.push_back(in.GetString());
+    for (uint32_t i = 0, n = in.GetCount(); i < n && in.Ok(); i++)
+        include->ignoredFiles.insert(in.GetString());
+    Maker::firstGoal = in.GetString();
+    for (uint32_t i = 0, n = in.GetCount(); i < n && in.Ok(); i++)
+    {
+        std::string pattern = in.GetString();
+        Eval::AddVPath(pattern, in.GetString());
+    }
+    if (!in.Ok())
+        Eval::error("Makefile database '" + fileName + "' is damaged, delete it and try again");
+    return true;
+}
+void ParseCache::Record()
+{
+    if (fileName.empty())
+        return;
+    auto vc = VariableContainer::Instance();
+    for (auto&& v : vc->variables)
+        before[v.first] = Encode(v.second.get());
+    for (auto&& v : vc->patternVariables)
+        if (before.find(v->GetName()) == before.end())
+            before[v->GetName()] = Encode(v.get());
+    beforeAll = EncodeAll();
+    recording = this;
+}
+void ParseCache::Save()
+{
+    if (recording != this)
+        return;
+    recording = nullptr;
+    if (!cacheable || Eval::GetErrCount())
+        return;
+
+    CacheWriter out;
+    out.Put(cacheSignature);
+    out.Put((uint32_t)PARSECACHE_VERSION);
+    out.Put(key);
+    for (auto&& name : consulted)
+    {
+        auto it = before.find(name);
+        AddDependency('V', name, it == before.end() ? "" : it->second);
+    }
+    if (consultAll)
+        AddDependency('A', "", beforeAll);
+    out.Put((uint32_t)dependencies.size());
+    for (auto&& d : dependencies)
+    {
+        out.Put((uint32_t)d.kind);
+        out.Put(d.arg);
+        out.Put(d.result);
+    }
+
+    auto vc = VariableContainer::Instance();
+    CacheWriter vars;
+    uint32_t count = 0;
+    for (auto&& v : vc->variables)
+    {
+        auto it = before.find(v.first);
+        if (it == before.end() || it->second != Encode(v.second.get()))
+        {
+            vars.Put((uint32_t)1);
+            vars.Put(v.second.get());
+            count++;
+        }
+    }
+    for (auto&& v : before)
+    {
+        if (v.first.find('%') == std::string::npos && vc->variables.find(v.first) == vc->variables.end())
+        {
+            vars.Put((uint32_t)0);
+            vars.Put(v.first);
+            count++;
+        }
+    }
+    out.Put(count);
+    out.data += vars.data;
+    out.Put((uint32_t)vc->patternVariables.size());
+    for (auto&& v : vc->patternVariables)
+        out.Put(v.get());
+
+    // rules, commands and target variables can be shared, so they go in tables and are referred to by index
+    auto rc = RuleContainer::Instance();
+    std::vector<RuleList*> ruleLists;
+    std::unordered_map<RuleList*, uint32_t> ruleListIds;
+    std::vector<Rule*> rules;
+    std::unordered_map<Rule*, uint32_t> ruleIds;
+    std::vector<Command*> commands;
+    std::unordered_map<Command*, uint32_t> commandIds;
+    std::vector<Variable*> specifics;
+    std::unordered_map<Variable*, uint32_t> specificIds;
+    auto addRuleList = [&](RuleList* ruleList) {
+        if (ruleListIds.insert(std::make_pair(ruleList, (uint32_t)ruleLists.size())).second)
+        {
+            ruleLists.push_back(ruleList);
+            for (auto&& rule : ruleList->rules)
+            {
+                if (ruleIds.insert(std::make_pair(rule.get(), (uint32_t)rules.size())).second)
+                {
+                    rules.push_back(rule.get());
+                    Command* command = rule->commands.get();
+                    if (command && commandIds.insert(std::make_pair(command, (uint32_t)commands.size())).second)
+                        commands.push_back(command);
+                }
+            }
+            for (auto&& v : ruleList->specificVariables)
+                if (specificIds.insert(std::make_pair(v.second.get(), (uint32_t)specifics.size())).second)
+                    specifics.push_back(v.second.get());
+        }
+    };
+    for (auto&& ruleList : rc->namedRules)
+        addRuleList(ruleList.second.get());
+    for (auto&& ruleList : rc->implicitRules)
+        addRuleList(ruleList.get());
+
+    out.Put((uint32_t)commands.size());
+    for (auto command : commands)
+    {
+        out.Put(command->GetFile());
+        out.Put((uint32_t)command->GetLine());
+        out.Put((uint32_t)command->size());
+        for (auto&& line : *command)
+            out.Put(line);
+    }
+    out.Put((uint32_t)specifics.size());
+    for (auto v : specifics)
+        out.Put(v);
+    out.Put((uint32_t)rules.size());
+    for (auto rule : rules)
+    {
+        out.Put(rule->target);
+        out.Put(rule->prerequisites);
+        out.Put(rule->orderPrerequisites);
+        out.Put(rule->commands ? commandIds[rule->commands.get()] : UINT32_MAX);
+        out.Put(rule->file);
+        out.Put((uint32_t)rule->lineno);
+        out.Put((uint32_t)(rule->uptodate | (rule->secondExpansion << 1) | (rule->dontCare << 2) | (rule->ignore << 3) |
+                           (rule->silent << 4) | (rule->make << 5) | (rule->precious << 6) | (rule->builtin << 7) |
+                           (rule->hasPrereq << 8)));
+    }
+    out.Put((uint32_t)ruleLists.size());
+    for (auto ruleList : ruleLists)
+    {
+        out.Put(ruleList->target);
+        out.Put(ruleList->targetPatternStem);
+        out.Put(ruleList->relatedPatternRules);
+        out.Put(ruleList->newerPrerequisites);
+        out.Put((uint32_t)(ruleList->doubleColon | (ruleList->intermediate << 1) | (ruleList->keep << 2) | (ruleList->isBuilt << 3)));
+        out.Put((uint32_t)ruleList->rules.size());
+        for (auto&& rule : ruleList->rules)
+            out.Put(ruleIds[rule.get()]);
+        out.Put((uint32_t)ruleList->specificVariables.size());
+        for (auto&& v : ruleList->specificVariables)
+        {
+            out.Put(v.first);
+            out.Put(specificIds[v.second.get()]);
+        }
+    }
+    out.Put((uint32_t)rc->namedRules.size());
+    for (auto&& ruleList : rc->namedRules)
+    {
+        out.Put(ruleList.first);
+        out.Put(ruleListIds[ruleList.second.get()]);
+    }
+    out.Put((uint32_t)rc->implicitRules.size());
+    for (auto&& ruleList : rc->implicitRules)
+        out.Put(ruleListIds[ruleList.get()]);
+
+    auto include = Include::Instance();
+    out.Put((uint32_t)include->files.size());
+    for (auto&& name : include->files)
+        out.Put(name);
+    out.Put((uint32_t)include->ignoredFiles.size());
+    for (auto&& name : include->ignoredFiles)
+        out.Put(name);
+    out.Put(Maker::firstGoal);
+    out.Put((uint32_t)Eval::vpaths.size());
+    for (auto&& vpath : Eval::vpaths)
+    {
+        out.Put(vpath.first);
+        out.Put(vpath.second);
+    }
+
+    // write it somewhere else first so that a parallel make never maps half a database
+    std::string tempName = fileName + ".tmp";
+    FILE* fil = fopen(tempName.c_str(), "wb");
+    if (fil)
+    {
+        bool ok = fwrite(out.data.c_str(), 1, out.data.size(), fil) == out.data.size();
+        ok &= fclose(fil) == 0;
+        if (ok)
+        {
+#ifdef TARGET_OS_WINDOWS
+            remove(fileName.c_str());
+#endif
+            ok = rename(tempName.c_str(), fileName.c_str()) == 0;
+        }
+        if (!ok)
+            remove(tempName.c_str());
+    }
+}
@@ -0,0 +1,118 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ * 
+ */
+
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+class Variable;
+
+/* a database of what parsing the makefiles left behind: the variables they set, the rules,
+ * the include list, vpaths and the default goal.  Along with it go the things the parse
+ * depended on:
+ *
+ *     F  a makefile that was read, with a hash of its contents (or that it was missing)
+ *     V  a variable that was looked up, with its value from before parsing began
+ *     A  all variables, when $(.VARIABLES) was used
+ *     I  an include that was looked for along the include path, and what was found
+ *     W  a $(wildcard), X a wildcard in a name, E an $(exists), with their results
+ *     S  a $(shell) command and its output
+ *
+ * if all of them still hold on the next run the database is mapped and loaded in place
+ * of the parse.  The $(shell) commands are run again to check them, since they can depend
+ * on anything.  A parse which printed something or had errors isn't saved, since loading
+ * it wouldn't do the same.
+ */
+class ParseCache
+{
+  public:
+    ParseCache(const std::string& FileName, const std::string& Key);
+    ~ParseCache();
+
+    bool Load();
+    void Record();
+    void Save();
+
+    static void Consult(const std::string& name)
+    {
+        if (recording)
+            recording->consulted.insert(name);
+    }
+    static void ConsultAll()
+    {
+        if (recording)
+            recording->consultAll = true;
+    }
+    static void Probe(char kind, const std::string& arg, const std::string& result)
+    {
+        if (recording)
+            recording->AddDependency(kind, arg, result);
+    }
+    static void File(const std::string& name, const char* text, size_t len)
+    {
+        if (recording)
+            recording->AddDependency('F', name, Hash((const unsigned char*)text, len));
+    }
+    static void Missing(const std::string& name)
+    {
+        if (recording)
+            recording->AddDependency('F', name, "");
+    }
+    static void Uncacheable()
+    {
+        if (recording)
+            recording->cacheable = false;
+    }
+    static std::string Hash(const unsigned char* data, size_t len);
+
+  protected:
+    struct Dependency
+    {
+        char kind;
+        std::string arg;
+        std::string result;
+    };
+    void AddDependency(char kind, const std::string& arg, const std::string& result);
+    bool Check(const Dependency& dependency);
+    static std::string Encode(const Variable* v);
+    static std::string EncodeAll();
+
+  private:
+    std::string fileName;
+    std::string key;
+    bool cacheable;
+    bool consultAll;
+    std::list<Dependency> dependencies;
+    std::unordered_set<std::string> seen;
+    std::unordered_set<std::string> consulted;
+    std::unordered_map<std::string, std::string> before;
+    std::string beforeAll;
+    static ParseCache* recording;
+};
+#endif
@@ -54,6 +54,8 @@ class Variable;
 class RuleList;
 class Rule
 {
+    friend class ParseCache;
+
   public:
     Rule(const std::string& targets, const std::string& Prerequisites, const std::string& OrderPrerequisites, std::shared_ptr<Command> Commands,
          const std::string& file, int lineno, bool dontCare = false, bool ignore = false, bool silent = false, bool make = false,
@@ -95,6 +97,8 @@ class Rule
 };
 class RuleList
 {
+    friend class ParseCache;
+
   public:
     RuleList(const std::string& target);
     ~RuleList();
@@ -147,6 +151,8 @@ class RuleList
 };
 class RuleContainer
 {
+    friend class ParseCache;
+
   public:
     static std::shared_ptr<RuleContainer> Instance();
     ~RuleContainer() {}
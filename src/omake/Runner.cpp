@@ -29,6 +29,7 @@
 #include "Eval.h"
 #include "Utils.h"
 #include "Variable.h"
+#include "BuildCache.h"
 #include <fstream>
 #include <list>
 #include <cstdlib>
@@ -137,11 +138,24 @@ int Runner::RunOne(std::list<std::shared_ptr<RuleList>>* ruleStack_in, Depends*
     if (depend->GetRule() && depend->GetRule()->GetCommands())
     {
         Eval::SetRuleStack(ruleStack);
-        Spawner sp(*env, ig, sil, oneShell, posix, displayOnly && !make, keepResponseFiles);
         auto commands = depend->GetRule()->GetCommands();
-        sp.Run(commands, outputType, rl, nullptr);
+        BuildCache* cache = BuildCache::Active();
+        std::string key;
+        if (cache && !displayOnly && !touch && !make && !RuleContainer::Instance()->OnList(depend->GetGoal(), ".PHONY"))
+            key = cache->Key(depend->GetGoal(), rl, commands);
+        if (!key.empty() && cache->Restore(depend->GetGoal(), key))
+        {
+            rv = 0;
+        }
+        else
+        {
+            Spawner sp(*env, ig, sil, oneShell, posix, displayOnly && !make, keepResponseFiles);
+            sp.Run(commands, outputType, rl, nullptr);
+            rv = sp.RetVal();
+            if (!rv && !key.empty())
+                cache->Built(depend->GetGoal(), key);
+        }
         Eval::ClearRuleStack();
-        rv = sp.RetVal();
         if (rv)
         {
             std::string b = Utils::NumberToString(rv);
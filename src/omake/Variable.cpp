@@ -24,6 +24,8 @@
  */
 
 #include "Variable.h"
+#include "ParseCache.h"
+#include <algorithm>
 
 bool Variable::environmentHasPriority = false;
 std::shared_ptr<VariableContainer> VariableContainer::instance;
@@ -38,7 +40,10 @@ void Variable::AppendValue(const std::string& Value, bool dooverride)
     if (dooverride || (origin != o_command_line && origin != o_environ_override))
     {
         if (!constant)
+        {
             value += Value;
+            expansion.reset();
+        }
     }
 }
 void Variable::AssignValue(const std::string& Value, Origin oOrigin, bool dooverride)
@@ -48,6 +53,7 @@ void Variable::AssignValue(const std::string& Value, Origin oOrigin, bool doover
         if (!constant)
         {
             value = Value;
+            expansion.reset();
             origin = oOrigin;
         }
     }
@@ -62,6 +68,7 @@ std::shared_ptr<VariableContainer> VariableContainer::Instance()
 Variable* VariableContainer::Lookup(const std::string& name)
 {
     Variable* rv = nullptr;
+    ParseCache::Consult(name);
     if (name.find_first_of('%') != std::string::npos)
     {
         for (auto it = PatternBegin(); it != PatternEnd(); ++it)
@@ -95,6 +102,14 @@ void VariableContainer::operator+(Variable* variable)
         variables[variable->GetName()] = std::move(temp);
     }
 }
+std::vector<Variable*> VariableContainer::Sorted()
+{
+    std::vector<Variable*> rv;
+    for (auto&& v : variables)
+        rv.push_back(v.second.get());
+    std::sort(rv.begin(), rv.end(), [](Variable* left, Variable* right) { return left->GetName() < right->GetName(); });
+    return rv;
+}
 void VariableContainer::Clear()
 {
     patternVariables.clear();
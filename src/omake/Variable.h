@@ -27,10 +27,12 @@
 #define VARIABLE_H
 
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <vector>
 #include <list>
 #include <memory>
 #include <iostream>
+class Expansion;
 class Variable
 {
   public:
@@ -54,7 +56,11 @@ class Variable
     ~Variable() {}
     const std::string& GetName() const { return name; }
     const std::string& GetValue() const { return value; }
-    void SetValue(const std::string& Value) { value = Value; }
+    void SetValue(const std::string& Value)
+    {
+        value = Value;
+        expansion.reset();
+    }
     void AppendValue(const std::string& value, bool dooverride = false);
     void AssignValue(const std::string& value, Origin origin, bool dooverride = false);
     void SetExport(bool flag) { exportFlag = flag; }
@@ -66,6 +72,9 @@ class Variable
     void SetPermanent(bool flag) { permanent = flag; }
     bool GetPermanent() const { return permanent; }
     bool IsPatternedName() const { return name.find_first_of('%') != std::string::npos; }
+    // the value broken up for expansion, Eval keeps it up to date
+    const std::shared_ptr<Expansion>& GetExpansion() const { return expansion; }
+    void SetExpansion(std::shared_ptr<Expansion> Expansion) { expansion = Expansion; }
     static void SetEnvironmentHasPriority(bool flag) { environmentHasPriority = flag; }
     static bool GetEnvironmentHasPriority() { return environmentHasPriority; }
 
@@ -74,6 +83,7 @@ class Variable
     Origin origin;
     std::string name;
     std::string value;
+    std::shared_ptr<Expansion> expansion;
     bool constant;
     bool permanent;
     bool exportFlag;
@@ -82,6 +92,8 @@ class Variable
 class Rule;
 class VariableContainer
 {
+    friend class ParseCache;
+
   public:
     static std::shared_ptr<VariableContainer> Instance();
     ~VariableContainer() {}
@@ -90,16 +102,17 @@ class VariableContainer
     void operator+=(Variable* variable) { operator+(variable); }
     void Clear();
 
-    typedef std::map<std::string, std::unique_ptr<Variable>>::iterator iterator;
+    typedef std::unordered_map<std::string, std::unique_ptr<Variable>>::iterator iterator;
     const iterator begin() { return variables.begin(); }
     const iterator end() { return variables.end(); }
+    std::vector<Variable*> Sorted();
 
     typedef std::list<std::unique_ptr<Variable>>::iterator PatternIterator;
     const PatternIterator PatternBegin() { return patternVariables.begin(); }
     const PatternIterator PatternEnd() { return patternVariables.end(); }
 
   private:
-    std::map<std::string, std::unique_ptr<Variable>> variables;
+    std::unordered_map<std::string, std::unique_ptr<Variable>> variables;
     std::list<std::unique_ptr<Variable>> patternVariables;
     static std::shared_ptr<VariableContainer> instance;
 };
@@ -27,8 +27,14 @@
 
 #ifdef HAVE_UNISTD_H
 #    include <unistd.h>
+#    include <fcntl.h>
+#    include <poll.h>
+#    include <signal.h>
+#    include <spawn.h>
+#    include <sys/wait.h>
 #    define _SH_DENYNO 0
 #    include <xmmintrin.h>
+extern char** environ;
 #else
 #    include <windows.h>
 #    include <process.h>
@@ -67,6 +73,8 @@
 #include <sys/stat.h>
 #include <mutex>
 #include <memory>
+#include <set>
+#include <vector>
 #include "JobServer.h"
 //#define DEBUG
 static std::mutex processIdMutex;
@@ -82,6 +90,8 @@ std::string OS::jobFile;
 std::shared_ptr<OMAKE::JobServer> OS::localJobServer = nullptr;
 #ifdef TARGET_OS_WINDOWS
 static std::set<HANDLE> processIds;
+#else
+static std::set<pid_t> processIds;
 #endif
 std::recursive_mutex OS::consoleMutex;
 void OS::TerminateAll()
@@ -90,6 +100,9 @@ void OS::TerminateAll()
 #ifdef TARGET_OS_WINDOWS
     for (auto a : processIds)
         TerminateProcess(a, 0);
+#else
+    for (auto a : processIds)
+        kill(a, SIGTERM);
 #endif
 }
 std::string OS::QuoteCommand(std::string exe, std::string command)
@@ -160,7 +173,9 @@ void OS::WriteToConsole(std::string string)
     DWORD written;
     WriteFile(GetStdHandle(STD_OUTPUT_HANDLE), string.c_str(), string.size(), &written, nullptr);
 #else
-    printf("%s\n", string.c_str());
+    // the strings carry their own line endings, same as on windows
+    fwrite(string.c_str(), 1, string.size(), stdout);
+    fflush(stdout);
 #endif
 }
 void OS::ToConsole(std::deque<std::string>& strings)
@@ -330,6 +345,206 @@ void OS::JobRundown()
     if (jobFile.size())
         RemoveFile(jobFile);
 }
+#ifndef TARGET_OS_WINDOWS
+// a command needs the shell if it uses any of these or starts with a shell builtin,
+// otherwise it is split on white space and started directly
+static const char* posixShellChars = "\"'`\\|&;<>()$*?[]~#{}!\n";
+static const char* posixShellBuiltins[] = {
+    ".",      "..",   ":",    "[",    "alias", "break", "case",  "cd",     "continue", "do",    "done", "elif",
+    "else",   "esac", "eval", "exec", "exit",  "export", "fi",   "for",    "if",       "read",  "readonly",
+    "return", "set",  "shift", "source", "test", "then", "times", "trap", "ulimit", "umask", "unset", "until",
+    "wait",   "while", nullptr};
+
+static bool PosixSplitCommand(const std::string& command, std::vector<std::string>& args)
+{
+    if (command.find_first_of(posixShellChars) != std::string::npos)
+        return false;
+    size_t n = command.find_first_not_of(" \t\r");
+    while (n != std::string::npos)
+    {
+        size_t m = command.find_first_of(" \t\r", n);
+        args.push_back(command.substr(n, m == std::string::npos ? m : m - n));
+        n = command.find_first_not_of(" \t\r", m);
+    }
+    if (args.empty() || args[0].find('=') != std::string::npos)
+        return false;
+    for (auto p = posixShellBuiltins; *p; p++)
+        if (args[0] == *p)
+            return false;
+    return true;
+}
+// posix_spawnp searches our own PATH, but the makefile may have exported a different one
+static std::string PosixFindProgram(const std::string& name, EnvironmentStrings* environment)
+{
+    if (name.find('/') != std::string::npos)
+        return access(name.c_str(), X_OK) == 0 ? name : "";
+    std::string path;
+    bool found = false;
+    if (environment)
+    {
+        for (auto&& env : *environment)
+            if (env.name == "PATH")
+            {
+                path = env.value;
+                found = true;
+            }
+    }
+    if (!found)
+    {
+        char* p = getenv("PATH");
+        path = p ? p : "/bin:/usr/bin";
+    }
+    size_t n = 0;
+    while (n <= path.size())
+    {
+        size_t m = path.find(':', n);
+        if (m == std::string::npos)
+            m = path.size();
+        std::string dir = path.substr(n, m - n);
+        std::string file = (dir.empty() ? std::string(".") : dir) + "/" + name;
+        struct stat st;
+        if (stat(file.c_str(), &st) == 0 && S_ISREG(st.st_mode) && access(file.c_str(), X_OK) == 0)
+            return file;
+        n = m + 1;
+    }
+    return "";
+}
+static std::string PosixShell()
+{
+    std::string rv = "/bin/sh";
+    Variable* v = VariableContainer::Instance()->Lookup("SHELL");
+    if (v)
+    {
+        std::string cmd = v->GetValue();
+        if (v->GetFlavor() == Variable::f_recursive)
+        {
+            Eval r(cmd, false);
+            cmd = r.Evaluate();
+        }
+        size_t n = cmd.find_first_not_of(" \t");
+        if (n != std::string::npos)
+            cmd = cmd.substr(n, cmd.find_last_not_of(" \t") + 1 - n);
+        // a windows shell setting is meaningless here
+        if (!cmd.empty() && cmd.find("sh") != std::string::npos && cmd.find_first_of(" \t") == std::string::npos)
+            rv = cmd;
+    }
+    return rv;
+}
+/* starts the program and waits for it.  If output is requested, stdout and stderr go to
+ * separate pipes which are drained as the program runs, so that a program writing a lot
+ * doesn't stall on a full pipe.  The pipes are close-on-exec so that programs other jobs start
+ * in the meantime don't hold them open.
+ */
+static int PosixRun(const std::string& exe, const std::vector<std::string>& args, char** envp, std::string* output)
+{
+    std::vector<char*> argv;
+    for (auto&& a : args)
+        argv.push_back(const_cast<char*>(a.c_str()));
+    argv.push_back(nullptr);
+
+    int pipes[2][2] = {{-1, -1}, {-1, -1}};
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (output)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            if (pipe2(pipes[i], O_CLOEXEC) == -1)
+            {
+                for (int j = 0; j < i; j++)
+                {
+                    close(pipes[j][0]);
+                    close(pipes[j][1]);
+                }
+                posix_spawn_file_actions_destroy(&actions);
+                return -1;
+            }
+            posix_spawn_file_actions_adddup2(&actions, pipes[i][1], i + 1);
+        }
+    }
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    // children get default signal handling no matter what we did with ours
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    sigaddset(&defaults, SIGINT);
+    sigaddset(&defaults, SIGTERM);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    short flags = POSIX_SPAWN_SETSIGDEF;
+#    ifdef POSIX_SPAWN_USEVFORK
+    flags |= POSIX_SPAWN_USEVFORK;
+#    endif
+    posix_spawnattr_setflags(&attr, flags);
+
+    pid_t pid;
+    int rv;
+    int err;
+    {
+        // the lock keeps TerminateAll from missing a process which is just starting
+        std::lock_guard<decltype(processIdMutex)> guard(processIdMutex);
+        err = posix_spawn(&pid, exe.c_str(), &actions, &attr, argv.data(), envp);
+        if (!err)
+            processIds.insert(pid);
+    }
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    if (output)
+    {
+        close(pipes[0][1]);
+        close(pipes[1][1]);
+        if (!err)
+        {
+            struct pollfd fds[2] = {{pipes[0][0], POLLIN, 0}, {pipes[1][0], POLLIN, 0}};
+            int live = 2;
+            char buf[4096];
+            while (live)
+            {
+                if (poll(fds, 2, -1) == -1)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    break;
+                }
+                for (auto& fd : fds)
+                {
+                    if (fd.fd >= 0 && fd.revents)
+                    {
+                        ssize_t len = read(fd.fd, buf, sizeof(buf));
+                        if (len > 0)
+                        {
+                            output->append(buf, len);
+                        }
+                        else if (len == 0 || errno != EINTR)
+                        {
+                            fd.fd = -1;
+                            live--;
+                        }
+                    }
+                }
+            }
+        }
+        close(pipes[0][0]);
+        close(pipes[1][0]);
+    }
+    if (err)
+        return -1;
+    int status;
+    while (waitpid(pid, &status, 0) == -1 && errno == EINTR)
+        ;
+    {
+        std::lock_guard<decltype(processIdMutex)> guard(processIdMutex);
+        processIds.erase(pid);
+    }
+    if (WIFEXITED(status))
+        rv = WEXITSTATUS(status);
+    else if (WIFSIGNALED(status))
+        rv = 128 + WTERMSIG(status);
+    else
+        rv = -1;
+    return rv;
+}
+#endif
 int OS::Spawn(const std::string command, EnvironmentStrings& environment, std::string* output)
 {
 #ifdef TARGET_OS_WINDOWS
@@ -512,7 +727,29 @@ int OS::Spawn(const std::string command, EnvironmentStrings& environment, std::s
 #    endif
     return rv;
 #else
-    return -1;
+    std::vector<std::string> envStrings;
+    std::vector<char*> envp;
+    for (auto&& env : environment)
+        envStrings.push_back(env.name + "=" + env.value);
+    for (auto&& env : envStrings)
+        envp.push_back(const_cast<char*>(env.c_str()));
+    envp.push_back(nullptr);
+    int rv = -1;
+    std::vector<std::string> args;
+    std::string exe;
+    // try as an app first
+    if (PosixSplitCommand(command, args) && !(exe = PosixFindProgram(args[0], &environment)).empty())
+        rv = PosixRun(exe, args, envp.data(), output);
+    if (rv == -1)
+    {
+        // not found or needs the shell for redirection and the like
+        std::string shell = PosixShell();
+        rv = PosixRun(shell, {shell, "-c", command}, envp.data(), output);
+    }
+#    ifdef DEBUG
+    std::cout << rv << ":" << command << std::endl;
+#    endif
+    return rv;
 #endif
 }
 std::string OS::SpawnWithRedirect(const std::string command)
@@ -585,7 +822,10 @@ std::string OS::SpawnWithRedirect(const std::string command)
     CloseHandle(pipeWriteDuplicate);
     return rv;
 #else
-    return "";
+    std::string rv;
+    std::string shell = PosixShell();
+    PosixRun(shell, {shell, "-c", command}, environ, &rv);
+    return rv;
 #endif
 }
 Time OS::GetCurrentTime()
@@ -606,7 +846,9 @@ Time OS::GetCurrentTime()
     Time rv(t, systemTime.wMilliseconds);
     return rv;
 #else
-    Time rv;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    Time rv(ts.tv_sec, ts.tv_nsec / 1000000);
     return rv;
 #endif
 }
@@ -633,6 +875,13 @@ Time OS::GetFileTime(const std::string fileName)
         Time rv(t, systemTime.wMilliseconds);
         return rv;
     }
+#else
+    struct stat st;
+    if (stat(fileName.c_str(), &st) == 0)
+    {
+        Time rv(st.st_mtim.tv_sec, st.st_mtim.tv_nsec / 1000000);
+        return rv;
+    }
 #endif
     Time rv;
     return rv;
@@ -662,6 +911,12 @@ void OS::SetFileTime(const std::string fileName, Time time)
         ::SetFileTime(h, nullptr, nullptr, &mod);
         CloseHandle(h);
     }
+#else
+    struct timespec times[2];
+    times[0].tv_nsec = UTIME_OMIT;
+    times[1].tv_sec = time.seconds;
+    times[1].tv_nsec = time.ms * 1000000;
+    utimensat(AT_FDCWD, fileName.c_str(), times, 0);
 #endif
 }
 std::string OS::GetWorkingDir()
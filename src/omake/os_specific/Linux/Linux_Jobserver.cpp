@@ -2,6 +2,8 @@
 #include <unistd.h>
 #include <cstdint>
 #include <sys/types.h>
+#include <fcntl.h>
+#include <system_error>
 #include <errno.h>
 #include <thread>
 #include <stdexcept>
@@ -14,34 +16,41 @@ bool POSIXJobServer::TryTakeNewJob()
     {
         throw std::runtime_error("Job server used without initializing the underlying parameters");
     }
-//    if (current_jobs != 0)
     {
         int err = 0;
         char only_buffer;
         ssize_t bytes_read;
-    try_again:
-        // Wait while we can't get our own
-        while ((bytes_read = read(readfd, &only_buffer, 1)) == 0)
+        // the pipe may be shared with other makes, so it can't be made nonblocking; instead the read
+        // end is opened again through /proc, which gives a descriptor of our own to make nonblocking.
+        // Checking for a token before a blocking read would race with the other makes for it
+        if (tryfd == -1)
         {
-            // Yield our thread to other executions while we're waiting for a thread to actually execute and take up time
-            std::this_thread::yield();
+            std::string name = "/proc/self/fd/" + std::to_string(readfd);
+            if ((tryfd = open(name.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC)) == -1)
+                tryfd = -2;
         }
-        if (bytes_read == -1)
+        // without /proc there is no way to try for a token without blocking
+        if (tryfd == -2)
+            return false;
+        if ((bytes_read = read(tryfd, &only_buffer, 1)) != 1)
         {
+            if (bytes_read == 0)
+                return false;
             switch (err = errno)
             {
                 case EAGAIN:
 #if EAGAIN != EWOULDBLOCK
                 case EWOULDBLOCK:
 #endif
+                case EINTR:
                     return false;
                 default:
                     throw std::system_error(err, std::system_category());
             }
         }
     }
-//    current_jobs++;
-//    return true;
+    current_jobs++;
+    return true;
 }
 bool POSIXJobServer::TakeNewJob()
 {
@@ -69,6 +78,7 @@ bool POSIXJobServer::TakeNewJob()
 #if EAGAIN != EWOULDBLOCK
                 case EWOULDBLOCK:
 #endif
+                case EINTR:
                     goto try_again;
                     break;
                 default:
@@ -76,8 +86,8 @@ bool POSIXJobServer::TakeNewJob()
             }
         }
     }
-//    current_jobs++;
-//    return true;
+    current_jobs++;
+    return true;
 }
 bool POSIXJobServer::ReleaseJob()
 {
@@ -97,6 +107,7 @@ bool POSIXJobServer::ReleaseJob()
     try_again:
         if ((bytes_written = write(writefd, &write_buffer, 1)) != -1)
         {
+            current_jobs--;
             return true;
         }
         else
@@ -107,6 +118,7 @@ bool POSIXJobServer::ReleaseJob()
 #if EAGAIN != EWOULDBLOCK
                 case EWOULDBLOCK:
 #endif
+                case EINTR:
                     // yield execution in hopes that it's not blocked next time, this is recommended
                     // practice for spinloops
                     std::this_thread::yield();
@@ -131,7 +143,7 @@ static int populate_pipe(int writefd, int max_jobs)
     try_again:
         if ((bytes_written = write(writefd, &write_buffer, 1)) != -1)
         {
-            return true;
+            continue;
         }
         else
         {
@@ -141,6 +153,7 @@ static int populate_pipe(int writefd, int max_jobs)
 #if EAGAIN != EWOULDBLOCK
                 case EWOULDBLOCK:
 #endif
+                case EINTR:
                     std::this_thread::yield();
                     goto try_again;
                     break;
@@ -149,6 +162,7 @@ static int populate_pipe(int writefd, int max_jobs)
             }
         }
     }
+    return max_jobs;
 }
 POSIXJobServer::POSIXJobServer(int max_jobs)
 {
@@ -159,9 +173,10 @@ POSIXJobServer::POSIXJobServer(int max_jobs)
     }
     if (pipe(readwrite) == -1)
     {
-        readfd = readwrite[0];
-        writefd = readwrite[1];
+        throw std::system_error(errno, std::system_category());
     }
+    readfd = readwrite[0];
+    writefd = readwrite[1];
     populate_pipe(writefd, max_jobs);
 }
 POSIXJobServer::POSIXJobServer(int read, int write)
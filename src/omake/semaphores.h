@@ -46,7 +46,7 @@ class Semaphore
 #else
         // 0 in this case means this is shared internally, not externally
         int ret = sem_init(&handle, 0, value);
-        if (!ret)
+        if (ret == -1)
         {
             throw std::runtime_error("Semaphore init failed, errno is: " + std::to_string(errno));
         }
@@ -65,7 +65,7 @@ class Semaphore
 #else
         // 0 in this case means this is shared internally, not externally
         int ret = sem_init(&handle, 0, value);
-        if (!ret)
+        if (ret == -1)
         {
             throw std::runtime_error("Semaphore init failed, errno is: " + std::to_string(errno));
         }
@@ -239,7 +239,7 @@ class Semaphore
                 return false;
         }
 #else
-        return !! sem_trywait(&handle);
+        return !sem_trywait(&handle);
 #endif
     }
     void Wait()
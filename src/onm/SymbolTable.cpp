@@ -170,7 +170,10 @@ void SymbolTable::Load(CmdFiles& files)
                 {
                     ObjIeeeIndexManager im1;
                     ObjFactory factory(&im1);
-                    ProcessObjectFile(librarian.LoadModule(i, &factory));
+                    ObjFile* f = librarian.LoadModule(i, &factory);
+                    // modules which were replaced or removed are still in the library
+                    if (f)
+                        ProcessObjectFile(f);
                 }
             }
         }
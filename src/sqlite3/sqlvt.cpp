@@ -41,10 +41,13 @@ int SQL3VirtualTable::Exec(const char* str)
     }
     return rc;
 }
-int SQL3VirtualTable::InsertIntoFrom(const char* str)
+int SQL3VirtualTable::InsertIntoFrom(const char* str, bool transaction)
 {
     char* zSql;
-    zSql = sqlite3_mprintf("BEGIN; INSERT INTO %Q SELECT * FROM TEMP.%Q; COMMIT;", str, GetName());
+    if (transaction)
+        zSql = sqlite3_mprintf("BEGIN; INSERT INTO %Q SELECT * FROM TEMP.%Q; COMMIT;", str, GetName());
+    else
+        zSql = sqlite3_mprintf("INSERT INTO %Q SELECT * FROM TEMP.%Q;", str, GetName());
     int rc = Exec(zSql);
     sqlite3_free(zSql);
     return rc;
@@ -247,7 +250,8 @@ int IntegerColumnsVirtualTable::Column(void* cursor, sqlite3_context* ctx, int i
 int IntegerColumnsVirtualTable::RowId(void* cursor, sqlite3_int64* pRowid)
 {
     struct lfcurs* q = (struct lfcurs*)cursor;
-    return q->i;
+    *pRowid = q->i;
+    return SQLITE_OK;
 }
 char* IntegerColumnsVirtualTable::GetVTabDeclarator() { return (char*)declarator.c_str(); }
 char* IntegerColumnsVirtualTable::GetName() { return (char*)name.c_str(); }
@@ -25,7 +25,7 @@ class SQL3VirtualTable
 
     int Start(sqlite3* db);
     int Stop();
-    int InsertIntoFrom(const char* tableName);
+    int InsertIntoFrom(const char* tableName, bool transaction = true);
 
     virtual void* Open() = 0;
     virtual int Close(void* cursor) = 0;
@@ -85,6 +85,11 @@ bool CmdFiles::RecurseDirs(const std::string& path, const std::string& name, boo
 bool CmdFiles::Add(const std::string& name, bool recurseDirs, bool subdirs)
 {
     bool rv = false;
+    if (keepMasks && name.find_first_of("*?") != std::string::npos)
+    {
+        names.push_back(name);
+        return true;
+    }
 #ifdef TARGET_OS_WINDOWS
     struct _finddata_t find;
 #endif
@@ -35,9 +35,9 @@ class CmdFiles
     typedef std::vector<std::string> FileName;
 
   public:
-    CmdFiles() {}
-    CmdFiles(char** fileList, bool recurseSubdirs = false) { Add(fileList, recurseSubdirs); }
-    CmdFiles(const std::string& name, bool recurseSubdirs = false) { Add(name, recurseSubdirs); }
+    CmdFiles() : keepMasks(false) {}
+    CmdFiles(char** fileList, bool recurseSubdirs = false) : keepMasks(false) { Add(fileList, recurseSubdirs); }
+    CmdFiles(const std::string& name, bool recurseSubdirs = false) : keepMasks(false) { Add(name, recurseSubdirs); }
     ~CmdFiles();
 
     bool Add(const std::string& name, bool recurseSubdirs = false, bool subdirs = false);
@@ -53,6 +53,9 @@ class CmdFiles
     }
     bool Add(CmdSwitchFile& switchFile);
     void Remove(const std::string& name);
+    // names with wildcards are kept as given instead of being matched in their directory,
+    // for a tool which matches them somewhere else
+    void KeepMasks(bool flag) { keepMasks = flag; }
     typedef FileName::iterator iterator;
 
     iterator begin() { return names.begin(); }
@@ -70,5 +73,6 @@ class CmdFiles
 
   private:
     FileName names;
+    bool keepMasks;
 };
 #endif
@@ -0,0 +1,168 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ * 
+ */
+
+#include "MappedFile.h"
+#include <cstdio>
+
+#ifdef TARGET_OS_WINDOWS
+#    include <Windows.h>
+#    include <io.h>
+#elif defined(HAVE_UNISTD_H)
+#    include <unistd.h>
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#endif
+
+MappedFile::MappedFile(const std::string& name) : open_(false), data_(nullptr), size_(0), mapHandle_(nullptr)
+{
+#ifdef TARGET_OS_WINDOWS
+    HANDLE file = CreateFileA(name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size))
+        {
+            size_ = (size_t)size.QuadPart;
+            if (!size_)
+            {
+                open_ = true;
+            }
+            else if ((mapHandle_ = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) != nullptr)
+            {
+                data_ = (const unsigned char*)MapViewOfFile(mapHandle_, FILE_MAP_READ, 0, 0, 0);
+                if (data_)
+                {
+                    open_ = true;
+                }
+                else
+                {
+                    CloseHandle(mapHandle_);
+                    mapHandle_ = nullptr;
+                }
+            }
+        }
+        CloseHandle(file);
+        if (open_)
+            return;
+    }
+#elif defined(HAVE_UNISTD_H)
+    int fd = open(name.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+        {
+            size_ = st.st_size;
+            open_ = true;
+            if (size_)
+            {
+                void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED)
+                {
+                    data_ = (const unsigned char*)p;
+                    mapHandle_ = p;
+                }
+            }
+        }
+        close(fd);
+        if (!open_ || !size_ || data_)
+            return;
+        open_ = false;
+    }
+#endif
+    // no mapping, read it instead
+    FILE* fil = fopen(name.c_str(), "rb");
+    if (fil)
+    {
+        if (fseek(fil, 0, SEEK_END) == 0)
+        {
+            long len = ftell(fil);
+            if (len >= 0 && fseek(fil, 0, SEEK_SET) == 0)
+            {
+                size_ = len;
+                buffer_ = std::make_unique<unsigned char[]>(size_ + 1);
+                if (fread(buffer_.get(), 1, size_, fil) == size_)
+                {
+                    data_ = buffer_.get();
+                    open_ = true;
+                }
+            }
+        }
+        fclose(fil);
+    }
+}
+MappedFile::MappedFile(FILE* fil) : open_(false), data_(nullptr), size_(0), mapHandle_(nullptr)
+{
+#ifdef TARGET_OS_WINDOWS
+    HANDLE file = (HANDLE)_get_osfhandle(_fileno(fil));
+    LARGE_INTEGER size;
+    if (file != INVALID_HANDLE_VALUE && GetFileType(file) == FILE_TYPE_DISK && GetFileSizeEx(file, &size) && size.QuadPart)
+    {
+        size_ = (size_t)size.QuadPart;
+        if ((mapHandle_ = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) != nullptr)
+        {
+            data_ = (const unsigned char*)MapViewOfFile(mapHandle_, FILE_MAP_READ, 0, 0, 0);
+            if (data_)
+            {
+                open_ = true;
+            }
+            else
+            {
+                CloseHandle(mapHandle_);
+                mapHandle_ = nullptr;
+            }
+        }
+    }
+#elif defined(HAVE_UNISTD_H)
+    struct stat st;
+    int fd = fileno(fil);
+    if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size)
+    {
+        size_ = st.st_size;
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED)
+        {
+            data_ = (const unsigned char*)p;
+            mapHandle_ = p;
+            open_ = true;
+        }
+    }
+#endif
+    if (!open_)
+        size_ = 0;
+}
+MappedFile::~MappedFile()
+{
+    if (mapHandle_)
+    {
+#ifdef TARGET_OS_WINDOWS
+        UnmapViewOfFile(data_);
+        CloseHandle(mapHandle_);
+#elif defined(HAVE_UNISTD_H)
+        munmap(mapHandle_, size_);
+#endif
+    }
+}
@@ -0,0 +1,55 @@
+/* Software License Agreement
+ * 
+ *     Copyright(C) 1994-2024 David Lindauer, (LADSoft)
+ * 
+ *     This file is part of the Orange C Compiler package.
+ * 
+ *     The Orange C Compiler package is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ * 
+ *     The Orange C Compiler package is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ * 
+ *     You should have received a copy of the GNU General Public License
+ *     along with Orange C.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ *     contact information:
+ *         email: TouchStone222@runbox.com <David Lindauer>
+ * 
+ * 
+ */
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstdio>
+
+// a read-only view of a whole file.  The file is memory mapped when the OS allows it and
+// read into memory otherwise, either way the contents stay valid for the life of the object
+class MappedFile
+{
+  public:
+    MappedFile(const std::string& name);
+    // maps the file behind an open stream without moving the stream.  There is no
+    // fallback here, IsOpen() is false if the file can't be mapped
+    MappedFile(FILE* fil);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool IsOpen() const { return open_; }
+    const unsigned char* Data() const { return data_; }
+    size_t Size() const { return size_; }
+
+  private:
+    bool open_;
+    const unsigned char* data_;
+    size_t size_;
+    void* mapHandle_;
+    std::unique_ptr<unsigned char[]> buffer_;
+};
@@ -97,7 +97,8 @@ void ToolChain::Usage(const char* text, int exitVal)
     exit(1);
 }
 CmdFiles ToolChain::StandardToolStartup(CmdSwitchParser& SwitchParser, int argc, char** argv, const char* usageText,
-                                        const char* helpText, std::function<bool()> noBanner)
+                                        const char* helpText, std::function<bool()> noBanner,
+                                        std::function<bool()> keepMasks)
 {
     CmdSwitchBool NoLogo(SwitchParser, '!', false, {"nologo"});
     CmdSwitchBool ShowVersion(SwitchParser, 'v', false, {"version"});
@@ -132,7 +133,10 @@ CmdFiles ToolChain::StandardToolStartup(CmdSwitchParser& SwitchParser, int argc,
         ToolChain::ShowVersion();
     if (ShowHelp.GetExists())
         ToolChain::Usage(helpText);
-    auto rv = CmdFiles(argv);
+    CmdFiles rv;
+    if (keepMasks && keepMasks())
+        rv.KeepMasks(true);
+    rv.Add(argv);
     rv.Add(File);
     return rv;
 }
@@ -49,7 +49,8 @@ class ToolChain
 {
   public:
     static CmdFiles StandardToolStartup(CmdSwitchParser& SwitchParser, int argc, char** argv, const char* usageText,
-                                                   const char* helpText, std::function<bool()> noBanner = nullptr);
+                                                   const char* helpText, std::function<bool()> noBanner = nullptr,
+                                                   std::function<bool()> keepMasks = nullptr);
     static void ShowBanner();
     static void ShowVersion();
     static void Usage(const char* text, int exitVal = 1);
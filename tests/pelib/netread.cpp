@@ -0,0 +1,125 @@
+#include "DotNetPELib.h"
+#include <cstdio>
+
+using namespace DotNetPELib;
+
+/* writes an assembly with nested classes, enumerations and properties, then loads it
+ * back and dumps what the reader found.  Nested classes, constant values and properties
+ * are looked up through indexes which the reader builds on first use
+ */
+static void Write(const char* name)
+{
+    PELib lib(name, PELib::ilonly | PELib::bits32);
+    // only the names of the runtime classes are needed
+    lib.AddExternalAssembly(lib.GetRuntimeName());
+    DataContainer* working = lib.WorkingAssembly();
+    Namespace* ns = lib.AllocateNamespace("ns");
+    working->Add(ns);
+
+    Class* outer = lib.AllocateClass("Outer", Qualifiers::Public | Qualifiers::Ansi | Qualifiers::Sealed, -1, -1);
+    ns->Add(outer);
+    Class* inner = lib.AllocateClass("Inner", Qualifiers::Public | Qualifiers::Ansi | Qualifiers::Sealed, -1, -1);
+    outer->Add(inner);
+    Class* deep = lib.AllocateClass("Deep", Qualifiers::Public | Qualifiers::Ansi | Qualifiers::Sealed, -1, -1);
+    inner->Add(deep);
+    deep->Add(lib.AllocateField("count", lib.AllocateType(Type::i32, 0), Qualifiers::Public | Qualifiers::Static));
+
+    Enum* colors = lib.AllocateEnum("Colors", Qualifiers::EnumClass | Qualifiers::Public, Field::i32);
+    outer->Add(colors);
+    colors->AddValue(lib, "Red", 1);
+    colors->AddValue(lib, "Green", 20);
+    colors->AddValue(lib, "Blue", -300);
+    Enum* sizes = lib.AllocateEnum("Sizes", Qualifiers::EnumClass | Qualifiers::Public, Field::i32);
+    ns->Add(sizes);
+    sizes->AddValue(lib, "Small", 5);
+    sizes->AddValue(lib, "Huge", 1 << 30);
+
+    Class* props = lib.AllocateClass("Props", Qualifiers::Public | Qualifiers::Ansi | Qualifiers::Sealed, -1, -1);
+    ns->Add(props);
+    std::vector<Type*> none;
+    Property* count = lib.AllocateProperty(lib, "Count", lib.AllocateType(Type::i32, 0), none);
+    count->Instance(false);
+    props->Add(count);
+    Property* size = lib.AllocateProperty(lib, "Size", lib.AllocateType(Type::i64, 0), none, false);
+    props->Add(size);
+    inner->Add(lib.AllocateProperty(lib, "Depth", lib.AllocateType(Type::i32, 0), none));
+
+    lib.DumpOutputFile(std::string(name) + ".dll", PELib::pedll, false);
+}
+
+class Dump : public Callback
+{
+  public:
+    int depth = 0;
+    void Indent()
+    {
+        for (int i = 0; i < depth; i++)
+            printf("  ");
+    }
+    virtual bool EnterNamespace(const Namespace* ns) override
+    {
+        Indent();
+        printf("namespace %s\n", ns->Name().c_str());
+        depth++;
+        return true;
+    }
+    virtual bool ExitNamespace(const Namespace*) override
+    {
+        depth--;
+        return true;
+    }
+    virtual bool EnterClass(const Class* cls) override
+    {
+        Indent();
+        printf("class %s\n", cls->Name().c_str());
+        depth++;
+        return true;
+    }
+    virtual bool ExitClass(const Class*) override
+    {
+        depth--;
+        return true;
+    }
+    virtual bool EnterEnum(const Enum* enm) override
+    {
+        Indent();
+        printf("enum %s\n", enm->Name().c_str());
+        depth++;
+        return true;
+    }
+    virtual bool ExitEnum(const Enum*) override
+    {
+        depth--;
+        return true;
+    }
+    virtual bool EnterField(const Field* fld) override
+    {
+        Indent();
+        if (dynamic_cast<Enum*>(fld->GetContainer()))
+            printf("field %s = %lld\n", fld->Name().c_str(), fld->EnumValue());
+        else
+            printf("field %s\n", fld->Name().c_str());
+        return true;
+    }
+    virtual bool EnterProperty(const Property* prop) override
+    {
+        Indent();
+        printf("property %s%s%s\n", prop->Name().c_str(), prop->Instance() ? "" : " static",
+               const_cast<Property*>(prop)->Setter() ? " set" : "");
+        return true;
+    }
+};
+
+int main()
+{
+    Write("netread_a");
+    PELib lib("netread", PELib::ilonly | PELib::bits32);
+    if (lib.LoadAssembly("netread_a"))
+    {
+        printf("could not load netread_a.dll\n");
+        return 1;
+    }
+    Dump dump;
+    lib.FindAssembly("netread_a")->Traverse(dump);
+    return 0;
+}
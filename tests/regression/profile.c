@@ -0,0 +1,53 @@
+#include <stdio.h>
+
+/* built with a profile written by hand (profile.prf).  The counts send the
+ * branches the way the profile says they go, which here is not always the
+ * way they really go; the code has to stay correct either way.  The profile
+ * also has entries which don't match the functions and have to be ignored.
+ */
+int table[100];
+
+int classify(int n)
+{
+    if (n % 7 == 0)
+        return 3;
+    else if (n & 1)
+        return 1;
+    return 2;
+}
+int never(int n)
+{
+    int i, s = 0;
+    for (i = 0; i < n; i++)
+        s += i * n;
+    return s;
+}
+static int helper(int n)
+{
+    if (n > 50)
+        return n - 50;
+    return n + 50;
+}
+int fill(int n)
+{
+    int i, s = 0;
+    for (i = 0; i < n; i++)
+    {
+        if (i % 10 == 9)
+            table[i] = helper(i);
+        else
+            table[i] = classify(i);
+        s += table[i];
+    }
+    return s;
+}
+
+int main()
+{
+    int i, s;
+    s = fill(100);
+    printf("%d %d\n", s, never(5));
+    for (i = 0; i < 100; i++)
+        printf("%d%c", table[i], i % 10 == 9 ? '\n' : ' ');
+    return 0;
+}
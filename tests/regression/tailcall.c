@@ -0,0 +1,63 @@
+#include <stdio.h>
+
+/* recursion far deeper than the stack allows; it only runs if the calls just
+ * before a return are turned into jumps.  Some of the calls reach the return
+ * through a jump to the shared epilogue, some pass fewer arguments than the
+ * caller got, and some are to functions which pop their own arguments.
+ */
+#define DEPTH 3000000
+
+int odd(unsigned n);
+int even(unsigned n)
+{
+    if (n == 0)
+        return 1;
+    return odd(n - 1);
+}
+int odd(unsigned n)
+{
+    if (n == 0)
+        return 0;
+    return even(n - 1);
+}
+unsigned sum(unsigned n, unsigned acc)
+{
+    if (!n)
+        return acc;
+    return sum(n - 1, acc + n * 3);
+}
+unsigned down(unsigned n, unsigned a, unsigned b);
+unsigned split(unsigned n, unsigned a, unsigned b)
+{
+    if (n == 0)
+        return a ^ b;
+    if (n & 1)
+        return split(n - 1, b, a + 1);
+    else if (n % 3 == 0)
+        return down(n - 1, a, b);
+    return split(n - 1, a * 5 + b, b);
+}
+unsigned down(unsigned n, unsigned a, unsigned b) { return split(n, b + n, a); }
+int __stdcall steps(int n, int count)
+{
+    if (n <= 1)
+        return count;
+    if (n & 1)
+        return steps(3 * n + 1, count + 1);
+    return steps(n / 2, count + 1);
+}
+int __stdcall loop(int n, int count)
+{
+    if (count >= DEPTH)
+        return n;
+    return loop(n + steps(count % 1000 + 2, 0), count + 1);
+}
+
+int main()
+{
+    printf("%d %d %d %d\n", even(DEPTH), odd(DEPTH), even(DEPTH + 1), odd(DEPTH + 1));
+    printf("%u\n", sum(DEPTH, 0));
+    printf("%u %u\n", down(DEPTH, 1, 2), down(DEPTH + 5, 3, 4));
+    printf("%d %d\n", steps(27, 0), loop(1, 0));
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <stdio.h>
+
+/* loops with constant trip counts: the short ones are unrolled completely,
+ * the longer ones several trips at a time with the leftover trips peeled
+ * off in front.  Trip counts that are not a multiple of four leave one,
+ * two or three trips over.
+ */
+int a[64];
+
+#define UP(n)                          \
+    int up##n(int k)                   \
+    {                                  \
+        int i, s = 0;                  \
+        for (i = 0; i < n; i++)        \
+        {                              \
+            a[i] = i * i + k;          \
+            s += a[i] ^ i;             \
+        }                              \
+        return s;                      \
+    }
+#define DOWN(n)                        \
+    unsigned down##n(unsigned k)       \
+    {                                  \
+        unsigned i, s = 0;             \
+        for (i = n; i > 0; i--)        \
+        {                              \
+            s = s * 3 + i + k;         \
+        }                              \
+        return s;                      \
+    }
+#define STEP(n)                        \
+    int step##n(int k)                 \
+    {                                  \
+        int i, s = 0;                  \
+        for (i = 1; i <= n; i += 3)    \
+        {                              \
+            a[i] += k;                 \
+            s += a[i] - i;             \
+        }                              \
+        return s;                      \
+    }
+
+UP(1)
+UP(3)
+UP(4)
+UP(7)
+UP(16)
+UP(17)
+UP(18)
+UP(19)
+UP(20)
+UP(33)
+UP(63)
+DOWN(5)
+DOWN(16)
+DOWN(21)
+DOWN(22)
+DOWN(23)
+DOWN(40)
+STEP(10)
+STEP(47)
+STEP(62)
+
+int main()
+{
+    int i, k;
+    for (k = 0; k < 3; k++)
+    {
+        printf("up %d %d %d %d %d\n", up1(k), up3(k), up4(k), up7(k), up16(k));
+        printf("up %d %d %d %d %d %d\n", up17(k), up18(k), up19(k), up20(k), up33(k), up63(k));
+        printf("down %u %u %u %u %u %u\n", down5(k), down16(k), down21(k), down22(k), down23(k), down40(k));
+        printf("step %d %d %d\n", step10(k), step47(k), step62(k));
+    }
+    for (i = 0; i < 64; i++)
+        printf("%d%c", a[i], i % 8 == 7 ? '\n' : ' ');
+    return 0;
+}
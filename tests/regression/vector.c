@@ -0,0 +1,139 @@
+#include <stdio.h>
+
+/* loops the vectorizer turns into packed operations.  The constant trip
+ * counts peel off whatever doesn't make up a full vector, the runtime
+ * ones run a vector loop first and leave the rest to the original loop;
+ * bounds smaller than a vector never enter the vector loop at all.
+ */
+int a[64], b[64], c[64];
+float f[64], g[64];
+double d[64], e[64];
+
+void fill(void)
+{
+    int i;
+    for (i = 0; i < 64; i++)
+    {
+        a[i] = 0;
+        b[i] = i * 7 - 100;
+        c[i] = (i * 13) ^ 0x55;
+        f[i] = 0;
+        g[i] = i * 0.5f;
+        d[i] = 0;
+        e[i] = i * 0.25;
+    }
+}
+int sum(void)
+{
+    int i, s = 0;
+    for (i = 0; i < 64; i++)
+        s = s * 31 + a[i] + (int)(f[i] * 4) + (int)(d[i] * 8);
+    return s;
+}
+
+void addc(void)
+{
+    int i;
+    for (i = 0; i < 40; i++)
+        a[i] = b[i] + c[i];
+}
+void orc(void)
+{
+    int i;
+    for (i = 0; i < 23; i++)
+        a[i] = b[i] | c[i];
+}
+void mulc(float k)
+{
+    int i;
+    for (i = 0; i < 61; i++)
+        f[i] = g[i] * k;
+}
+void orn(int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+        a[i] = b[i] | c[i];
+}
+void andn(int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+        a[i] = b[i] & c[i];
+}
+void subn(int m, int n)
+{
+    int i;
+    for (i = m; i < n; i++)
+        a[i] = b[i] - c[i];
+}
+void addfn(int n, float k)
+{
+    int i;
+    for (i = 0; i < n; i++)
+        f[i] = g[i] + k;
+}
+void muldn(int n, double k)
+{
+    int i;
+    for (i = 0; i < n; i++)
+        d[i] = e[i] * k;
+}
+int last(int n, int m)
+{
+    int i;
+    for (i = 0; i < n; i++)
+        a[i] = b[i] + m;
+    return i * 3 + m;
+}
+void dowhile(int s, int n)
+{
+    int i = s;
+    do
+    {
+        a[i] = b[i] ^ c[i];
+    } while (++i < n);
+}
+void const7(void)
+{
+    int i;
+    for (i = 0; i < 7; i++)
+        a[i] = b[i] - 3;
+}
+
+int main()
+{
+    static int counts[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 63, 64};
+    int i;
+    fill();
+    addc();
+    orc();
+    mulc(1.5f);
+    const7();
+    printf("const %d\n", sum());
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        int n = counts[i];
+        fill();
+        orn(n);
+        printf("or %d %d\n", n, sum());
+        fill();
+        andn(n);
+        subn(n / 3, n);
+        printf("and sub %d %d\n", n, sum());
+        fill();
+        addfn(n, 2.25f);
+        muldn(n, -3.0);
+        printf("float %d %d\n", n, sum());
+        fill();
+        printf("last %d %d", n, last(n, 5));
+        printf(" %d\n", sum());
+        if (n)
+        {
+            fill();
+            dowhile(n / 2, n);
+            printf("dowhile %d %d\n", n, sum());
+        }
+    }
+    return 0;
+}